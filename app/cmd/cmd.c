@@ -0,0 +1,707 @@
+/**************************************************************************//*!
+ *  @file           cmd.c
+ *  @brief          [APP] 1 行のテキスト・コマンドを解釈してデバイスを操作する。
+ *  @author         Ryoji Morita
+ *  @attention      コマンド一覧 ( 応答は "OK[ 値...]\n" または "ERR 理由\n" )
+ *                      ping
+ *                      led   <hex>
+ *                      dc    <rate> | standby | stop | brake | freq <Hz>
+ *                      sv    <rate>
+ *                      st    cw <deg> | ccw <deg> | to <deg> | wait [id] | pos | origin | stop
+ *                            mode wave | full | half
+ *                            profile const <vmax> | trap <vmin> <vmax> <accel> | scurve <vmin> <vmax> <accel> <jerk>
+ *                      lcd   clear | <x> <y> <text>
+ *                      pm
+ *                      adc   <ch>
+ *                      sw    <n>
+ *  @sa             none.
+ *  @bug            none.
+ *  @warning        none.
+ *  @version        1.00
+ *  @last updated   2019.01.17
+ *************************************************************************** */
+#ifdef __cplusplus
+    extern "C"{
+#endif
+
+
+//********************************************************
+/* include                                               */
+//********************************************************
+#include <limits.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cmd.h"
+#include "../if_lcd/if_lcd.h"
+#include "../../sys/sys.h"
+
+
+//#define DBG_PRINT
+#define MY_NAME "APP"
+#include "../log/log.h"
+
+
+//********************************************************
+/*! @def                                                 */
+//********************************************************
+#define CMD_ARG_MAX     (8)     // 1 コマンドの最大トークン数
+
+
+//********************************************************
+/*! @enum                                                */
+//********************************************************
+// なし
+
+
+//********************************************************
+/*! @struct                                              */
+//********************************************************
+// コマンドを分割した結果
+typedef struct {
+    int             argc;
+    char*           argv[CMD_ARG_MAX];
+    const char*     rest[CMD_ARG_MAX];  // 元の行での各トークンの先頭 ( 空白を含む残りの文字列として使う )
+    char            buf[APP_CMD_LINE_MAX + 1];
+} SAppCmdArgs_t;
+
+// コマンド・テーブルの要素
+typedef struct {
+    const char*     name;
+    ESysDev_t       dev;    // 使うデバイス ( EN_SYS_NUM = なし )。初回の実行時に初期化する
+    EHalBool_t      (*func)( const SAppCmdArgs_t* args, char* resp, unsigned int size );
+} SAppCmdEntry_t;
+
+
+//********************************************************
+/* モジュールグローバル変数                              */
+//********************************************************
+static unsigned int     g_stLastId = 0;     // 最後に要求したステッピング・モータの移動のハンドル
+
+
+//********************************************************
+/* 関数プロトタイプ宣言                                  */
+//********************************************************
+static EHalBool_t   Split( const char* line, SAppCmdArgs_t* args );
+static EHalBool_t   Reply( char* resp, unsigned int size, EHalBool_t ok, const char* format, ... );
+static EHalBool_t   IsStWait( const SAppCmdArgs_t* args, unsigned int* id );
+static EHalBool_t   ParseStProfile( const SAppCmdArgs_t* args, SHalMotorSTProfile_t* profile );
+static EHalBool_t   Cmd_Ping( const SAppCmdArgs_t* args, char* resp, unsigned int size );
+static EHalBool_t   Cmd_Led( const SAppCmdArgs_t* args, char* resp, unsigned int size );
+static EHalBool_t   Cmd_Dc( const SAppCmdArgs_t* args, char* resp, unsigned int size );
+static EHalBool_t   Cmd_Sv( const SAppCmdArgs_t* args, char* resp, unsigned int size );
+static EHalBool_t   Cmd_St( const SAppCmdArgs_t* args, char* resp, unsigned int size );
+static EHalBool_t   Cmd_Lcd( const SAppCmdArgs_t* args, char* resp, unsigned int size );
+static EHalBool_t   Cmd_Pm( const SAppCmdArgs_t* args, char* resp, unsigned int size );
+static EHalBool_t   Cmd_Adc( const SAppCmdArgs_t* args, char* resp, unsigned int size );
+static EHalBool_t   Cmd_Sw( const SAppCmdArgs_t* args, char* resp, unsigned int size );
+
+
+// コマンド・テーブル
+static const SAppCmdEntry_t g_table[] = {
+    { "ping",   EN_SYS_NUM,         Cmd_Ping },
+    { "led",    EN_SYS_LED,         Cmd_Led  },
+    { "dc",     EN_SYS_MOTOR_DC2,   Cmd_Dc   },     // DC モータ 2 は DC モータに依存する
+    { "sv",     EN_SYS_MOTOR_SV,    Cmd_Sv   },
+    { "st",     EN_SYS_MOTOR_ST,    Cmd_St   },
+    { "lcd",    EN_SYS_LCD,         Cmd_Lcd  },
+    { "pm",     EN_SYS_SENSOR_PM,   Cmd_Pm   },
+    { "adc",    EN_SYS_SPI,         Cmd_Adc  },
+    { "sw",     EN_SYS_PUSH_SW,     Cmd_Sw   },
+    { NULL,     EN_SYS_NUM,         NULL     }  // termination
+};
+
+
+
+
+/**************************************************************************//*!
+ * @brief     コマンドを空白で分割する。
+ * @attention なし。
+ * @note      末尾の改行 / 空白は無視する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗 ( 長すぎる / トークンが多すぎる )
+ *************************************************************************** */
+static EHalBool_t
+Split(
+    const char*     line,   ///< [in]  コマンド
+    SAppCmdArgs_t*  args    ///< [out] 分割した結果
+){
+    unsigned int    len = strlen( line );
+    unsigned int    i = 0;
+
+    if( len > APP_CMD_LINE_MAX )
+    {
+        return EN_FALSE;
+    }
+
+    memcpy( args->buf, line, len + 1 );
+    args->argc = 0;
+
+    while( 1 )
+    {
+        while( args->buf[i] == ' ' || args->buf[i] == '\t' || args->buf[i] == '\r' || args->buf[i] == '\n' )
+        {
+            args->buf[i++] = '\0';
+        }
+        if( args->buf[i] == '\0' )
+        {
+            break;
+        }
+        if( args->argc == CMD_ARG_MAX )
+        {
+            return EN_FALSE;
+        }
+
+        args->argv[args->argc] = &args->buf[i];
+        args->rest[args->argc] = &line[i];
+        args->argc++;
+
+        while( args->buf[i] != '\0' && args->buf[i] != ' ' && args->buf[i] != '\t' && args->buf[i] != '\r' && args->buf[i] != '\n' )
+        {
+            i++;
+        }
+    }
+
+    return EN_TRUE;
+}
+
+
+/**************************************************************************//*!
+ * @brief     応答を作成する。
+ * @attention なし。
+ * @note      "OK[ 値...]\n" または "ERR 理由\n" の形式。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    ok をそのまま返す。
+ *************************************************************************** */
+static EHalBool_t
+Reply(
+    char*           resp,   ///< [out] 応答
+    unsigned int    size,   ///< [in]  応答のバッファサイズ
+    EHalBool_t      ok,     ///< [in]  EN_TRUE : 成功, EN_FALSE : 失敗
+    const char*     format, ///< [in]  値 / 理由の書式 ( NULL = なし )
+    ...
+){
+    va_list         ap;
+    int             len = 0;
+
+    len = snprintf( resp, size, "%s", ( ok == EN_TRUE ) ? "OK" : "ERR" );
+    if( format != NULL && len >= 0 && (unsigned int)len < size )
+    {
+        resp[len++] = ' ';
+        va_start( ap, format );
+        len += vsnprintf( &resp[len], size - len, format, ap );
+        va_end( ap );
+    }
+
+    if( len >= (int)size - 1 )
+    {
+        len = size - 2;
+    }
+    resp[len++] = '\n';
+    resp[len]   = '\0';
+    return ok;
+}
+
+
+/**************************************************************************//*!
+ * @brief     ping : 応答だけを返す。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Cmd_Ping(
+    const SAppCmdArgs_t*    args,   ///< [in]  引数
+    char*                   resp,   ///< [out] 応答
+    unsigned int            size    ///< [in]  応答のバッファサイズ
+){
+    return Reply( resp, size, EN_TRUE, NULL );
+}
+
+
+/**************************************************************************//*!
+ * @brief     led <hex> : LED を点灯する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Cmd_Led(
+    const SAppCmdArgs_t*    args,   ///< [in]  引数
+    char*                   resp,   ///< [out] 応答
+    unsigned int            size    ///< [in]  応答のバッファサイズ
+){
+    unsigned int    num = 0;
+
+    if( args->argc != 2 || 1 != sscanf( args->argv[1], "%X", &num ) )
+    {
+        return Reply( resp, size, EN_FALSE, "usage: led <hex>" );
+    }
+
+    HalLed_Set( num );
+    return Reply( resp, size, EN_TRUE, NULL );
+}
+
+
+/**************************************************************************//*!
+ * @brief     dc <rate> | standby | stop | brake | freq <Hz> : DC モータ ( 2 台 ) を操作する。
+ * @attention なし。
+ * @note      freq の応答は実際の周波数と 1 周期のカウント数。
+ *            サーボの出力中は、サーボと同じ 50Hz 以外の周波数での出力 / freq の変更は失敗する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Cmd_Dc(
+    const SAppCmdArgs_t*    args,   ///< [in]  引数
+    char*                   resp,   ///< [out] 応答
+    unsigned int            size    ///< [in]  応答のバッファサイズ
+){
+    EHalMotorState_t    status = EN_MOTOR_CW;
+    SHalPwmInfo_t       info;
+    double              rate = 0.0;
+    char*               end = NULL;
+
+    if( args->argc == 3 && 0 == strcmp( args->argv[1], "freq" ) )
+    {
+        if( EN_FALSE == HalMotorDC_SetPwmFreq( strtod( args->argv[2], NULL ) ) )
+        {
+            return Reply( resp, size, EN_FALSE, "invalid frequency or pwm busy (sv)" );
+        }
+        HalMotorDC_GetPwmInfo( &info );
+        return Reply( resp, size, EN_TRUE, "%.1f %u", info.freq, info.range );
+    }
+
+    if( args->argc != 2 )
+    {
+        return Reply( resp, size, EN_FALSE, "usage: dc <rate>|standby|stop|brake|freq <Hz>" );
+    }
+
+    if( 0 == strcmp( args->argv[1], "standby" ) )
+    {
+        status = EN_MOTOR_STANDBY;
+    } else if( 0 == strcmp( args->argv[1], "stop" ) )
+    {
+        status = EN_MOTOR_STOP;
+    } else if( 0 == strcmp( args->argv[1], "brake" ) )
+    {
+        status = EN_MOTOR_BRAKE;
+    } else
+    {
+        rate = strtod( args->argv[1], &end );
+        if( *end != '\0' || rate < 0.0 || rate > 100.0 )
+        {
+            return Reply( resp, size, EN_FALSE, "invalid rate" );
+        }
+    }
+
+    if( EN_FALSE == HalMotorDC_SetPwmDutyF( status, rate ) || EN_FALSE == HalMotorDC2_SetPwmDutyF( status, rate ) )
+    {
+        return Reply( resp, size, EN_FALSE, "pwm busy (sv)" );
+    }
+    return Reply( resp, size, EN_TRUE, NULL );
+}
+
+
+/**************************************************************************//*!
+ * @brief     sv <rate> : サーボモータを操作する。
+ * @attention なし。
+ * @note      DC モータが 50Hz 以外の周波数で回っている間は失敗する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Cmd_Sv(
+    const SAppCmdArgs_t*    args,   ///< [in]  引数
+    char*                   resp,   ///< [out] 応答
+    unsigned int            size    ///< [in]  応答のバッファサイズ
+){
+    int             rate = 0;
+
+    if( args->argc != 2 || 1 != sscanf( args->argv[1], "%d", &rate ) || rate < 0 || rate > 100 )
+    {
+        return Reply( resp, size, EN_FALSE, "usage: sv <rate>" );
+    }
+
+    if( EN_FALSE == HalMotorSV_SetPwmDuty( EN_MOTOR_CW, rate ) )
+    {
+        return Reply( resp, size, EN_FALSE, "pwm busy (dc)" );
+    }
+    return Reply( resp, size, EN_TRUE, NULL );
+}
+
+
+/**************************************************************************//*!
+ * @brief     "st wait [id]" か否かを調べる。
+ * @attention なし。
+ * @note      id を省略した場合は、最後に要求した移動のハンドルを返す。
+ * @sa        Cmd_St(), AppCmd_IsReady()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : "st wait", EN_FALSE : それ以外
+ *************************************************************************** */
+static EHalBool_t
+IsStWait(
+    const SAppCmdArgs_t*    args,   ///< [in]  引数
+    unsigned int*           id      ///< [out] 待つ移動のハンドル
+){
+    if( ( args->argc != 2 && args->argc != 3 )
+     || 0 != strcmp( args->argv[0], "st" ) || 0 != strcmp( args->argv[1], "wait" ) )
+    {
+        return EN_FALSE;
+    }
+
+    *id = ( args->argc == 3 ) ? (unsigned int)strtoul( args->argv[2], NULL, 10 ) : g_stLastId;
+    return EN_TRUE;
+}
+
+
+/**************************************************************************//*!
+ * @brief     "st profile ..." の引数を加減速プロファイルに変換する。
+ * @attention 値の範囲は HalMotorST_SetProfile() で検査する。
+ * @note      const は vmax だけ、trap は vmin / vmax / accel、scurve はさらに jerk をとる。
+ * @sa        Cmd_St()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+ParseStProfile(
+    const SAppCmdArgs_t*    args,       ///< [in]  引数
+    SHalMotorSTProfile_t*   profile     ///< [out] 加減速プロファイル
+){
+    const char*     type = args->argv[2];
+    double*         value[4] = { &profile->vmin, &profile->vmax, &profile->accel, &profile->jerk };
+    int             first = 0;
+    int             num = 0;
+    int             i = 0;
+
+    memset( profile, 0, sizeof(*profile) );
+
+    if(      0 == strcmp( type, "const"  ) ){ profile->type = EN_ST_PROFILE_CONST;     first = 1; num = 1; }
+    else if( 0 == strcmp( type, "trap"   ) ){ profile->type = EN_ST_PROFILE_TRAPEZOID; first = 0; num = 3; }
+    else if( 0 == strcmp( type, "scurve" ) ){ profile->type = EN_ST_PROFILE_SCURVE;    first = 0; num = 4; }
+    else
+    {
+        return EN_FALSE;
+    }
+
+    if( args->argc != 3 + num )
+    {
+        return EN_FALSE;
+    }
+
+    for( i = 0; i < num; i++ )
+    {
+        if( 1 != sscanf( args->argv[3 + i], "%lf", value[first + i] ) )
+        {
+            return EN_FALSE;
+        }
+    }
+
+    return EN_TRUE;
+}
+
+
+/**************************************************************************//*!
+ * @brief     st ... : ステッピング・モータを操作する。
+ * @attention なし。
+ * @note      cw / ccw / to はすぐに戻り、移動のハンドルを応答する。
+ *            wait はハンドル ( 省略時は最後の移動 ) の完了まで待つ。
+ *            イベント・ループから使う場合は、AppCmd_IsReady() で完了を確かめてから実行すること。
+ *            mode は励磁方式 ( wave = 1 相, full = 2 相, half = 1-2 相 ) を変える。移動中は失敗する。
+ *            profile は加減速 ( const = 定速, trap = 台形, scurve = S 字 ) を変える ( 単位: step/s, step/s^2, step/s^3 )。
+ *            移動中は失敗する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Cmd_St(
+    const SAppCmdArgs_t*    args,   ///< [in]  引数
+    char*                   resp,   ///< [out] 応答
+    unsigned int            size    ///< [in]  応答のバッファサイズ
+){
+    const char*             sub = ( args->argc >= 2 ) ? args->argv[1] : "";
+    unsigned int            id = 0;
+    int                     deg = 0;
+    double                  to = 0.0;
+    EHalMotorSTStep_t       mode = EN_ST_STEP_WAVE;
+    SHalMotorSTProfile_t    profile;
+
+    if( args->argc == 3 && ( 0 == strcmp( sub, "cw" ) || 0 == strcmp( sub, "ccw" ) ) )
+    {
+        if( 1 != sscanf( args->argv[2], "%d", &deg ) )
+        {
+            return Reply( resp, size, EN_FALSE, "invalid degree" );
+        }
+        id = HalMotorST_Move( ( 0 == strcmp( sub, "cw" ) ) ? EN_MOTOR_CW : EN_MOTOR_CCW, deg );
+    } else if( args->argc == 3 && 0 == strcmp( sub, "to" ) )
+    {
+        if( 1 != sscanf( args->argv[2], "%lf", &to ) || !( fabs( to ) <= LONG_MAX / 1000 ) )
+        {
+            return Reply( resp, size, EN_FALSE, "invalid degree" );
+        }
+        id = HalMotorST_MoveTo( lround( to * 1000.0 ) );
+    } else if( EN_TRUE == IsStWait( args, &id ) )
+    {
+        HalMotorST_Wait( id );
+        return Reply( resp, size, EN_TRUE, "%ld", HalMotorST_GetPosition() );
+    } else if( args->argc == 2 && 0 == strcmp( sub, "pos" ) )
+    {
+        return Reply( resp, size, EN_TRUE, "%ld", HalMotorST_GetPosition() );
+    } else if( args->argc == 2 && 0 == strcmp( sub, "origin" ) )
+    {
+        return Reply( resp, size, HalMotorST_SetOrigin(), NULL );
+    } else if( args->argc == 2 && 0 == strcmp( sub, "stop" ) )
+    {
+        HalMotorST_Stop();
+        return Reply( resp, size, EN_TRUE, NULL );
+    } else if( args->argc == 3 && 0 == strcmp( sub, "mode" ) )
+    {
+        if(      0 == strcmp( args->argv[2], "wave" ) ){ mode = EN_ST_STEP_WAVE;      }
+        else if( 0 == strcmp( args->argv[2], "full" ) ){ mode = EN_ST_STEP_TWO_PHASE; }
+        else if( 0 == strcmp( args->argv[2], "half" ) ){ mode = EN_ST_STEP_HALF;      }
+        else
+        {
+            return Reply( resp, size, EN_FALSE, "usage: st mode wave|full|half" );
+        }
+        if( EN_FALSE == HalMotorST_SetStepMode( mode ) )
+        {
+            return Reply( resp, size, EN_FALSE, "stepper is moving" );
+        }
+        return Reply( resp, size, EN_TRUE, NULL );
+    } else if( args->argc >= 3 && 0 == strcmp( sub, "profile" ) )
+    {
+        if( EN_FALSE == ParseStProfile( args, &profile ) )
+        {
+            return Reply( resp, size, EN_FALSE, "usage: st profile const <vmax> | trap <vmin> <vmax> <accel> | scurve <vmin> <vmax> <accel> <jerk>" );
+        }
+        if( EN_FALSE == HalMotorST_SetProfile( &profile ) )
+        {
+            return Reply( resp, size, EN_FALSE, "invalid profile or stepper is moving" );
+        }
+        return Reply( resp, size, EN_TRUE, NULL );
+    } else
+    {
+        return Reply( resp, size, EN_FALSE, "usage: st cw|ccw <deg> | to <deg> | wait [id] | pos | origin | stop | mode wave|full|half | profile ..." );
+    }
+
+    if( id == 0 )
+    {
+        return Reply( resp, size, EN_FALSE, "move rejected" );
+    }
+
+    g_stLastId = id;
+    return Reply( resp, size, EN_TRUE, "%u", id );
+}
+
+
+/**************************************************************************//*!
+ * @brief     lcd clear | <x> <y> <text> : LCD に表示する。
+ * @attention なし。
+ * @note      text は空白を含めて行末までを表示する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Cmd_Lcd(
+    const SAppCmdArgs_t*    args,   ///< [in]  引数
+    char*                   resp,   ///< [out] 応答
+    unsigned int            size    ///< [in]  応答のバッファサイズ
+){
+    char            text[APP_LCD_MAX_X + 1];
+    unsigned int    len = 0;
+    int             x = 0;
+    int             y = 0;
+
+    if( args->argc == 2 && 0 == strcmp( args->argv[1], "clear" ) )
+    {
+        AppIfLcd_Clear();
+        return Reply( resp, size, EN_TRUE, NULL );
+    }
+
+    if( args->argc < 4
+     || 1 != sscanf( args->argv[1], "%d", &x ) || x < 0 || x >= APP_LCD_MAX_X
+     || 1 != sscanf( args->argv[2], "%d", &y ) || y < 0 || y >= APP_LCD_MAX_Y )
+    {
+        return Reply( resp, size, EN_FALSE, "usage: lcd clear | <x> <y> <text>" );
+    }
+
+    len = strcspn( args->rest[3], "\r\n" );
+    if( len > APP_LCD_MAX_X - x )
+    {
+        len = APP_LCD_MAX_X - x;
+    }
+    memcpy( text, args->rest[3], len );
+    text[len] = '\0';
+
+    AppIfLcd_CursorSet( x, y );
+    AppIfLcd_Puts( text );
+    return Reply( resp, size, EN_TRUE, NULL );
+}
+
+
+/**************************************************************************//*!
+ * @brief     pm : ポテンショメータの値を読む。
+ * @attention なし。
+ * @note      応答は割合 ( % ) と AD 値。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Cmd_Pm(
+    const SAppCmdArgs_t*    args,   ///< [in]  引数
+    char*                   resp,   ///< [out] 応答
+    unsigned int            size    ///< [in]  応答のバッファサイズ
+){
+    SHalSensor_t*   data = HalSensorPm_Get();
+
+    return Reply( resp, size, EN_TRUE, "%d %.0f", data->cur_rate, data->cur );
+}
+
+
+/**************************************************************************//*!
+ * @brief     adc <ch> : MCP3208 の AD 値を読む。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Cmd_Adc(
+    const SAppCmdArgs_t*    args,   ///< [in]  引数
+    char*                   resp,   ///< [out] 応答
+    unsigned int            size    ///< [in]  応答のバッファサイズ
+){
+    unsigned int    data = 0;
+    int             ch = 0;
+
+    if( args->argc != 2 || 1 != sscanf( args->argv[1], "%d", &ch ) || ch < 0 || ch >= MCP3208_CH_NUM )
+    {
+        return Reply( resp, size, EN_FALSE, "usage: adc <ch>" );
+    }
+
+    if( EN_FALSE == HalCmnSpiMcp3208_StreamLatest( (EHalSensorMcp3208_t)ch, &data ) )
+    {
+        data = HalCmnSpiMcp3208_Get( (EHalSensorMcp3208_t)ch );
+    }
+    return Reply( resp, size, EN_TRUE, "%u", data );
+}
+
+
+/**************************************************************************//*!
+ * @brief     sw <n> : プッシュ・スイッチの状態を読む。
+ * @attention なし。
+ * @note      応答は 1 = 押されている, 0 = 押されていない。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Cmd_Sw(
+    const SAppCmdArgs_t*    args,   ///< [in]  引数
+    char*                   resp,   ///< [out] 応答
+    unsigned int            size    ///< [in]  応答のバッファサイズ
+){
+    int             which = 0;
+
+    if( args->argc != 2 || 1 != sscanf( args->argv[1], "%d", &which ) || which < EN_PUSH_SW_0 || which > EN_PUSH_SW_2 )
+    {
+        return Reply( resp, size, EN_FALSE, "usage: sw <n>" );
+    }
+
+    return Reply( resp, size, EN_TRUE, "%d", ( EN_TRUE == HalPushSw_Get( (EHalPushSw_t)which ) ) ? 1 : 0 );
+}
+
+
+/**************************************************************************//*!
+ * @brief     1 行のコマンドを実行する。
+ * @attention なし。
+ * @note      resp には改行で終わる 1 行の応答を格納する。空行は何もせず "OK" を返す。
+ *            コマンドが使うデバイスは、初回の実行時に Sys_Require() で初期化する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+AppCmd_Exec(
+    const char*     line,   ///< [in]  コマンド
+    char*           resp,   ///< [out] 応答
+    unsigned int    size    ///< [in]  応答のバッファサイズ ( APP_CMD_RESP_MAX 以上を推奨 )
+){
+    SAppCmdArgs_t           args;
+    const SAppCmdEntry_t*   entry = NULL;
+
+    DBG_PRINT_TRACE( "line = %s \n\r", line );
+
+    if( EN_FALSE == Split( line, &args ) )
+    {
+        return Reply( resp, size, EN_FALSE, "too long" );
+    }
+
+    if( args.argc == 0 )
+    {
+        return Reply( resp, size, EN_TRUE, NULL );
+    }
+
+    for( entry = g_table; entry->name != NULL; entry++ )
+    {
+        if( 0 == strcmp( entry->name, args.argv[0] ) )
+        {
+            if( entry->dev != EN_SYS_NUM && EN_FALSE == Sys_Require( entry->dev ) )
+            {
+                return Reply( resp, size, EN_FALSE, "device unavailable" );
+            }
+            return entry->func( &args, resp, size );
+        }
+    }
+
+    return Reply( resp, size, EN_FALSE, "unknown command: %s", args.argv[0] );
+}
+
+
+
+/**************************************************************************//*!
+ * @brief     コマンドをすぐに実行できるか調べる。
+ * @attention なし。
+ * @note      "st wait" は移動が完了するまで AppCmd_Exec() から戻らない。
+ *            1 スレッドのイベント・ループでは、これが EN_TRUE になるまで実行を遅らせることで、
+ *            待っている間も他のコマンド ( "st stop" など ) を受け付けられる。
+ *            それ以外のコマンドは常に EN_TRUE を返す。
+ * @sa        AppCmd_Exec()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : すぐに実行できる, EN_FALSE : 移動の完了待ち
+ *************************************************************************** */
+EHalBool_t
+AppCmd_IsReady(
+    const char*     line    ///< [in] コマンド
+){
+    SAppCmdArgs_t   args;
+    unsigned int    id = 0;
+
+    if( EN_FALSE == Split( line, &args ) || EN_FALSE == IsStWait( &args, &id )
+     || EN_FALSE == Sys_IsUp( EN_SYS_MOTOR_ST ) )
+    {
+        return EN_TRUE;
+    }
+
+    return HalMotorST_IsDone( id );
+}
+
+#ifdef __cplusplus
+    }
+#endif
+
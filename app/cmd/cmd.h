@@ -0,0 +1,54 @@
+/**************************************************************************//*!
+ *  @file           cmd.h
+ *  @brief          [APP] 外部公開 API を宣言したヘッダファイル。
+ *  @author         Ryoji Morita
+ *  @attention      none.
+ *                  関数命名規則
+ *                      通常関数 : App[モジュール名]_処理名()
+ *  @sa             none.
+ *  @bug            none.
+ *  @warning        none.
+ *  @version        1.00
+ *  @last updated   2019.01.17
+ *************************************************************************** */
+
+// 多重コンパイル抑止
+#ifndef _APP_CMD_H_
+#define _APP_CMD_H_
+
+
+//********************************************************
+/* include                                               */
+//********************************************************
+#include "../../hal/hal.h"
+
+
+//********************************************************
+/*! @def                                                 */
+//********************************************************
+#define APP_CMD_LINE_MAX    (256)   ///< @def : 1 コマンドの最大文字数 ( 改行を含まない )
+#define APP_CMD_RESP_MAX    (128)   ///< @def : 1 応答の最大文字数 ( 改行を含む )
+
+
+//********************************************************
+/*! @enum                                                */
+//********************************************************
+// なし
+
+
+//********************************************************
+/*! @struct                                              */
+//********************************************************
+// なし
+
+
+//********************************************************
+/* 関数プロトタイプ宣言                                  */
+//********************************************************
+EHalBool_t  AppCmd_Exec( const char* line, char* resp, unsigned int size );
+EHalBool_t  AppCmd_IsReady( const char* line );
+EHalBool_t  AppCmd_Script( const char* path );
+
+
+#endif /* _APP_CMD_H_ */
+
@@ -0,0 +1,504 @@
+/**************************************************************************//*!
+ *  @file           cmd_script.c
+ *  @brief          [APP] コマンドを並べたスクリプトを 1 つのプロセス内で順に実行する。
+ *  @author         Ryoji Morita
+ *  @attention      スクリプトの書式 ( 1 行 1 コマンド、'#' 以降はコメント )
+ *                      <command>               cmd.c のコマンド。応答を標準出力に出す
+ *                      wait   <ms>             ms だけ待つ
+ *                      at     <ms>             ブロック ( スクリプト / repeat の 1 回 ) の開始から ms 後まで待つ
+ *                      repeat <n> <period_ms>  end までを n 回 ( 0 = 無限 ) 、period_ms 周期で繰り返す
+ *                      end                     repeat の終わり
+ *  @sa             cmd.c
+ *  @note           スクリプトは全て読み込んで書式を確認してから実行するため、書式の誤りで途中まで動くことはない。
+ *                  時間 ( ms ) は小数可で、0 ～ 1 日 ( SCRIPT_TIME_MAX ) の範囲とする。
+ *                  待ちは CLOCK_MONOTONIC の絶対時刻で行うため、コマンドの処理時間で周期がずれない。
+ *                  コマンドが ERR を返すか、SIGINT / SIGTERM を受けたら実行を止める。
+ *  @bug            none.
+ *  @warning        none.
+ *  @version        1.00
+ *  @last updated   2019.01.17
+ *************************************************************************** */
+#ifdef __cplusplus
+    extern "C"{
+#endif
+
+
+//********************************************************
+/* include                                               */
+//********************************************************
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmd.h"
+
+
+//#define DBG_PRINT
+#define MY_NAME "APP"
+#include "../log/log.h"
+
+
+//********************************************************
+/*! @def                                                 */
+//********************************************************
+#define SCRIPT_SIZE     (64 * 1024)     // スクリプトの最大 Byte 数
+#define SCRIPT_STEP_MAX (1024)          // スクリプトの最大行数 ( 空行 / コメント行を除く )
+#define SCRIPT_NEST_MAX (8)             // repeat の最大の入れ子の深さ
+#define SCRIPT_TIME_MAX (86400000.0)    // wait / at / period_ms の最大値 ( 単位: msec ) : 1 日
+#define NSEC_PER_MSEC   (1000000.0)
+#define NSEC_PER_SEC    (1000000000ULL)
+
+
+//********************************************************
+/*! @enum                                                */
+//********************************************************
+// スクリプトの 1 行の種類
+typedef enum {
+    EN_STEP_CMD = 0,    // コマンド
+    EN_STEP_WAIT,       // wait
+    EN_STEP_AT,         // at
+    EN_STEP_REPEAT,     // repeat
+    EN_STEP_END         // end
+} EAppCmdStep_t;
+
+
+//********************************************************
+/*! @struct                                              */
+//********************************************************
+// スクリプトの 1 行
+typedef struct {
+    EAppCmdStep_t       type;
+    const char*         str;        // コマンド ( EN_STEP_CMD の場合 )
+    unsigned int        no;         // 行番号
+    unsigned long       count;      // 繰り返し回数 ( EN_STEP_REPEAT の場合, 0 = 無限 )
+    unsigned long long  time;       // 時間 ( 単位: nsec )
+} SAppCmdStep_t;
+
+// 実行中の repeat
+typedef struct {
+    unsigned int        begin;      // 繰り返す最初の行
+    unsigned long       left;       // 残りの回数 ( 0 = 無限 )
+    unsigned long long  period;     // 周期 ( 単位: nsec )
+    unsigned long long  base;       // 今回の開始時刻 ( 単位: nsec )
+} SAppCmdLoop_t;
+
+typedef struct {
+    char                text[SCRIPT_SIZE + 1];
+    SAppCmdStep_t       step[SCRIPT_STEP_MAX];
+    unsigned int        num;
+    SAppCmdLoop_t       loop[SCRIPT_NEST_MAX];
+    unsigned int        depth;
+} SAppCmdScript_t;
+
+
+//********************************************************
+/* モジュールグローバル変数                              */
+//********************************************************
+static SAppCmdScript_t          g_param;
+static volatile sig_atomic_t    g_stop = 0;     // EN_TRUE = 停止要求
+
+
+//********************************************************
+/* 関数プロトタイプ宣言                                  */
+//********************************************************
+static void         Handler( int sig );
+static EHalBool_t   Load( FILE* fp );
+static EHalBool_t   ParseTime( const char* str, unsigned long long* time );
+static EHalBool_t   Parse( char* line, unsigned int no );
+static EHalBool_t   SleepUntil( unsigned long long time );
+static EHalBool_t   Run( void );
+
+
+
+
+/**************************************************************************//*!
+ * @brief     SIGINT / SIGTERM のハンドラ。
+ * @attention なし。
+ * @note      SA_RESTART を付けないため、clock_nanosleep() は EINTR で戻る。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Handler(
+    int             sig     ///< [in] シグナル番号
+){
+    g_stop = EN_TRUE;
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     スクリプトを全て読み込み、1 行ずつ解析する。
+ * @attention なし。
+ * @note      repeat と end の対応もここで確認する。
+ * @sa        Parse()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Load(
+    FILE*           fp      ///< [in] スクリプト
+){
+    EHalBool_t      ret = EN_FALSE;
+    size_t          size = 0;
+    char*           line = NULL;
+    char*           next = NULL;
+    unsigned int    no = 0;
+    int             depth = 0;
+    unsigned int    i = 0;
+
+    size = fread( g_param.text, 1, SCRIPT_SIZE + 1, fp );
+    if( size > SCRIPT_SIZE )
+    {
+        DBG_PRINT_ERROR( "too large script. ( max %d bytes ) \n\r", SCRIPT_SIZE );
+        return ret;
+    }
+    g_param.text[size] = '\0';
+    g_param.num = 0;
+
+    for( line = g_param.text; line != NULL; line = next )
+    {
+        no++;
+        next = strchr( line, '\n' );
+        if( next != NULL )
+        {
+            *next++ = '\0';
+        }
+
+        if( EN_FALSE == Parse( line, no ) )
+        {
+            return ret;
+        }
+    }
+
+    for( i = 0; i < g_param.num; i++ )
+    {
+        if( g_param.step[i].type == EN_STEP_REPEAT )
+        {
+            depth++;
+        } else if( g_param.step[i].type == EN_STEP_END )
+        {
+            depth--;
+        }
+
+        if( depth < 0 || depth > SCRIPT_NEST_MAX )
+        {
+            DBG_PRINT_ERROR( "line %u : unbalanced or too deep repeat/end. \n\r", g_param.step[i].no );
+            return ret;
+        }
+    }
+
+    if( depth != 0 )
+    {
+        DBG_PRINT_ERROR( "missing end. \n\r" );
+        return ret;
+    }
+
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     時間 ( 単位: msec, 小数可 ) を解析する。
+ * @attention なし。
+ * @note      0 ～ SCRIPT_TIME_MAX の範囲外 ( inf / nan を含む ) は失敗とする。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+ParseTime(
+    const char*         str,    ///< [in]  文字列
+    unsigned long long* time    ///< [out] 時間 ( 単位: nsec )
+){
+    EHalBool_t      ret = EN_FALSE;
+    double          msec = 0.0;
+    char*           end = NULL;
+
+    if( str == NULL )
+    {
+        return ret;
+    }
+
+    msec = strtod( str, &end );
+    if( end == str || *end != '\0' || !( msec >= 0.0 && msec <= SCRIPT_TIME_MAX ) )
+    {
+        return ret;
+    }
+
+    *time = (unsigned long long)( msec * NSEC_PER_MSEC );
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     スクリプトの 1 行を解析する。
+ * @attention line は書き換える ( コメントと末尾の空白を削除する )。
+ * @note      空行とコメント行は登録しない。
+ * @sa        Load()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Parse(
+    char*           line,   ///< [in] 1 行
+    unsigned int    no      ///< [in] 行番号
+){
+    EHalBool_t      ret = EN_FALSE;
+    SAppCmdStep_t*  step = &g_param.step[g_param.num];
+    char            word[8];
+    char            arg1[32];
+    char            arg2[32];
+    char*           end = NULL;
+    int             num = 0;
+    size_t          len = 0;
+
+    end = strchr( line, '#' );
+    if( end != NULL )
+    {
+        *end = '\0';
+    }
+
+    line += strspn( line, " \t" );
+    len = strlen( line );
+    while( len > 0 && ( line[len - 1] == ' ' || line[len - 1] == '\t' || line[len - 1] == '\r' ) )
+    {
+        line[--len] = '\0';
+    }
+
+    if( len == 0 )
+    {
+        ret = EN_TRUE;
+        return ret;
+    }
+
+    if( g_param.num == SCRIPT_STEP_MAX )
+    {
+        DBG_PRINT_ERROR( "line %u : too many lines. ( max %d ) \n\r", no, SCRIPT_STEP_MAX );
+        return ret;
+    }
+
+    if( len > APP_CMD_LINE_MAX )
+    {
+        DBG_PRINT_ERROR( "line %u : too long line. \n\r", no );
+        return ret;
+    }
+
+    memset( step, 0, sizeof(SAppCmdStep_t) );
+    step->type = EN_STEP_CMD;
+    step->str  = line;
+    step->no   = no;
+
+    num = sscanf( line, "%7s %31s %31s", word, arg1, arg2 );
+    if( 0 == strcmp( word, "wait" ) || 0 == strcmp( word, "at" ) )
+    {
+        step->type = ( word[0] == 'w' ) ? EN_STEP_WAIT : EN_STEP_AT;
+        if( num != 2 || EN_FALSE == ParseTime( arg1, &step->time ) )
+        {
+            DBG_PRINT_ERROR( "line %u : usage: %s <ms> \n\r", no, word );
+            return ret;
+        }
+    } else if( 0 == strcmp( word, "repeat" ) )
+    {
+        step->type  = EN_STEP_REPEAT;
+        step->count = strtoul( arg1, &end, 10 );
+        if( num != 3 || *end != '\0' || EN_FALSE == ParseTime( arg2, &step->time ) )
+        {
+            DBG_PRINT_ERROR( "line %u : usage: repeat <n> <period_ms> \n\r", no );
+            return ret;
+        }
+    } else if( 0 == strcmp( word, "end" ) )
+    {
+        step->type = EN_STEP_END;
+        if( num != 1 )
+        {
+            DBG_PRINT_ERROR( "line %u : usage: end \n\r", no );
+            return ret;
+        }
+    }
+
+    g_param.num++;
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     絶対時刻まで待つ。
+ * @attention なし。
+ * @note      既に過ぎている場合はすぐに戻る。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 停止要求で中断した
+ *************************************************************************** */
+static EHalBool_t
+SleepUntil(
+    unsigned long long  time    ///< [in] 時刻 ( CLOCK_MONOTONIC, 単位: nsec )
+){
+    struct timespec     ts;
+
+    ts.tv_sec  = time / NSEC_PER_SEC;
+    ts.tv_nsec = time % NSEC_PER_SEC;
+    while( g_stop == EN_FALSE )
+    {
+        if( 0 == clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL ) )
+        {
+            return EN_TRUE;
+        }
+    }
+
+    return EN_FALSE;
+}
+
+
+/**************************************************************************//*!
+ * @brief     読み込んだスクリプトを実行する。
+ * @attention なし。
+ * @note      repeat の周期に間に合わなかった場合は、遅れを取り戻さずに次の回をすぐに始める。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗 / 中断
+ *************************************************************************** */
+static EHalBool_t
+Run(
+    void
+){
+    EHalBool_t          ret = EN_TRUE;
+    char                resp[APP_CMD_RESP_MAX];
+    SAppCmdStep_t*      step = NULL;
+    SAppCmdLoop_t*      loop = NULL;
+    unsigned long long  start = HalTime_GetMonotonicNs();
+    unsigned long long  now = 0;
+    unsigned int        pc = 0;
+
+    g_param.depth = 0;
+    while( ret == EN_TRUE && pc < g_param.num )
+    {
+        if( g_stop == EN_TRUE )
+        {
+            DBG_PRINT_ERROR( "stopped at line %u. \n\r", g_param.step[pc].no );
+            ret = EN_FALSE;
+            break;
+        }
+
+        step = &g_param.step[pc];
+        loop = ( g_param.depth > 0 ) ? &g_param.loop[g_param.depth - 1] : NULL;
+
+        switch( step->type )
+        {
+        case EN_STEP_CMD:
+            ret = AppCmd_Exec( step->str, resp, sizeof(resp) );
+            fputs( resp, stdout );
+            if( ret == EN_FALSE )
+            {
+                DBG_PRINT_ERROR( "line %u : %s \n\r", step->no, step->str );
+            }
+            break;
+        case EN_STEP_WAIT:
+            ret = SleepUntil( HalTime_GetMonotonicNs() + step->time );
+            break;
+        case EN_STEP_AT:
+            ret = SleepUntil( ( ( loop != NULL ) ? loop->base : start ) + step->time );
+            break;
+        case EN_STEP_REPEAT:
+            loop = &g_param.loop[g_param.depth++];
+            loop->begin  = pc + 1;
+            loop->left   = step->count;
+            loop->period = step->time;
+            loop->base   = HalTime_GetMonotonicNs();
+            break;
+        case EN_STEP_END:
+            if( loop->left != 0 && --loop->left == 0 )
+            {
+                g_param.depth--;
+                break;
+            }
+
+            loop->base += loop->period;
+            now = HalTime_GetMonotonicNs();
+            if( loop->base < now )
+            {
+                DBG_PRINT_DEBUG( "line %u : repeat overrun. \n\r", step->no );
+                loop->base = now;
+            }
+            ret = SleepUntil( loop->base );
+            pc = loop->begin;
+            continue;
+        default:
+            break;
+        }
+
+        pc++;
+    }
+
+    fflush( stdout );
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     スクリプトを実行する。
+ * @attention なし。
+ * @note      path = "-" または NULL の場合は標準入力から読む。
+ *            コマンドが使うデバイスは、初回の実行時に初期化する。
+ * @sa        AppCmd_Exec()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗 / 中断
+ *************************************************************************** */
+EHalBool_t
+AppCmd_Script(
+    const char*     path    ///< [in] スクリプトのパス
+){
+    EHalBool_t          ret = EN_FALSE;
+    FILE*               fp = stdin;
+    struct sigaction    sa;
+    struct sigaction    old_int;
+    struct sigaction    old_term;
+
+    DBG_PRINT_TRACE( "path = %s \n\r", path );
+
+    if( path != NULL && 0 != strcmp( path, "-" ) )
+    {
+        fp = fopen( path, "r" );
+        if( fp == NULL )
+        {
+            DBG_PRINT_ERROR( "fail to open %s. : %s \n\r", path, strerror( errno ) );
+            return ret;
+        }
+    }
+
+    ret = Load( fp );
+    if( fp != stdin )
+    {
+        fclose( fp );
+    }
+    if( ret == EN_FALSE )
+    {
+        return ret;
+    }
+
+    memset( &sa, 0, sizeof(sa) );
+    sigemptyset( &sa.sa_mask );
+    sa.sa_handler = Handler;
+    sigaction( SIGINT,  &sa, &old_int );
+    sigaction( SIGTERM, &sa, &old_term );
+
+    g_stop = EN_FALSE;
+    ret = Run();
+
+    sigaction( SIGINT,  &old_int,  NULL );
+    sigaction( SIGTERM, &old_term, NULL );
+    return ret;
+}
+
+
+#ifdef __cplusplus
+    }
+#endif
+
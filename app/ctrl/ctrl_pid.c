@@ -0,0 +1,382 @@
+/**************************************************************************//*!
+ *  @file           ctrl_pid.c
+ *  @brief          [APP] 固定周期の PID 制御タスク。
+ *  @author         Ryoji Morita
+ *  @attention      none.
+ *  @sa             none.
+ *  @bug            none.
+ *  @warning        none.
+ *  @version        1.00
+ *  @last updated   2019.01.17
+ *************************************************************************** */
+#ifdef __cplusplus
+    extern "C"{
+#endif
+
+
+//********************************************************
+/* include                                               */
+//********************************************************
+#define _GNU_SOURCE     // CPU_SET(), pthread_setaffinity_np()
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
+#include "ctrl_pid.h"
+
+
+//#define DBG_PRINT
+#define MY_NAME "APP"
+#include "../log/log.h"
+
+
+//********************************************************
+/*! @def                                                 */
+//********************************************************
+#define NSEC_PER_SEC    (1000000000ULL)
+
+
+//********************************************************
+/*! @enum                                                */
+//********************************************************
+// なし
+
+
+//********************************************************
+/*! @struct                                              */
+//********************************************************
+typedef struct {
+    pthread_mutex_t     lock;       // param / stats を保護する
+    pthread_t           thread;
+    int                 running;    // 制御スレッドが動作中か否か
+    int                 stop;       // 制御スレッドへの停止要求
+    SAppCtrlPidParam_t  param;
+    SAppCtrlPidStats_t  stats;
+} SAppCtrlPid_t;
+
+
+//********************************************************
+/* モジュールグローバル変数                              */
+//********************************************************
+static SAppCtrlPid_t    g_param = { PTHREAD_MUTEX_INITIALIZER };
+
+
+//********************************************************
+/* 関数プロトタイプ宣言                                  */
+//********************************************************
+static double               Sample( EHalSensorMcp3208_t ch );
+static void*                Control( void* arg );
+
+
+
+
+/**************************************************************************//*!
+ * @brief     制御量を取得する。
+ * @attention なし。
+ * @note      サンプラが動作中なら SPI バスにアクセスせず最新のサンプルを使う。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    制御量 ( 単位: % = AD 値 / MCP3208_MAX_VALE )
+ *************************************************************************** */
+static double
+Sample(
+    EHalSensorMcp3208_t ch      ///< [in] 入力 ch
+){
+    unsigned int    data = 0;
+
+    if( EN_FALSE == HalCmnSpiMcp3208_StreamLatest( ch, &data ) )
+    {
+        data = HalCmnSpiMcp3208_Get( ch );
+    }
+
+    return (double)data * 100.0 / MCP3208_MAX_VALE;
+}
+
+
+/**************************************************************************//*!
+ * @brief     制御スレッド。
+ * @attention なし。
+ * @note      clock_nanosleep() の絶対時刻指定で周期を保つ。
+ *            処理が周期に間に合わなかった場合は、過ぎた周期を飛ばして次の周期の境界から再開する。
+ *
+ *            操作量 u = P + I + D
+ *              P = kp * e                                  ( e = 目標値 - 制御量 )
+ *              I = I + ki * e * dt                         ( 操作量が飽和している方向には積分しない )
+ *              D = ( tf * D - kd * ( y - y' ) ) / ( tf + dt )
+ *                                                          ( 制御量の微分に 1 次遅れフィルタをかける )
+ *            微分は目標値の変化で操作量が跳ねないよう、偏差ではなく制御量から求める。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    NULL
+ *************************************************************************** */
+static void*
+Control(
+    void*       arg     ///< [in] ナシ
+){
+    SAppCtrlPidParam_t  param;
+    unsigned long long  period = (unsigned long long)g_param.param.period * 1000;
+    unsigned long long  next = 0;
+    unsigned long long  now = 0;
+    unsigned long long  start = 0;
+    unsigned long long  prev = 0;
+    unsigned long long  skip = 0;
+    double              dt = 0.0;
+    double              y = 0.0;
+    double              yPrev = 0.0;
+    double              e = 0.0;
+    double              p = 0.0;
+    double              i = 0.0;
+    double              iNew = 0.0;
+    double              d = 0.0;
+    double              u = 0.0;
+    struct timespec     ts;
+    cpu_set_t           set;
+    int                 res = 0;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    if( g_param.param.cpu >= 0 )
+    {
+        CPU_ZERO( &set );
+        CPU_SET( g_param.param.cpu, &set );
+        res = pthread_setaffinity_np( pthread_self(), sizeof(set), &set );
+        if( res != 0 )
+        {
+            DBG_PRINT_WARN( "Unable to pin to CPU %d. : %s \n\r", g_param.param.cpu, strerror( res ) );
+        }
+    }
+
+    yPrev = Sample( g_param.param.ch );
+    next  = HalTime_GetMonotonicNs();
+    prev  = next - period;
+
+    while( 0 == __atomic_load_n( &g_param.stop, __ATOMIC_ACQUIRE ) )
+    {
+        start = HalTime_GetMonotonicNs();
+        dt    = (double)( start - prev ) / NSEC_PER_SEC;
+        prev  = start;
+
+        pthread_mutex_lock( &g_param.lock );
+        param = g_param.param;
+        pthread_mutex_unlock( &g_param.lock );
+
+        y = Sample( param.ch );
+        e = param.setpoint - y;
+
+        p = param.kp * e;
+        d = ( param.tf * d - param.kd * ( y - yPrev ) ) / ( param.tf + dt );
+        yPrev = y;
+
+        // anti-windup : 飽和を深める方向の積分は捨てる
+        iNew = i + param.ki * e * dt;
+        u = p + iNew + d;
+        if( u > param.outMax )
+        {
+            u = param.outMax;
+            if( e < 0.0 ){ i = iNew; }
+        } else if( u < param.outMin )
+        {
+            u = param.outMin;
+            if( e > 0.0 ){ i = iNew; }
+        } else
+        {
+            i = iNew;
+        }
+
+        if( param.output != NULL )
+        {
+            param.output( u, param.arg );
+        }
+
+        now = HalTime_GetMonotonicNs();
+        next += period;
+
+        pthread_mutex_lock( &g_param.lock );
+        g_param.stats.cycles++;
+        if( now - start > g_param.stats.execMax )
+        {
+            g_param.stats.execMax = now - start;
+        }
+        g_param.stats.input  = y;
+        g_param.stats.output = u;
+        g_param.stats.error  = e;
+        if( next < now )
+        {
+            skip = ( now - next ) / period + 1;
+            g_param.stats.overrun++;
+            g_param.stats.missed += skip;
+            next += skip * period;
+        }
+        pthread_mutex_unlock( &g_param.lock );
+
+        ts.tv_sec  = next / NSEC_PER_SEC;
+        ts.tv_nsec = next % NSEC_PER_SEC;
+        while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL ) != 0 )
+        {
+            ;   // シグナルで中断された場合は再度待つ
+        }
+    }
+
+    return NULL;
+}
+
+
+/**************************************************************************//*!
+ * @brief     制御タスクを開始する。
+ * @attention HalCmnSpi_Init() と出力先のドライバの初期化の後に呼ぶこと。
+ * @note      priority > 0 の場合は SCHED_FIFO のスレッドで動かす。cpu >= 0 の場合はその CPU に固定する。
+ *            権限がなく SCHED_FIFO にできない場合は、通常のスケジューリングで動かす。
+ * @sa        AppCtrlPid_Stop
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+AppCtrlPid_Start(
+    const SAppCtrlPidParam_t*   param   ///< [in] 制御タスクの設定
+){
+    EHalBool_t          ret = EN_FALSE;
+    pthread_attr_t      attr;
+    struct sched_param  sp;
+    int                 res = 0;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    if( g_param.running )
+    {
+        DBG_PRINT_ERROR( "control task is already running. \n\r" );
+        return ret;
+    }
+
+    if( param == NULL || param->period == 0 || param->outMin > param->outMax || param->tf < 0.0 )
+    {
+        DBG_PRINT_ERROR( "invalid argument error. \n\r" );
+        return ret;
+    }
+
+    g_param.param = *param;
+    g_param.stop  = 0;
+    memset( &g_param.stats, 0, sizeof(g_param.stats) );
+
+    res = -1;
+    if( param->priority > 0 )
+    {
+        memset( &sp, 0, sizeof(sp) );
+        sp.sched_priority = param->priority;
+
+        pthread_attr_init( &attr );
+        pthread_attr_setinheritsched( &attr, PTHREAD_EXPLICIT_SCHED );
+        pthread_attr_setschedpolicy( &attr, SCHED_FIFO );
+        pthread_attr_setschedparam( &attr, &sp );
+        res = pthread_create( &g_param.thread, &attr, Control, NULL );
+        pthread_attr_destroy( &attr );
+
+        if( res != 0 )
+        {
+            DBG_PRINT_WARN( "Unable to use SCHED_FIFO, run with the default policy. : %s \n\r", strerror( res ) );
+        }
+    }
+
+    if( res != 0 && 0 != pthread_create( &g_param.thread, NULL, Control, NULL ) )
+    {
+        DBG_PRINT_ERROR( "fail to create control thread. \n\r" );
+        return ret;
+    }
+
+    g_param.running = 1;
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     制御タスクを停止する。
+ * @attention 出力先のドライバは停止しないので、必要に応じて呼び出し側で止めること。
+ * @note      統計は停止後も取得できる。
+ * @sa        AppCtrlPid_Start
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+AppCtrlPid_Stop(
+    void  ///< [in] ナシ
+){
+    DBG_PRINT_TRACE( "\n\r" );
+
+    if( g_param.running )
+    {
+        __atomic_store_n( &g_param.stop, 1, __ATOMIC_RELEASE );
+        pthread_join( g_param.thread, NULL );
+        g_param.running = 0;
+    }
+
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     目標値を変更する。
+ * @attention なし。
+ * @note      次の周期から反映する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+AppCtrlPid_SetSetpoint(
+    double      setpoint    ///< [in] 目標値 ( 単位: % )
+){
+    pthread_mutex_lock( &g_param.lock );
+    g_param.param.setpoint = setpoint;
+    pthread_mutex_unlock( &g_param.lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     ゲインを変更する。
+ * @attention なし。
+ * @note      次の周期から反映する。積分値はそのまま引き継ぐ。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+AppCtrlPid_SetGain(
+    double      kp,     ///< [in] 比例ゲイン
+    double      ki,     ///< [in] 積分ゲイン ( 単位: 1/sec )
+    double      kd      ///< [in] 微分ゲイン ( 単位: sec )
+){
+    pthread_mutex_lock( &g_param.lock );
+    g_param.param.kp = kp;
+    g_param.param.ki = ki;
+    g_param.param.kd = kd;
+    pthread_mutex_unlock( &g_param.lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     制御タスクの状態を取得する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+AppCtrlPid_GetStats(
+    SAppCtrlPidStats_t*     stats   ///< [out] 制御タスクの状態
+){
+    pthread_mutex_lock( &g_param.lock );
+    *stats = g_param.stats;
+    pthread_mutex_unlock( &g_param.lock );
+    return;
+}
+
+
+#ifdef __cplusplus
+    }
+#endif
+
@@ -0,0 +1,88 @@
+/**************************************************************************//*!
+ *  @file           ctrl_pid.h
+ *  @brief          [APP] 外部公開 API を宣言したヘッダファイル。
+ *  @author         Ryoji Morita
+ *  @attention      none.
+ *                  関数命名規則
+ *                      通常関数 : App[モジュール名]_処理名()
+ *  @sa             none.
+ *  @bug            none.
+ *  @warning        none.
+ *  @version        1.00
+ *  @last updated   2019.01.17
+ *************************************************************************** */
+
+// 多重コンパイル抑止
+#ifndef _APP_CTRL_PID_H_
+#define _APP_CTRL_PID_H_
+
+
+//********************************************************
+/* include                                               */
+//********************************************************
+#include "../../hal/hal.h"
+
+
+//********************************************************
+/*! @def                                                 */
+//********************************************************
+// なし
+
+
+//********************************************************
+/*! @enum                                                */
+//********************************************************
+// なし
+
+
+//********************************************************
+/*! @struct                                              */
+//********************************************************
+// 操作量を出力する関数の型 : output = 操作量 ( outMin ～ outMax ), arg = SAppCtrlPidParam_t::arg
+typedef void (*AppCtrlPidOutput_t)( double output, void* arg );
+
+
+// 制御タスクの設定に使用する型
+typedef struct tagSAppCtrlPidParam
+{
+    EHalSensorMcp3208_t ch;         ///< @var : 制御量を入力する ch
+    unsigned int        period;     ///< @var : 制御周期 ( 単位: usec )
+    int                 priority;   ///< @var : SCHED_FIFO の優先度 ( 1 ～ 99 ) : 0 = 通常のスケジューリング
+    int                 cpu;        ///< @var : 制御スレッドを固定する CPU 番号 : -1 = 固定しない
+    double              setpoint;   ///< @var : 目標値 ( 単位: % = AD 値 / フルスケール )
+    double              kp;         ///< @var : 比例ゲイン
+    double              ki;         ///< @var : 積分ゲイン ( 単位: 1/sec )
+    double              kd;         ///< @var : 微分ゲイン ( 単位: sec )
+    double              tf;         ///< @var : 微分フィルタの時定数 ( 単位: sec ) : 0 = フィルタなし
+    double              outMin;     ///< @var : 操作量の下限
+    double              outMax;     ///< @var : 操作量の上限
+    AppCtrlPidOutput_t  output;     ///< @var : 操作量を出力する関数
+    void*               arg;        ///< @var : output に渡す引数
+} SAppCtrlPidParam_t;
+
+
+// 制御タスクの状態の取得に使用する型
+typedef struct tagSAppCtrlPidStats
+{
+    unsigned long       cycles;     ///< @var : 実行した周期の数
+    unsigned long       overrun;    ///< @var : 周期に間に合わなかった回数
+    unsigned long       missed;     ///< @var : 間に合わずに飛ばした周期の数
+    unsigned long long  execMax;    ///< @var : 1 周期の処理時間の最大値 ( 単位: nsec )
+    double              input;      ///< @var : 最新の制御量 ( 単位: % )
+    double              output;     ///< @var : 最新の操作量
+    double              error;      ///< @var : 最新の偏差 ( 単位: % )
+} SAppCtrlPidStats_t;
+
+
+//********************************************************
+/* 関数プロトタイプ宣言                                  */
+//********************************************************
+EHalBool_t  AppCtrlPid_Start( const SAppCtrlPidParam_t* param );
+void        AppCtrlPid_Stop( void );
+void        AppCtrlPid_SetSetpoint( double setpoint );
+void        AppCtrlPid_SetGain( double kp, double ki, double kd );
+void        AppCtrlPid_GetStats( SAppCtrlPidStats_t* stats );
+
+
+#endif /* _APP_CTRL_PID_H_ */
+
@@ -32,7 +32,7 @@
 //********************************************************
 /*! @def                                                 */
 //********************************************************
-// なし
+#define LCD_FLUSH_GAP   (4)     // 差分の間にある一致セルがこの数未満なら、カーソル移動せずに書き直す
 
 
 //********************************************************
@@ -44,21 +44,157 @@
 //********************************************************
 /*! @struct                                              */
 //********************************************************
-// なし
+// LCD のフレームバッファ
+typedef struct {
+    int             ready;                              // 初期化済みか否か
+    char            fb[APP_LCD_MAX_Y][APP_LCD_MAX_X];   // 表示したい内容
+    char            lcd[APP_LCD_MAX_Y][APP_LCD_MAX_X];  // LCD に送信済みの内容
+    int             x;                                  // フレームバッファのカーソル位置 : X 軸
+    int             y;                                  // フレームバッファのカーソル位置 : Y 軸
+    int             lcdX;                               // LCD のカーソル位置 : X 軸 ( 不明 = -1 )
+    int             lcdY;                               // LCD のカーソル位置 : Y 軸 ( 不明 = -1 )
+    int             curDir;                             // カーソルの進む方向 [ インクリメント = 1, デクリメント = 0 ]
+    int             curDisp;                            // カーソル表示の ON/OFF
+} SAppIfLcd_t;
 
 
 //********************************************************
 /* モジュールグローバル変数                              */
 //********************************************************
-// なし
+static SAppIfLcd_t      g_param;
 
 
 //********************************************************
 /* 関数プロトタイプ宣言                                  */
 //********************************************************
-// なし
+static void         InitParam( void );
+static EHalBool_t   SetLcdCursor( int x, int y );
+static EHalBool_t   WriteRun( int x, int y, int len );
+
+
+
+
+/**************************************************************************//*!
+ * @brief     ファイルスコープ内のグローバル変数を初期化する。
+ * @attention なし。
+ * @note      HalI2cLcd_Init() で表示はクリア済み、カーソルはホームにある前提とする。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+InitParam(
+    void  ///< [in] ナシ
+){
+    if( g_param.ready )
+    {
+        return;
+    }
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    memset( g_param.fb,  ' ', sizeof(g_param.fb)  );
+    memset( g_param.lcd, ' ', sizeof(g_param.lcd) );
+    g_param.x       = 0;
+    g_param.y       = 0;
+    g_param.lcdX    = 0;
+    g_param.lcdY    = 0;
+    g_param.curDir  = 1;
+    g_param.curDisp = 1;    // HalI2cLcd_Init() でカーソル表示 ON
+    g_param.ready   = 1;
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     LCD のカーソルを移動させる。
+ * @attention なし。
+ * @note      LCD のカーソルが既に (x, y) にある場合は送信しない。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+SetLcdCursor(
+    int     x,  ///< [in] x 座標
+    int     y   ///< [in] y 座標
+){
+    EHalBool_t  ret = EN_TRUE;
+
+    if( g_param.lcdX == x && g_param.lcdY == y )
+    {
+        return ret;
+    }
 
+    ret = HalI2cLcd_Write( EN_LCD_CMD, ( x + (y << 5) ) | 0x80 ); // (y << 5) == (y * 0x20)
+    if( ret == EN_FALSE )
+    {
+        g_param.lcdX = -1;
+        g_param.lcdY = -1;
+        return ret;
+    }
 
+    g_param.lcdX = x;
+    g_param.lcdY = y;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     フレームバッファの (x, y) から len 文字を LCD に送信する。
+ * @attention なし。
+ * @note      カーソル移動が必要な場合は、カーソル移動コマンドとデータを 1 回の I2C 転送にまとめる。
+ *            カーソルがデクリメント方向の場合は、run の末尾から先頭へ向かって送信する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+WriteRun(
+    int     x,      ///< [in] x 座標
+    int     y,      ///< [in] y 座標
+    int     len     ///< [in] 文字数
+){
+    EHalBool_t      ret = EN_FALSE;
+    unsigned char   buff[APP_LCD_MAX_X];
+    int             step = g_param.curDir ? 1 : -1;
+    int             i;
+    int             n;
+
+    if( step < 0 )
+    {
+        x = x + len - 1;
+    }
+
+    for( i = x, n = 0; n < len; i += step, n++ )
+    {
+        buff[n] = g_param.fb[y][i];
+    }
+
+    if( g_param.lcdX == x && g_param.lcdY == y )
+    {
+        ret = HalI2cLcd_WriteData( buff, len );
+    } else
+    {
+        ret = HalI2cLcd_WriteCmdData( ( x + (y << 5) ) | 0x80, buff, len ); // (y << 5) == (y * 0x20)
+    }
+
+    if( ret == EN_FALSE )
+    {
+        g_param.lcdX = -1;
+        g_param.lcdY = -1;
+        return ret;
+    }
+
+    for( i = x, n = 0; n < len; i += step, n++ )
+    {
+        g_param.lcd[y][i] = g_param.fb[y][i];
+    }
+    g_param.lcdX = i;
+    g_param.lcdY = y;
+
+    return ret;
+}
 
 
 /**************************************************************************//*!
@@ -78,8 +214,8 @@ AppIfLcd_Entry(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    // I2C スレーブデバイスを LCD に変える
-    HalCmnI2c_SetSlave( I2C_SLAVE_LCD );
+    InitParam();
+    g_param.curDir = curDir ? 1 : 0;
 
     cfg = 0x04;
     if( curDir  ){ cfg |= 0x02; }
@@ -108,8 +244,8 @@ AppIfLcd_Ctrl(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    // I2C スレーブデバイスを LCD に変える
-    HalCmnI2c_SetSlave( I2C_SLAVE_LCD );
+    InitParam();
+    g_param.curDisp = ( curDisp || blkDisp ) ? 1 : 0;
 
     cfg = 0x08;
     if( disp     ){ cfg |= 0x04; }
@@ -124,7 +260,7 @@ AppIfLcd_Ctrl(
 /**************************************************************************//*!
  * @brief     表示 or カーソルのシフトを設定する。
  * @attention なし。
- * @note      なし。
+ * @note      カーソルをシフトした場合、LCD のカーソル位置は不明として扱う。
  * @sa        なし。
  * @author    Ryoji Morita
  * @return    なし。
@@ -138,8 +274,12 @@ AppIfLcd_Shift(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    // I2C スレーブデバイスを LCD に変える
-    HalCmnI2c_SetSlave( I2C_SLAVE_LCD );
+    InitParam();
+    if( !tgt )
+    {
+        g_param.lcdX = -1;
+        g_param.lcdY = -1;
+    }
 
     cfg = 0x10;
     if( tgt ){ cfg |= 0x80; }
@@ -153,7 +293,7 @@ AppIfLcd_Shift(
 /**************************************************************************//*!
  * @brief     カーソルをホームへ移動させる。
  * @attention なし。
- * @note      なし。
+ * @note      フレームバッファのカーソルを移動させる。LCD への反映は AppIfLcd_Flush() で行う。
  * @sa        なし。
  * @author    Ryoji Morita
  * @return    なし。
@@ -164,10 +304,7 @@ AppIfLcd_CursorHome(
 ){
     DBG_PRINT_TRACE( "\n\r" );
 
-    // I2C スレーブデバイスを LCD に変える
-    HalCmnI2c_SetSlave( I2C_SLAVE_LCD );
-
-    HalI2cLcd_Write( EN_LCD_CMD, 0x02 );
+    AppIfLcd_CursorSet( 0, 0 );
     return;
 }
 
@@ -175,7 +312,7 @@ AppIfLcd_CursorHome(
 /**************************************************************************//*!
  * @brief     カーソルを指定した (x, y) へ移動させる。
  * @attention なし。
- * @note      なし。
+ * @note      フレームバッファのカーソルを移動させる。LCD への反映は AppIfLcd_Flush() で行う。
  * @sa        なし。
  * @author    Ryoji Morita
  * @return    なし。
@@ -187,10 +324,9 @@ AppIfLcd_CursorSet(
 ){
     DBG_PRINT_TRACE( "\n\r" );
 
-    // I2C スレーブデバイスを LCD に変える
-    HalCmnI2c_SetSlave( I2C_SLAVE_LCD );
-
-    HalI2cLcd_Write( EN_LCD_CMD, ( x + (y << 5) ) | 0x80 ); // (y << 5) == (y * 0x20)
+    InitParam();
+    g_param.x = x;
+    g_param.y = y;
     return;
 }
 
@@ -198,7 +334,7 @@ AppIfLcd_CursorSet(
 /**************************************************************************//*!
  * @brief     表示をクリアし、カーソルをホーム ( x, y ) = ( 0, 0 ) へ移動させる。
  * @attention なし。
- * @note      なし。
+ * @note      フレームバッファを空白で埋め、差分だけを LCD に送信する。
  * @sa        なし。
  * @author    Ryoji Morita
  * @return    なし。
@@ -209,15 +345,82 @@ AppIfLcd_Clear(
 ){
     DBG_PRINT_TRACE( "\n\r" );
 
-    // I2C スレーブデバイスを LCD に変える
-    HalCmnI2c_SetSlave( I2C_SLAVE_LCD );
-
-    HalI2cLcd_Write( EN_LCD_CMD, 0x01 );
+    InitParam();
+    memset( g_param.fb, ' ', sizeof(g_param.fb) );
     AppIfLcd_CursorHome();
+    AppIfLcd_Flush();
     return;
 }
 
 
+/**************************************************************************//*!
+ * @brief     フレームバッファの変更を LCD に反映する。
+ * @attention なし。
+ * @note      LCD に送信済みの内容と比較し、変更のあったセルだけを
+ *            「カーソル移動 + 連続データ」の組で送信する。
+ *            カーソル表示が ON の場合は、最後に LCD のカーソルをフレームバッファの
+ *            カーソル位置に合わせる。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+AppIfLcd_Flush(
+    void
+){
+    EHalBool_t  ret = EN_TRUE;
+    int         x;
+    int         y;
+    int         start;
+    int         end;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    InitParam();
+
+    for( y = 0; y < APP_LCD_MAX_Y; y++ )
+    {
+        x = 0;
+        while( x < APP_LCD_MAX_X )
+        {
+            // 差分の先頭を探す
+            if( g_param.fb[y][x] == g_param.lcd[y][x] )
+            {
+                x++;
+                continue;
+            }
+
+            // 一致セルが LCD_FLUSH_GAP 個以上続くところまでを 1 つの run とする
+            start = x;
+            end   = x + 1;
+            for( x = end; x < APP_LCD_MAX_X && x < end + LCD_FLUSH_GAP; x++ )
+            {
+                if( g_param.fb[y][x] != g_param.lcd[y][x] )
+                {
+                    end = x + 1;
+                }
+            }
+
+            ret = WriteRun( start, y, end - start );
+            if( ret == EN_FALSE )
+            {
+                return ret;
+            }
+            x = end;
+        }
+    }
+
+    if( g_param.curDisp
+     && g_param.x >= 0 && g_param.x < APP_LCD_MAX_X
+     && g_param.y >= 0 && g_param.y < APP_LCD_MAX_Y )
+    {
+        ret = SetLcdCursor( g_param.x, g_param.y );
+    }
+
+    return ret;
+}
+
+
 /**************************************************************************//*!
  * @brief     LCD に 1 文字を表示する。
  * @attention なし。
@@ -235,10 +438,15 @@ AppIfLcd_Putc(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    // I2C スレーブデバイスを LCD に変える
-    HalCmnI2c_SetSlave( I2C_SLAVE_LCD );
+    InitParam();
+    if( g_param.x >= 0 && g_param.x < APP_LCD_MAX_X
+     && g_param.y >= 0 && g_param.y < APP_LCD_MAX_Y )
+    {
+        g_param.fb[g_param.y][g_param.x] = c;
+    }
+    g_param.x += g_param.curDir ? 1 : -1;
 
-    res = HalI2cLcd_Write( EN_LCD_DAT, c );
+    res = AppIfLcd_Flush();
 
     if( res == EN_FALSE )
     {
@@ -254,8 +462,8 @@ AppIfLcd_Putc(
 
 /**************************************************************************//*!
  * @brief     LCD に文字列を表示する。
- * @attention なし。
- * @note      なし。
+ * @attention 表示範囲 ( APP_LCD_MAX_X x APP_LCD_MAX_Y ) の外の文字は捨てる。
+ * @note      フレームバッファに書き込んだあと、まとめて AppIfLcd_Flush() する。
  * @sa        なし。
  * @author    Ryoji Morita
  * @return    成功時 = 出力した文字数 , 失敗時 = EOF
@@ -270,24 +478,22 @@ AppIfLcd_Puts(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    // I2C スレーブデバイスを LCD に変える
-    HalCmnI2c_SetSlave( I2C_SLAVE_LCD );
-
+    InitParam();
     while( *str != '\0' )
     {
-        res = HalI2cLcd_Write( EN_LCD_DAT, *str++ );
-
-        if( res == EN_FALSE )
-        {
-            ret = EOF;
-            break;
-        } else
+        if( g_param.x >= 0 && g_param.x < APP_LCD_MAX_X
+         && g_param.y >= 0 && g_param.y < APP_LCD_MAX_Y )
         {
-            cnt++;
+            g_param.fb[g_param.y][g_param.x] = *str;
         }
+        g_param.x += g_param.curDir ? 1 : -1;
+        str++;
+        cnt++;
     }
 
-    if( cnt > 0 )
+    res = AppIfLcd_Flush();
+
+    if( res == EN_TRUE && cnt > 0 )
     {
         ret = cnt;
     } else
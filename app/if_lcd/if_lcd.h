@@ -51,6 +51,7 @@ void AppIfLcd_Shift( int tgt, int dir );
 void AppIfLcd_CursorHome( void );
 void AppIfLcd_CursorSet( int x, int y );
 void AppIfLcd_Clear( void );
+EHalBool_t AppIfLcd_Flush( void );
 
 int  AppIfLcd_Putc( int c );
 int  AppIfLcd_Puts( const char* str );
@@ -0,0 +1,687 @@
+/**************************************************************************//*!
+ *  @file           if_sock.c
+ *  @brief          [APP] Unix ドメイン・ソケットでコマンドを受け付けるデーモンを定義したファイル。
+ *  @author         Ryoji Morita
+ *  @attention      none.
+ *  @sa             cmd.c
+ *  @note           プロトコルは 1 行 1 コマンドのテキスト ( 改行区切り )。応答も 1 行。
+ *                  1 回の read() で受信した複数のコマンドは順に実行し、応答をまとめて 1 回の write() で返す。
+ *                  "shutdown" でデーモンを終了する。SIGINT / SIGTERM でも終了する。
+ *                  "tlm [周期[Hz][,ch,ch...]]" を送ると、その接続はテレメトリ ( NDJSON ) の出力専用になり、
+ *                  切断するまでデーモン内のモータの状態を含めて出力する。後続のコマンドは読み捨てる。
+ *                  "st wait" は移動が完了するまで応答を遅らせる。その間、そのクライアントの後続のコマンドは
+ *                  実行しないが、他のクライアントのコマンド ( "st stop" など ) は受け付ける。
+ *  @bug            none.
+ *  @warning        none.
+ *  @version        1.00
+ *  @last updated   2019.01.17
+ *************************************************************************** */
+#ifdef __cplusplus
+    extern "C"{
+#endif
+
+
+//********************************************************
+/* include                                               */
+//********************************************************
+#define _GNU_SOURCE     // accept4()
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "if_sock.h"
+#include "../cmd/cmd.h"
+#include "../tlm/tlm.h"
+
+
+//#define DBG_PRINT
+#define MY_NAME "APP"
+#include "../log/log.h"
+
+
+//********************************************************
+/*! @def                                                 */
+//********************************************************
+#define SOCK_CLIENT_NUM     (16)                            // 同時に接続できるクライアント数
+#define SOCK_RX_MAX         (APP_CMD_LINE_MAX + 1)          // 受信バッファ ( 1 行 + 改行 )
+#define SOCK_TX_MAX         (32 * APP_CMD_RESP_MAX)         // 送信バッファ ( まとめて返す応答 )
+#define SOCK_BACKLOG        (4)
+#define SOCK_POLL_MSEC      (10)                            // 完了待ちのクライアントを調べる周期 ( 単位: msec )
+#define SOCK_TLM_TIMEOUT    (1)                             // テレメトリの送信が詰まった場合に諦めるまでの時間 ( 単位: sec )
+
+
+//********************************************************
+/*! @enum                                                */
+//********************************************************
+// なし
+
+
+//********************************************************
+/*! @struct                                              */
+//********************************************************
+// クライアントごとの状態
+typedef struct {
+    int             fd;                 // -1 = 未使用
+    unsigned int    len;                // 受信バッファ内の未処理の Byte 数
+    EHalBool_t      drop;               // EN_TRUE = 長すぎる行を改行まで読み捨て中
+    EHalBool_t      wait;               // EN_TRUE = 先頭の行 ( "st wait" ) の完了待ち。受信を止めている
+    char            rx[SOCK_RX_MAX];
+} SAppSockClient_t;
+
+typedef struct {
+    int                 lfd;            // 待ち受けソケット
+    int                 epfd;
+    SAppSockClient_t    client[SOCK_CLIENT_NUM];
+    char                tx[SOCK_TX_MAX];
+} SAppSockParam_t;
+
+
+//********************************************************
+/* モジュールグローバル変数                              */
+//********************************************************
+static SAppSockParam_t      g_param;
+static volatile sig_atomic_t g_stop = 0;   // EN_TRUE = 終了要求
+
+
+//********************************************************
+/* 関数プロトタイプ宣言                                  */
+//********************************************************
+static void         Handler( int sig );
+static EHalBool_t   Open( const char* path );
+static void         Close( const char* path );
+static void         Accept( void );
+static void         Drop( SAppSockClient_t* client );
+static EHalBool_t   Send( int fd, const char* data, unsigned int size );
+static void         Watch( SAppSockClient_t* client, unsigned int events );
+static EHalBool_t   Stream( SAppSockClient_t* client, char* arg );
+static void         Exec( SAppSockClient_t* client );
+static void         Recv( SAppSockClient_t* client );
+
+
+
+
+/**************************************************************************//*!
+ * @brief     SIGINT / SIGTERM のハンドラ。
+ * @attention なし。
+ * @note      SA_RESTART を付けないため、epoll_wait() は EINTR で戻る。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Handler(
+    int             sig     ///< [in] シグナル番号
+){
+    g_stop = EN_TRUE;
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     待ち受けソケットと epoll を作成する。
+ * @attention なし。
+ * @note      前回のソケット・ファイルが残っていれば削除してから bind() する。
+ * @sa        Close()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Open(
+    const char*     path    ///< [in] ソケットのパス
+){
+    EHalBool_t          ret = EN_FALSE;
+    struct sockaddr_un  addr;
+    struct epoll_event  ev;
+    int                 i = 0;
+
+    DBG_PRINT_TRACE( "path = %s \n\r", path );
+
+    memset( &g_param, 0, sizeof(g_param) );
+    g_param.lfd  = -1;
+    g_param.epfd = -1;
+    for( i = 0; i < SOCK_CLIENT_NUM; i++ )
+    {
+        g_param.client[i].fd = -1;
+    }
+
+    if( strlen( path ) >= sizeof(addr.sun_path) )
+    {
+        DBG_PRINT_ERROR( "too long path. : %s \n\r", path );
+        return ret;
+    }
+
+    memset( &addr, 0, sizeof(addr) );
+    addr.sun_family = AF_UNIX;
+    strcpy( addr.sun_path, path );
+    unlink( path );
+
+    g_param.lfd = socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+    if( g_param.lfd < 0 )
+    {
+        DBG_PRINT_ERROR( "socket() error. : %s \n\r", strerror( errno ) );
+        return ret;
+    }
+
+    if( 0 != bind( g_param.lfd, (struct sockaddr*)&addr, sizeof(addr) )
+     || 0 != listen( g_param.lfd, SOCK_BACKLOG ) )
+    {
+        DBG_PRINT_ERROR( "bind()/listen() error. : %s \n\r", strerror( errno ) );
+        return ret;
+    }
+
+    g_param.epfd = epoll_create1( EPOLL_CLOEXEC );
+    if( g_param.epfd < 0 )
+    {
+        DBG_PRINT_ERROR( "epoll_create1() error. : %s \n\r", strerror( errno ) );
+        return ret;
+    }
+
+    memset( &ev, 0, sizeof(ev) );
+    ev.events   = EPOLLIN;
+    ev.data.ptr = NULL;     // NULL = 待ち受けソケット
+    if( 0 != epoll_ctl( g_param.epfd, EPOLL_CTL_ADD, g_param.lfd, &ev ) )
+    {
+        DBG_PRINT_ERROR( "epoll_ctl() error. : %s \n\r", strerror( errno ) );
+        return ret;
+    }
+
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     全てのソケットを閉じる。
+ * @attention なし。
+ * @note      ソケット・ファイルも削除する。テレメトリの出力も止める。
+ * @sa        Open()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Close(
+    const char*     path    ///< [in] ソケットのパス
+){
+    int             i = 0;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    AppTlm_StopAll();
+    for( i = 0; i < SOCK_CLIENT_NUM; i++ )
+    {
+        Drop( &g_param.client[i] );
+    }
+
+    if( g_param.epfd >= 0 )
+    {
+        close( g_param.epfd );
+        g_param.epfd = -1;
+    }
+
+    if( g_param.lfd >= 0 )
+    {
+        close( g_param.lfd );
+        g_param.lfd = -1;
+        unlink( path );
+    }
+
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     クライアントの接続を受け付ける。
+ * @attention なし。
+ * @note      空きが無い場合は、すぐに切断する。
+ * @sa        Drop()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Accept(
+    void
+){
+    SAppSockClient_t*   client = NULL;
+    struct epoll_event  ev;
+    int                 fd = -1;
+    int                 i = 0;
+
+    fd = accept4( g_param.lfd, NULL, NULL, SOCK_CLOEXEC );
+    if( fd < 0 )
+    {
+        DBG_PRINT_ERROR( "accept4() error. : %s \n\r", strerror( errno ) );
+        return;
+    }
+
+    for( i = 0; i < SOCK_CLIENT_NUM; i++ )
+    {
+        if( g_param.client[i].fd < 0 )
+        {
+            client = &g_param.client[i];
+            break;
+        }
+    }
+
+    if( client == NULL )
+    {
+        DBG_PRINT_ERROR( "too many clients. \n\r" );
+        Send( fd, "ERR busy\n", strlen("ERR busy\n") );
+        close( fd );
+        return;
+    }
+
+    memset( &ev, 0, sizeof(ev) );
+    ev.events   = EPOLLIN;
+    ev.data.ptr = client;
+    if( 0 != epoll_ctl( g_param.epfd, EPOLL_CTL_ADD, fd, &ev ) )
+    {
+        DBG_PRINT_ERROR( "epoll_ctl() error. : %s \n\r", strerror( errno ) );
+        close( fd );
+        return;
+    }
+
+    client->fd   = fd;
+    client->len  = 0;
+    client->drop = EN_FALSE;
+    client->wait = EN_FALSE;
+    DBG_PRINT_TRACE( "client[%d] connected. \n\r", i );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     クライアントを切断する。
+ * @attention なし。
+ * @note      close() すると epoll の監視対象からも外れる。
+ * @sa        Accept()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Drop(
+    SAppSockClient_t*   client  ///< [in] クライアント
+){
+    if( client->fd >= 0 )
+    {
+        close( client->fd );
+        client->fd   = -1;
+        client->len  = 0;
+        client->wait = EN_FALSE;
+    }
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     データを全て送信する。
+ * @attention なし。
+ * @note      SIGPIPE は無視しているため、切断済みの相手には EPIPE で失敗する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Send(
+    int             fd,     ///< [in] ソケット
+    const char*     data,   ///< [in] データ
+    unsigned int    size    ///< [in] データの Byte 数
+){
+    ssize_t         len = 0;
+
+    while( size > 0 )
+    {
+        len = write( fd, data, size );
+        if( len < 0 )
+        {
+            if( errno == EINTR )
+            {
+                continue;
+            }
+            return EN_FALSE;
+        }
+        data += len;
+        size -= len;
+    }
+
+    return EN_TRUE;
+}
+
+
+/**************************************************************************//*!
+ * @brief     クライアントの監視イベントを変更する。
+ * @attention なし。
+ * @note      events = 0 でも EPOLLHUP / EPOLLERR は通知される。
+ * @sa        Exec()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Watch(
+    SAppSockClient_t*   client, ///< [in] クライアント
+    unsigned int        events  ///< [in] 監視するイベント
+){
+    struct epoll_event  ev;
+
+    memset( &ev, 0, sizeof(ev) );
+    ev.events   = events;
+    ev.data.ptr = client;
+    if( 0 != epoll_ctl( g_param.epfd, EPOLL_CTL_MOD, client->fd, &ev ) )
+    {
+        DBG_PRINT_ERROR( "epoll_ctl() error. : %s \n\r", strerror( errno ) );
+    }
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     クライアントの接続をテレメトリの出力に切り替える。
+ * @attention 呼ぶ前に、それまでの応答を送信しておくこと。
+ * @note      成功した場合、接続は AppTlm_Start() のスレッドに渡し、クライアントの枠を空ける。
+ *            読み出し側が SOCK_TLM_TIMEOUT 秒以上受け取らない場合は、出力を止めて切断する。
+ * @sa        AppTlm_Start()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗 ( 接続はコマンド用のまま )
+ *************************************************************************** */
+static EHalBool_t
+Stream(
+    SAppSockClient_t*   client, ///< [in] クライアント
+    char*               arg     ///< [in] 引数 ( "周期[Hz][,ch,ch...]", 空 = 既定値 )
+){
+    SAppTlmParam_t      param;
+    struct epoll_event  ev;
+    struct timeval      tv = { SOCK_TLM_TIMEOUT, 0 };
+    unsigned int        len = 0;
+
+    while( *arg == ' ' )
+    {
+        arg++;
+    }
+    len = strlen( arg );
+    while( len > 0 && ( arg[len - 1] == ' ' || arg[len - 1] == '\r' ) )
+    {
+        arg[--len] = '\0';
+    }
+
+    if( EN_FALSE == AppTlm_Parse( ( len > 0 ) ? arg : NULL, &param ) )
+    {
+        return EN_FALSE;
+    }
+    param.motor = EN_TRUE;
+    param.fd    = client->fd;
+
+    // スレッドに渡す前に監視を外す ( 渡した後は epoll から触らない )
+    epoll_ctl( g_param.epfd, EPOLL_CTL_DEL, client->fd, NULL );
+    setsockopt( client->fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv) );
+    if( EN_FALSE == AppTlm_Start( &param ) )
+    {
+        memset( &ev, 0, sizeof(ev) );
+        ev.events   = EPOLLIN;
+        ev.data.ptr = client;
+        epoll_ctl( g_param.epfd, EPOLL_CTL_ADD, client->fd, &ev );
+        return EN_FALSE;
+    }
+
+    DBG_PRINT_TRACE( "client streams telemetry. \n\r" );
+    client->fd   = -1;
+    client->len  = 0;
+    client->wait = EN_FALSE;
+    return EN_TRUE;
+}
+
+
+/**************************************************************************//*!
+ * @brief     受信バッファ内のコマンドを実行して応答を返す。
+ * @attention なし。
+ * @note      受信バッファ内の完全な行を全て実行し、応答はまとめて送信する。
+ *            改行の無い残りは次の受信まで保持する。
+ *            APP_CMD_LINE_MAX を超える行は、改行まで読み捨てて "ERR too long" を返す。
+ *            すぐに実行できない行 ( 移動中の "st wait" ) があれば、そこで止めて受信も止める。
+ *            "tlm" は、それまでの応答を送ってから接続をテレメトリの出力に切り替える。
+ *            AppIfSock_Serve() が SOCK_POLL_MSEC 周期で呼び直し、実行できたら受信を再開する。
+ * @sa        AppCmd_Exec(), AppCmd_IsReady()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Exec(
+    SAppSockClient_t*   client  ///< [in] クライアント
+){
+    unsigned int    tx = 0;
+    unsigned int    head = 0;
+    char*           eol = NULL;
+    EHalBool_t      wait = client->wait;
+
+    client->wait = EN_FALSE;
+    while( head < client->len )
+    {
+        eol = memchr( &client->rx[head], '\n', client->len - head );
+        if( eol == NULL )
+        {
+            break;
+        }
+        *eol = '\0';
+
+        if( client->drop == EN_TRUE )
+        {
+            client->drop = EN_FALSE;    // 長すぎる行の末尾
+            strcpy( &g_param.tx[tx], "ERR too long\n" );
+        } else if( 0 == strcmp( &client->rx[head], "shutdown" ) || 0 == strcmp( &client->rx[head], "shutdown\r" ) )
+        {
+            strcpy( &g_param.tx[tx], "OK\n" );
+            g_stop = EN_TRUE;
+        } else if( 0 == strncmp( &client->rx[head], "tlm", 3 ) && NULL != strchr( " \r", client->rx[head + 3] ) )
+        {
+            // "tlm" / "tlm <arg>" ( strchr() は終端の '\0' にも一致する )
+            if( tx > 0 && EN_FALSE == Send( client->fd, g_param.tx, tx ) )
+            {
+                Drop( client );
+                return;
+            }
+            tx = 0;
+            if( EN_TRUE == Stream( client, &client->rx[head + 3] ) )
+            {
+                return;     // 以降は出力専用。残りの行は読み捨てる
+            }
+            strcpy( &g_param.tx[tx], "ERR invalid argument or telemetry unavailable\n" );
+        } else if( EN_FALSE == AppCmd_IsReady( &client->rx[head] ) )
+        {
+            *eol = '\n';
+            client->wait = EN_TRUE;     // 完了してから実行する
+            break;
+        } else
+        {
+            AppCmd_Exec( &client->rx[head], &g_param.tx[tx], SOCK_TX_MAX - tx );
+        }
+        tx += strlen( &g_param.tx[tx] );
+        head = eol - client->rx + 1;
+
+        if( SOCK_TX_MAX - tx < APP_CMD_RESP_MAX )
+        {
+            if( EN_FALSE == Send( client->fd, g_param.tx, tx ) )
+            {
+                Drop( client );
+                return;
+            }
+            tx = 0;
+        }
+    }
+
+    if( head > 0 )
+    {
+        memmove( client->rx, &client->rx[head], client->len - head );
+        client->len -= head;
+    }
+
+    if( client->wait == EN_FALSE && client->len == SOCK_RX_MAX )
+    {
+        DBG_PRINT_ERROR( "too long line. \n\r" );
+        client->len  = 0;
+        client->drop = EN_TRUE;     // 改行まで読み捨てる
+    }
+
+    if( tx > 0 && EN_FALSE == Send( client->fd, g_param.tx, tx ) )
+    {
+        Drop( client );
+        return;
+    }
+
+    if( client->wait != wait )
+    {
+        Watch( client, ( client->wait == EN_TRUE ) ? 0 : EPOLLIN );
+    }
+
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     コマンドを受信して実行する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        Exec()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Recv(
+    SAppSockClient_t*   client  ///< [in] クライアント
+){
+    ssize_t         len = 0;
+
+    len = read( client->fd, &client->rx[client->len], SOCK_RX_MAX - client->len );
+    if( len <= 0 )
+    {
+        if( len < 0 && errno == EINTR )
+        {
+            return;
+        }
+        DBG_PRINT_TRACE( "client disconnected. \n\r" );
+        Drop( client );
+        return;
+    }
+    client->len += len;
+
+    Exec( client );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     Unix ドメイン・ソケットでコマンドを受け付ける。
+ * @attention なし。
+ * @note      "shutdown" を受信するか、SIGINT / SIGTERM を受けるまで戻らない。
+ *            デバイスはコマンドが初めて使うときに初期化する。
+ * @sa        AppCmd_Exec()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+AppIfSock_Serve(
+    const char*     path    ///< [in] ソケットのパス ( NULL = APP_SOCK_PATH )
+){
+    EHalBool_t          ret = EN_FALSE;
+    struct sigaction    sa;
+    struct sigaction    old_int;
+    struct sigaction    old_term;
+    struct sigaction    old_pipe;
+    struct epoll_event  ev[SOCK_CLIENT_NUM + 1];
+    SAppSockClient_t*   client = NULL;
+    int                 timeout = -1;
+    int                 num = 0;
+    int                 i = 0;
+
+    if( path == NULL )
+    {
+        path = APP_SOCK_PATH;
+    }
+
+    DBG_PRINT_TRACE( "path = %s \n\r", path );
+
+    memset( &sa, 0, sizeof(sa) );
+    sigemptyset( &sa.sa_mask );
+    sa.sa_handler = Handler;
+    sigaction( SIGINT,  &sa, &old_int );
+    sigaction( SIGTERM, &sa, &old_term );
+    sa.sa_handler = SIG_IGN;
+    sigaction( SIGPIPE, &sa, &old_pipe );
+
+    g_stop = EN_FALSE;
+    if( EN_TRUE == Open( path ) )
+    {
+        printf( "listening on %s \n\r", path );
+        fflush( stdout );
+        ret = EN_TRUE;
+    }
+
+    while( ret == EN_TRUE && g_stop == EN_FALSE )
+    {
+        timeout = -1;
+        for( i = 0; i < SOCK_CLIENT_NUM; i++ )
+        {
+            if( g_param.client[i].fd >= 0 && g_param.client[i].wait == EN_TRUE )
+            {
+                timeout = SOCK_POLL_MSEC;
+            }
+        }
+
+        num = epoll_wait( g_param.epfd, ev, SOCK_CLIENT_NUM + 1, timeout );
+        if( num < 0 )
+        {
+            if( errno != EINTR )
+            {
+                DBG_PRINT_ERROR( "epoll_wait() error. : %s \n\r", strerror( errno ) );
+                ret = EN_FALSE;
+            }
+            continue;
+        }
+
+        for( i = 0; i < num; i++ )
+        {
+            if( ev[i].data.ptr == NULL )
+            {
+                Accept();
+                continue;
+            }
+
+            client = (SAppSockClient_t*)ev[i].data.ptr;
+            if( client->fd < 0 )
+            {
+                continue;
+            } else if( client->wait == EN_TRUE )
+            {
+                Drop( client );     // 完了待ちの間に切断された ( EPOLLHUP / EPOLLERR )
+            } else
+            {
+                Recv( client );
+            }
+        }
+
+        for( i = 0; i < SOCK_CLIENT_NUM; i++ )
+        {
+            if( g_param.client[i].fd >= 0 && g_param.client[i].wait == EN_TRUE )
+            {
+                Exec( &g_param.client[i] );
+            }
+        }
+    }
+
+    Close( path );
+
+    sigaction( SIGINT,  &old_int,  NULL );
+    sigaction( SIGTERM, &old_term, NULL );
+    sigaction( SIGPIPE, &old_pipe, NULL );
+    return ret;
+}
+
+
+#ifdef __cplusplus
+    }
+#endif
+
@@ -0,0 +1,51 @@
+/**************************************************************************//*!
+ *  @file           if_sock.h
+ *  @brief          [APP] 外部公開 API を宣言したヘッダファイル。
+ *  @author         Ryoji Morita
+ *  @attention      none.
+ *                  関数命名規則
+ *                      通常関数 : App[モジュール名]_処理名()
+ *  @sa             none.
+ *  @bug            none.
+ *  @warning        none.
+ *  @version        1.00
+ *  @last updated   2019.01.17
+ *************************************************************************** */
+
+// 多重コンパイル抑止
+#ifndef _APP_IF_SOCK_H_
+#define _APP_IF_SOCK_H_
+
+
+//********************************************************
+/* include                                               */
+//********************************************************
+#include "../../hal/hal.h"
+
+
+//********************************************************
+/*! @def                                                 */
+//********************************************************
+#define APP_SOCK_PATH       "/tmp/board.sock"   ///< @def : デーモンが待ち受ける Unix ドメイン・ソケットの既定のパス
+
+
+//********************************************************
+/*! @enum                                                */
+//********************************************************
+// なし
+
+
+//********************************************************
+/*! @struct                                              */
+//********************************************************
+// なし
+
+
+//********************************************************
+/* 関数プロトタイプ宣言                                  */
+//********************************************************
+EHalBool_t  AppIfSock_Serve( const char* path );
+
+
+#endif /* _APP_IF_SOCK_H_ */
+
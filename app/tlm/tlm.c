@@ -0,0 +1,567 @@
+/**************************************************************************//*!
+ *  @file           tlm.c
+ *  @brief          [APP] センサとモータの状態を NDJSON ( 1 行 1 JSON ) で一定周期に出力する。
+ *  @author         Ryoji Morita
+ *  @attention      1 行の形式
+ *                      {"seq":0,"ts":1547683200.123456,"adc":{"0":12,"7":2048},
+ *                       "dc":["cw",30.0],"dc2":["cw",30.0],"sv":["standby",0.0],"st":90000}
+ *                  seq : 通し番号, ts : 時刻 ( UNIX 時間, 単位: sec ), adc : AD 値,
+ *                  dc / dc2 / sv : [ 状態, デューティ比 (%) ], st : ステッピング・モータの位置 ( 単位: ミリ度 )
+ *                  dc / dc2 / sv / st は motor = EN_TRUE の場合だけ出力する。
+ *  @sa             if_sock.c
+ *  @note           行は確保済みのバッファに書き込み、batch 行ごとに 1 回の write() で出力する。
+ *                  AD 値は 1 周期に 1 回、対象の全 ch をまとめて読み出す。
+ *                  モータの状態は同じプロセスで最後に設定した値なので、モータを動かすデーモンの中で
+ *                  AppTlm_Start() を使って出力する。単独の AppTlm_Run() ではモータの状態を出力しない。
+ *  @bug            none.
+ *  @warning        none.
+ *  @version        1.00
+ *  @last updated   2019.01.17
+ *************************************************************************** */
+#ifdef __cplusplus
+    extern "C"{
+#endif
+
+
+//********************************************************
+/* include                                               */
+//********************************************************
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tlm.h"
+#include "../../sys/sys.h"
+
+
+//#define DBG_PRINT
+#define MY_NAME "APP"
+#include "../log/log.h"
+
+
+//********************************************************
+/*! @def                                                 */
+//********************************************************
+#define TLM_LINE_MAX    (384)           // 1 行の最大 Byte 数 ( 8 ch 全てで約 200 Byte )
+#define NSEC_PER_SEC    (1000000000ULL)
+
+
+//********************************************************
+/*! @enum                                                */
+//********************************************************
+// なし
+
+
+//********************************************************
+/*! @struct                                              */
+//********************************************************
+// 1 本の出力の状態
+typedef struct {
+    SAppTlmParam_t      param;                  // 設定
+    unsigned int        batch;                  // まとめて出力する行数
+    EHalSensorMcp3208_t which[MCP3208_CH_NUM];  // 出力する ch のリスト
+    unsigned int        num;                    // 出力する ch の数
+    unsigned int        len;                    // バッファ内の Byte 数
+    unsigned int        lines;                  // バッファ内の行数
+    char                buf[APP_TLM_BATCH_MAX * TLM_LINE_MAX];
+} SAppTlmStream_t;
+
+
+//********************************************************
+/* モジュールグローバル変数                              */
+//********************************************************
+static SAppTlmStream_t          g_param;        // AppTlm_Run() の出力
+static volatile sig_atomic_t    g_stop = 0;     // EN_TRUE = 停止要求 ( シグナル )
+static int                      g_quit = 0;     // EN_TRUE = 全スレッドの停止要求 ( AppTlm_StopAll() )
+static unsigned int             g_threads = 0;  // 出力中のスレッド数
+static pthread_mutex_t          g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t           g_cond = PTHREAD_COND_INITIALIZER;
+
+// EHalMotorState_t の名前
+static const char* const        g_state[] = { "standby", "brake", "ccw", "cw", "stop" };
+
+
+//********************************************************
+/* 関数プロトタイプ宣言                                  */
+//********************************************************
+static void         Handler( int sig );
+static const char*  StateName( EHalMotorState_t status );
+static void         Format( SAppTlmStream_t* st, unsigned long long seq );
+static EHalBool_t   Flush( SAppTlmStream_t* st );
+static EHalBool_t   Setup( SAppTlmStream_t* st, const SAppTlmParam_t* param );
+static EHalBool_t   Loop( SAppTlmStream_t* st );
+static void*        Worker( void* arg );
+
+
+
+
+/**************************************************************************//*!
+ * @brief     SIGINT / SIGTERM のハンドラ。
+ * @attention なし。
+ * @note      SA_RESTART を付けないため、clock_nanosleep() は EINTR で戻る。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Handler(
+    int             sig     ///< [in] シグナル番号
+){
+    g_stop = EN_TRUE;
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     モータの状態の名前を返す。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    名前
+ *************************************************************************** */
+static const char*
+StateName(
+    EHalMotorState_t    status  ///< [in] モータの状態
+){
+    if( (unsigned int)status >= sizeof(g_state) / sizeof(g_state[0]) )
+    {
+        return "unknown";
+    }
+    return g_state[status];
+}
+
+
+/**************************************************************************//*!
+ * @brief     1 サンプルを読み出し、1 行の JSON をバッファに追加する。
+ * @attention バッファには TLM_LINE_MAX 以上の空きがあること。
+ * @note      AD 値の読み出しに失敗した ch は null を出力する。
+ * @sa        Flush()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Format(
+    SAppTlmStream_t*    st,     ///< [in] 出力
+    unsigned long long  seq     ///< [in] 通し番号
+){
+    unsigned int        data[MCP3208_CH_NUM];
+    SHalMotorState_t    dc;
+    SHalMotorState_t    dc2;
+    SHalMotorState_t    sv;
+    struct timespec     ts;
+    EHalBool_t          valid = EN_FALSE;
+    char*               p = &st->buf[st->len];
+    char*               end = p + TLM_LINE_MAX;
+    unsigned int        i = 0;
+
+    clock_gettime( CLOCK_REALTIME, &ts );
+    valid = HalCmnSpiMcp3208_GetMulti( st->which, data, st->num );
+
+    p += snprintf( p, end - p, "{\"seq\":%llu,\"ts\":%ld.%06ld,\"adc\":{",
+                   seq, (long)ts.tv_sec, ts.tv_nsec / 1000 );
+
+    for( i = 0; i < st->num; i++ )
+    {
+        if( valid == EN_TRUE )
+        {
+            p += snprintf( p, end - p, "%s\"%d\":%u", ( i == 0 ) ? "" : ",", st->which[i], data[i] );
+        } else
+        {
+            p += snprintf( p, end - p, "%s\"%d\":null", ( i == 0 ) ? "" : ",", st->which[i] );
+        }
+    }
+
+    if( st->param.motor == EN_TRUE )
+    {
+        HalMotorDC_GetState( &dc );
+        HalMotorDC2_GetState( &dc2 );
+        HalMotorSV_GetState( &sv );
+        p += snprintf( p, end - p, "},\"dc\":[\"%s\",%.1f],\"dc2\":[\"%s\",%.1f],\"sv\":[\"%s\",%.1f],\"st\":%ld}\n",
+                       StateName( dc.status ),  dc.rate,
+                       StateName( dc2.status ), dc2.rate,
+                       StateName( sv.status ),  sv.rate,
+                       HalMotorST_GetPosition() );
+    } else
+    {
+        p += snprintf( p, end - p, "}}\n" );
+    }
+
+    st->len = p - st->buf;
+    st->lines++;
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     バッファの内容を 1 回の write() で出力する。
+ * @attention なし。
+ * @note      一部しか書き込めなかった場合は、残りを書き込む。
+ * @sa        Format()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗 ( 出力先が閉じられた場合は errno = EPIPE )
+ *************************************************************************** */
+static EHalBool_t
+Flush(
+    SAppTlmStream_t*    st      ///< [in] 出力
+){
+    EHalBool_t          ret = EN_FALSE;
+    unsigned int        pos = 0;
+    ssize_t             len = 0;
+
+    while( pos < st->len )
+    {
+        len = write( st->param.fd, &st->buf[pos], st->len - pos );
+        if( len < 0 )
+        {
+            if( errno == EINTR )
+            {
+                continue;
+            }
+            if( errno != EPIPE )
+            {
+                DBG_PRINT_ERROR( "write() error. : %s \n\r", strerror( errno ) );
+            }
+            return ret;
+        }
+        pos += len;
+    }
+
+    st->len   = 0;
+    st->lines = 0;
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     設定を確認して出力の状態を初期化する。
+ * @attention なし。
+ * @note      AD 変換に使う SPI をここで初期化する。
+ * @sa        Loop()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Setup(
+    SAppTlmStream_t*        st,     ///< [out] 出力
+    const SAppTlmParam_t*   param   ///< [in]  設定
+){
+    unsigned int            i = 0;
+
+    DBG_PRINT_TRACE( "rate = %u, mask = 0x%X \n\r", param->rate, param->mask );
+
+    if( param->rate == 0 || param->rate > APP_TLM_RATE_MAX || param->batch > APP_TLM_BATCH_MAX
+     || 0 == ( param->mask & ( ( 1U << MCP3208_CH_NUM ) - 1 ) ) )
+    {
+        DBG_PRINT_ERROR( "invalid argument error. \n\r" );
+        return EN_FALSE;
+    }
+
+    if( EN_FALSE == Sys_Require( EN_SYS_SPI ) )
+    {
+        return EN_FALSE;
+    }
+
+    memset( st, 0, sizeof(*st) );
+    st->param = *param;
+    for( i = 0; i < MCP3208_CH_NUM; i++ )
+    {
+        if( param->mask & ( 1U << i ) )
+        {
+            st->which[st->num++] = (EHalSensorMcp3208_t)i;
+        }
+    }
+
+    // 既定では約 100 msec 分をまとめて出力する
+    st->batch = param->batch;
+    if( st->batch == 0 )
+    {
+        st->batch = ( param->rate >= 10 ) ? param->rate / 10 : 1;
+        if( st->batch > APP_TLM_BATCH_MAX )
+        {
+            st->batch = APP_TLM_BATCH_MAX;
+        }
+    }
+
+    return EN_TRUE;
+}
+
+
+/**************************************************************************//*!
+ * @brief     一定周期で出力する。
+ * @attention なし。
+ * @note      count 行を出力するか、停止要求を受けるか、出力先が閉じられるまで戻らない。
+ *            出力先が閉じられた ( 読み出し側が終了した ) 場合は、正常な終了とする。
+ *            周期は CLOCK_MONOTONIC の絶対時刻で保つ。処理が周期に間に合わなかった場合は、次の周期から再開する。
+ *            停止要求は周期ごとに確認する ( 最大 1 周期遅れる )。
+ * @sa        Setup()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Loop(
+    SAppTlmStream_t*    st      ///< [in] 出力
+){
+    EHalBool_t          ret = EN_TRUE;
+    struct timespec     ts;
+    unsigned long long  period = NSEC_PER_SEC / st->param.rate;
+    unsigned long long  next = HalTime_GetMonotonicNs();
+    unsigned long long  now = 0;
+    unsigned long long  seq = 0;
+    unsigned long       overrun = 0;
+
+    while( g_stop == EN_FALSE && EN_FALSE == __atomic_load_n( &g_quit, __ATOMIC_ACQUIRE )
+        && ( st->param.count == 0 || seq < st->param.count ) )
+    {
+        Format( st, seq++ );
+        if( st->lines >= st->batch && EN_FALSE == Flush( st ) )
+        {
+            ret = ( errno == EPIPE ) ? EN_TRUE : EN_FALSE;
+            st->lines = 0;
+            break;
+        }
+
+        next += period;
+        now = HalTime_GetMonotonicNs();
+        if( next < now )
+        {
+            overrun++;
+            next = now;
+        }
+
+        ts.tv_sec  = next / NSEC_PER_SEC;
+        ts.tv_nsec = next % NSEC_PER_SEC;
+        while( g_stop == EN_FALSE && 0 != clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL ) )
+        {
+            ;   // シグナルで中断された場合は、停止要求でなければ再度待つ
+        }
+    }
+
+    if( st->lines > 0 && EN_FALSE == Flush( st ) && errno != EPIPE )
+    {
+        ret = EN_FALSE;
+    }
+
+    if( overrun > 0 )
+    {
+        DBG_PRINT_ERROR( "overrun = %lu \n\r", overrun );
+    }
+
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     AppTlm_Start() で起動した出力のスレッド。
+ * @attention なし。
+ * @note      終了時に出力先を閉じ、出力の状態を解放する。
+ * @sa        AppTlm_Start()
+ * @author    Ryoji Morita
+ * @return    NULL
+ *************************************************************************** */
+static void*
+Worker(
+    void*               arg     ///< [in] 出力
+){
+    SAppTlmStream_t*    st = (SAppTlmStream_t*)arg;
+
+    Loop( st );
+    close( st->param.fd );
+    free( st );
+
+    pthread_mutex_lock( &g_lock );
+    g_threads--;
+    pthread_cond_broadcast( &g_cond );
+    pthread_mutex_unlock( &g_lock );
+    return NULL;
+}
+
+
+/**************************************************************************//*!
+ * @brief     テレメトリを出力する。
+ * @attention なし。
+ * @note      count 行を出力するか、SIGINT / SIGTERM を受けるか、出力先が閉じられるまで戻らない。
+ * @sa        AppTlm_Start()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+AppTlm_Run(
+    const SAppTlmParam_t*   param   ///< [in] 設定
+){
+    EHalBool_t          ret = EN_FALSE;
+    struct sigaction    sa;
+    struct sigaction    old_int;
+    struct sigaction    old_term;
+    struct sigaction    old_pipe;
+
+    if( EN_FALSE == Setup( &g_param, param ) )
+    {
+        return ret;
+    }
+
+    memset( &sa, 0, sizeof(sa) );
+    sigemptyset( &sa.sa_mask );
+    sa.sa_handler = Handler;
+    sigaction( SIGINT,  &sa, &old_int );
+    sigaction( SIGTERM, &sa, &old_term );
+    sa.sa_handler = SIG_IGN;
+    sigaction( SIGPIPE, &sa, &old_pipe );
+
+    g_stop = EN_FALSE;
+    ret = Loop( &g_param );
+
+    sigaction( SIGINT,  &old_int,  NULL );
+    sigaction( SIGTERM, &old_term, NULL );
+    sigaction( SIGPIPE, &old_pipe, NULL );
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     テレメトリの出力をスレッドで始める。
+ * @attention SIGPIPE は呼び出し側で無視しておくこと。
+ * @note      すぐに戻る。成功した場合、出力先 ( param->fd ) はスレッドが終了時に閉じる。
+ *            失敗した場合、出力先は呼び出し側が閉じる。
+ *            同時に APP_TLM_STREAM_MAX 本まで出力できる。
+ * @sa        AppTlm_StopAll()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+AppTlm_Start(
+    const SAppTlmParam_t*   param   ///< [in] 設定
+){
+    EHalBool_t          ret = EN_FALSE;
+    SAppTlmStream_t*    st = NULL;
+    pthread_attr_t      attr;
+    pthread_t           thread;
+
+    st = (SAppTlmStream_t*)malloc( sizeof(*st) );
+    if( st == NULL || EN_FALSE == Setup( st, param ) )
+    {
+        free( st );
+        return ret;
+    }
+
+    pthread_attr_init( &attr );
+    pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+
+    pthread_mutex_lock( &g_lock );
+    if( g_threads >= APP_TLM_STREAM_MAX )
+    {
+        DBG_PRINT_ERROR( "too many streams. \n\r" );
+    } else if( 0 != pthread_create( &thread, &attr, Worker, st ) )
+    {
+        DBG_PRINT_ERROR( "pthread_create() error. \n\r" );
+    } else
+    {
+        g_threads++;
+        st  = NULL;     // スレッドが解放する
+        ret = EN_TRUE;
+    }
+    pthread_mutex_unlock( &g_lock );
+
+    pthread_attr_destroy( &attr );
+    free( st );
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     AppTlm_Start() で始めた全ての出力を止める。
+ * @attention なし。
+ * @note      全てのスレッドが終了するまで待つ ( 最大で最も遅い出力の 1 周期 )。
+ * @sa        AppTlm_Start()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+AppTlm_StopAll(
+    void
+){
+    pthread_mutex_lock( &g_lock );
+    __atomic_store_n( &g_quit, EN_TRUE, __ATOMIC_RELEASE );
+    while( g_threads > 0 )
+    {
+        pthread_cond_wait( &g_cond, &g_lock );
+    }
+    __atomic_store_n( &g_quit, EN_FALSE, __ATOMIC_RELEASE );
+    pthread_mutex_unlock( &g_lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     "周期[Hz][,ch,ch...]" の形式の文字列から設定を作る。
+ * @attention str は strtok_r() で書き換える。
+ * @note      str = NULL / "" / ",ch..." の場合、周期は 10Hz。ch を省略した場合は全 ch。
+ *            count / batch は 0、motor は EN_FALSE、fd は標準出力とする。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗 ( 書式の誤り )
+ *************************************************************************** */
+EHalBool_t
+AppTlm_Parse(
+    char*               str,    ///< [in]  文字列
+    SAppTlmParam_t*     param   ///< [out] 設定
+){
+    char*               tok = NULL;
+    char*               save = NULL;
+    char*               end = NULL;
+    unsigned long       ch = 0;
+
+    memset( param, 0, sizeof(*param) );
+    param->rate  = 10;
+    param->mask  = ( 1U << MCP3208_CH_NUM ) - 1;
+    param->count = 0;
+    param->batch = 0;
+    param->motor = EN_FALSE;
+    param->fd    = STDOUT_FILENO;
+
+    if( str == NULL )
+    {
+        return EN_TRUE;
+    }
+
+    tok = strtok_r( str, ",", &save );
+    if( tok != NULL && str[0] != ',' )
+    {
+        param->rate = strtoul( tok, &end, 10 );
+        if( *end != '\0' )
+        {
+            DBG_PRINT_ERROR( "invalid argument error. : %s \n\r", tok );
+            return EN_FALSE;
+        }
+        tok = strtok_r( NULL, ",", &save );
+    }
+
+    if( tok != NULL )
+    {
+        param->mask = 0;
+    }
+    for( ; tok != NULL; tok = strtok_r( NULL, ",", &save ) )
+    {
+        ch = strtoul( tok, &end, 10 );
+        if( *end != '\0' || ch >= MCP3208_CH_NUM )
+        {
+            DBG_PRINT_ERROR( "invalid argument error. : %s \n\r", tok );
+            return EN_FALSE;
+        }
+        param->mask |= ( 1U << ch );
+    }
+
+    return EN_TRUE;
+}
+
+
+#ifdef __cplusplus
+    }
+#endif
+
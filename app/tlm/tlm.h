@@ -0,0 +1,65 @@
+/**************************************************************************//*!
+ *  @file           tlm.h
+ *  @brief          [APP] 外部公開 API を宣言したヘッダファイル。
+ *  @author         Ryoji Morita
+ *  @attention      none.
+ *                  関数命名規則
+ *                      通常関数 : App[モジュール名]_処理名()
+ *  @sa             none.
+ *  @bug            none.
+ *  @warning        none.
+ *  @version        1.00
+ *  @last updated   2019.01.17
+ *************************************************************************** */
+
+// 多重コンパイル抑止
+#ifndef _APP_TLM_H_
+#define _APP_TLM_H_
+
+
+//********************************************************
+/* include                                               */
+//********************************************************
+#include "../../hal/hal.h"
+
+
+//********************************************************
+/*! @def                                                 */
+//********************************************************
+#define APP_TLM_RATE_MAX    (1000)  ///< @def : 出力周期の上限 ( 単位: Hz )
+#define APP_TLM_BATCH_MAX   (64)    ///< @def : 1 回の write() でまとめて出力する最大行数
+#define APP_TLM_STREAM_MAX  (4)     ///< @def : AppTlm_Start() で同時に出力できる数
+
+
+//********************************************************
+/*! @enum                                                */
+//********************************************************
+// なし
+
+
+//********************************************************
+/*! @struct                                              */
+//********************************************************
+// テレメトリの設定に使用する型
+typedef struct tagSAppTlmParam
+{
+    unsigned int        rate;       ///< @var : 出力周期 ( 単位: Hz, 1 ～ APP_TLM_RATE_MAX )
+    unsigned int        mask;       ///< @var : 出力する AD の ch のビットマスク ( bit n = ch n )
+    unsigned long       count;      ///< @var : 出力する行数 ( 0 = 停止されるまで )
+    unsigned int        batch;      ///< @var : まとめて出力する行数 ( 0 = 約 100 msec 分 )
+    EHalBool_t          motor;      ///< @var : モータの状態を出力するか否か ( モータを動かすプロセス内でだけ意味がある )
+    int                 fd;         ///< @var : 出力先のファイルデスクリプタ
+} SAppTlmParam_t;
+
+
+//********************************************************
+/* 関数プロトタイプ宣言                                  */
+//********************************************************
+EHalBool_t  AppTlm_Run( const SAppTlmParam_t* param );
+EHalBool_t  AppTlm_Start( const SAppTlmParam_t* param );
+void        AppTlm_StopAll( void );
+EHalBool_t  AppTlm_Parse( char* str, SAppTlmParam_t* param );
+
+
+#endif /* _APP_TLM_H_ */
+
@@ -67,6 +67,24 @@ typedef enum tagEHalLcdMode
 } EHalLcdMode_t;
 
 
+// ステッピング・モータの加減速プロファイルに使用する型
+typedef enum tagEHalMotorSTProfile
+{
+    EN_ST_PROFILE_CONST = 0,    ///< @var : 加減速なし (= 初期値 )
+    EN_ST_PROFILE_TRAPEZOID,    ///< @var : 台形加減速 ( 加速度一定 )
+    EN_ST_PROFILE_SCURVE        ///< @var : S 字加減速 ( 加加速度一定 )
+} EHalMotorSTProfile_t;
+
+
+// ステッピング・モータの励磁方式に使用する型
+typedef enum tagEHalMotorSTStep
+{
+    EN_ST_STEP_WAVE = 0,        ///< @var : 1 相励磁 (= 初期値 )
+    EN_ST_STEP_TWO_PHASE,       ///< @var : 2 相励磁
+    EN_ST_STEP_HALF             ///< @var : 1-2 相励磁 ( ハーフ・ステップ )
+} EHalMotorSTStep_t;
+
+
 //*************************************
 // ステータスの型
 //*************************************
@@ -101,8 +119,8 @@ typedef struct tagSHalTime
 {
     unsigned long       wait;   ///< @var : wait カウンタ  ( 単位:  usec ) :   1 min で自動 0 クリア
 
-    unsigned int        usec;   ///< @var : 内部時計       ( 単位:  usec ) : 100 usec  ごとに加算
-    unsigned int        msec;   ///< @var : 内部時計       ( 単位:  msec ) :   1 msec  ごとに加算
+    unsigned int        usec;   ///< @var : 内部時計       ( 単位:  usec ) :   1 usec  ごとに加算 ( 0 ～ 999 )
+    unsigned int        msec;   ///< @var : 内部時計       ( 単位:  msec ) :   1 msec  ごとに加算 ( 0 ～ 999 )
     unsigned char       sec;    ///< @var : 内部時計       ( 単位:   sec ) :   1 sec   ごとに加算
     unsigned char       min;    ///< @var : 内部時計       ( 単位:   min ) :   1 min   ごとに加算
     unsigned char       hour;   ///< @var : 内部時計       ( 単位:     h ) :   1 h     ごとに加算
@@ -112,6 +130,44 @@ typedef struct tagSHalTime
 } SHalTime_t;
 
 
+// PWM の設定の取得に使用する型
+typedef struct tagSHalPwmInfo
+{
+    double              freq;       ///< @var : PWM 周波数 ( 単位: Hz )
+    unsigned int        clock;      ///< @var : PWM クロックの分周比
+    unsigned int        range;      ///< @var : PWM の 1 周期のカウント数
+    double              resolution; ///< @var : デューティ比の分解能 ( 単位: % )
+} SHalPwmInfo_t;
+
+
+// モータの状態の取得に使用する型
+typedef struct tagSHalMotorState
+{
+    EHalMotorState_t    status;     ///< @var : モータの状態
+    double              rate;       ///< @var : デューティ比 ( 単位: % )
+} SHalMotorState_t;
+
+
+// プッシュ・スイッチのイベントに使用する型
+typedef struct tagSHalPushSwEvent
+{
+    EHalPushSw_t        which;  ///< @var : イベントが発生した SW
+    EHalBool_t          press;  ///< @var : EN_TRUE = 押された, EN_FALSE = 離された
+    unsigned long long  time;   ///< @var : 入力が変化した時刻 ( CLOCK_MONOTONIC, 単位: nsec )
+} SHalPushSwEvent_t;
+
+
+// ステッピング・モータの加減速プロファイルの設定に使用する型
+typedef struct tagSHalMotorSTProfile
+{
+    EHalMotorSTProfile_t    type;   ///< @var : プロファイルの種類
+    double                  vmin;   ///< @var : 開始 / 停止速度   ( 単位: step/s   )
+    double                  vmax;   ///< @var : 最高速度          ( 単位: step/s   )
+    double                  accel;  ///< @var : 最大加速度        ( 単位: step/s^2 ) : EN_ST_PROFILE_CONST 以外で使用
+    double                  jerk;   ///< @var : 加加速度          ( 単位: step/s^3 ) : EN_ST_PROFILE_SCURVE で使用
+} SHalMotorSTProfile_t;
+
+
 //********************************************************
 /* 関数プロトタイプ宣言                                  */
 //********************************************************
@@ -119,11 +175,14 @@ typedef struct tagSHalTime
 EHalBool_t      HalI2cLcd_Init( void );
 void            HalI2cLcd_Fini( void );
 EHalBool_t      HalI2cLcd_Write( EHalLcdMode_t rs, unsigned char code );
+EHalBool_t      HalI2cLcd_WriteData( const unsigned char* data, unsigned int size );
+EHalBool_t      HalI2cLcd_WriteCmdData( int cmd, const unsigned char* data, unsigned int size );
 
 // I2C PCA9685 API
 EHalBool_t      HalI2cPca9685_Init( void );
 void            HalI2cPca9685_Fini( void );
 EHalBool_t      HalI2cPca9685_SetPwmDuty( unsigned char ch, EHalMotorState_t status, double rate );
+EHalBool_t      HalI2cPca9685_SetPwmDutyMulti( unsigned char ch, unsigned char num, EHalMotorState_t status, const double* rate );
 
 // LED API
 EHalBool_t      HalLed_Init( void );
@@ -133,27 +192,46 @@ void            HalLed_Set( unsigned char value );
 // DC モータ API
 EHalBool_t      HalMotorDC_Init( void );
 void            HalMotorDC_Fini( void );
-void            HalMotorDC_SetPwmDuty( EHalMotorState_t status, int rate );
+EHalBool_t      HalMotorDC_SetPwmDuty( EHalMotorState_t status, int rate );
+EHalBool_t      HalMotorDC_SetPwmDutyF( EHalMotorState_t status, double rate );
+EHalBool_t      HalMotorDC_SetPwmFreq( double freq );
+void            HalMotorDC_GetPwmInfo( SHalPwmInfo_t* info );
+EHalBool_t      HalMotorDC_IsPwmFree( unsigned int clock, unsigned int range );
+void            HalMotorDC_GetState( SHalMotorState_t* state );
 
 // DC モータ2 API
 EHalBool_t      HalMotorDC2_Init( void );
 void            HalMotorDC2_Fini( void );
-void            HalMotorDC2_SetPwmDuty( EHalMotorState_t status, int rate );
+EHalBool_t      HalMotorDC2_SetPwmDuty( EHalMotorState_t status, int rate );
+EHalBool_t      HalMotorDC2_SetPwmDutyF( EHalMotorState_t status, double rate );
+void            HalMotorDC2_GetState( SHalMotorState_t* state );
 
 // ステッピングモータ API
 EHalBool_t      HalMotorST_Init( void );
 void            HalMotorST_Fini( void );
 void            HalMotorST_SetPosition( EHalMotorState_t status, int deg );
+unsigned int    HalMotorST_Move( EHalMotorState_t status, int deg );
+unsigned int    HalMotorST_MoveTo( long mdeg );
+long            HalMotorST_GetPosition( void );
+EHalBool_t      HalMotorST_SetOrigin( void );
+EHalBool_t      HalMotorST_IsDone( unsigned int id );
+void            HalMotorST_Wait( unsigned int id );
+void            HalMotorST_Stop( void );
+EHalBool_t      HalMotorST_SetProfile( const SHalMotorSTProfile_t* profile );
+EHalBool_t      HalMotorST_SetStepMode( EHalMotorSTStep_t mode );
 
 // サーボモータ API
 EHalBool_t      HalMotorSV_Init( void );
 void            HalMotorSV_Fini( void );
-void            HalMotorSV_SetPwmDuty( EHalMotorState_t status, int rate );
+EHalBool_t      HalMotorSV_SetPwmDuty( EHalMotorState_t status, int rate );
+void            HalMotorSV_GetState( SHalMotorState_t* state );
 
 // プッシュ・スイッチ API
 EHalBool_t      HalPushSw_Init( void );
 void            HalPushSw_Fini( void );
 EHalBool_t      HalPushSw_Get( EHalPushSw_t );
+EHalBool_t      HalPushSw_PollEvent( SHalPushSwEvent_t* event, int timeout );
+int             HalPushSw_GetFd( void );
 
 // SENSOR (ADC) ポテンショメータ API
 EHalBool_t      HalSensorPm_Init( void );
@@ -164,6 +242,9 @@ SHalSensor_t*   HalSensorPm_Get( void );
 EHalBool_t      HalTime_Init( void );
 SHalTime_t*     HalTime_GetLocaltime( void );
 SHalTime_t*     HalTime_GetUTC( void );
+EHalBool_t      HalTime_GetLocaltimeR( SHalTime_t* date );
+EHalBool_t      HalTime_GetUTCR( SHalTime_t* date );
+unsigned long long  HalTime_GetMonotonicNs( void );
 
 
 #endif /* _HAL_H_ */
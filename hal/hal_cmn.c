@@ -18,6 +18,7 @@
 /* include                                               */
 //********************************************************
 #include "hal_cmn.h"
+#include "hal_cmn_backend.h"
 
 
 //#define DBG_PRINT
@@ -46,7 +47,8 @@
 //********************************************************
 /* モジュールグローバル変数                              */
 //********************************************************
-// なし
+static EHalBackend_t            g_type = EN_BACKEND_HW;
+static const SHalCmnBackend_t*  g_backend = &g_halCmnBackendHw;
 
 
 //********************************************************
@@ -91,6 +93,69 @@ HalCmn_UpdateSenData(
 }
 
 
+/**************************************************************************//*!
+ * @brief     SPI / I2C / GPIO / PWM のバス・バックエンドを選択する。
+ * @attention HalCmnGpio_Init() / HalCmnI2c_Init() / HalCmnSpi_Init() より前に呼ぶこと。
+ * @note      EN_BACKEND_SIM を選択すると、H/W を接続せずに全ての HAL API が動作する。
+ * @sa        HalCmn_GetBackend()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+HalCmn_SetBackend(
+    EHalBackend_t   which   ///< [in] バックエンドの種類
+){
+    EHalBool_t      ret = EN_FALSE;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    switch( which )
+    {
+    case EN_BACKEND_HW  : g_backend = &g_halCmnBackendHw;  break;
+    case EN_BACKEND_SIM : g_backend = &g_halCmnBackendSim; break;
+    default:
+        DBG_PRINT_ERROR( "invalid backend. : %d \n\r", which );
+        return ret;
+    }
+
+    g_type = which;
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     選択中のバス・バックエンドの種類を返す。
+ * @attention なし。
+ * @note      なし。
+ * @sa        HalCmn_SetBackend()
+ * @author    Ryoji Morita
+ * @return    バックエンドの種類
+ *************************************************************************** */
+EHalBackend_t
+HalCmn_GetBackendType(
+    void  ///< [in] ナシ
+){
+    return g_type;
+}
+
+
+/**************************************************************************//*!
+ * @brief     選択中のバス・バックエンドの関数テーブルを返す。
+ * @attention HAL 内部でのみ使用する。
+ * @note      なし。
+ * @sa        HalCmn_SetBackend()
+ * @author    Ryoji Morita
+ * @return    関数テーブル
+ *************************************************************************** */
+const SHalCmnBackend_t*
+HalCmn_GetBackend(
+    void  ///< [in] ナシ
+){
+    return g_backend;
+}
+
+
 #ifdef __cplusplus
     }
 #endif
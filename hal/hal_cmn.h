@@ -33,6 +33,8 @@
 #define I2C_SLAVE_PCA9685       (0x40)
 
 #define MCP3208_MAX_VALE        (0x0F60)
+#define MCP3208_CH_NUM          (8)         ///< @def : MCP3208 の ch 数
+#define MCP3208_STREAM_NUM      (256)       ///< @def : ストリーミング用リングバッファのサンプル数 ( 2 のべき乗 )
 
 
 //********************************************************
@@ -63,6 +65,34 @@ typedef enum tagEHalState
 } EHalState_t;
 
 
+//*************************************
+// バックエンドの選択に使用する型
+//*************************************
+typedef enum tagEHalBackend
+{
+    EN_BACKEND_HW = 0,      ///< @var : 実機 (= 初期値 )
+    EN_BACKEND_SIM          ///< @var : シミュレータ ( H/W なしで動作する )
+} EHalBackend_t;
+
+
+//*************************************
+// GPIO / PWM の設定に使用する型
+//*************************************
+typedef enum tagEHalGpioMode
+{
+    EN_GPIO_INPUT = 0,      ///< @var : 入力
+    EN_GPIO_OUTPUT,         ///< @var : 出力
+    EN_GPIO_PWM_OUTPUT      ///< @var : PWM 出力
+} EHalGpioMode_t;
+
+
+typedef enum tagEHalPwmMode
+{
+    EN_PWM_MODE_MS = 0,     ///< @var : Mark : Space モード
+    EN_PWM_MODE_BAL         ///< @var : Balanced モード
+} EHalPwmMode_t;
+
+
 //*************************************
 // デバイスを区別するための型
 //*************************************
@@ -96,19 +126,67 @@ typedef struct tagSHalSensor
 } SHalSensor_t;
 
 
+// MCP3208 のストリーミング・サンプルに使用する型
+typedef struct tagSHalMcp3208Sample
+{
+    unsigned long long  time;                   ///< @var : サンプリング時刻 ( CLOCK_MONOTONIC, 単位: nsec )
+    unsigned int        data[MCP3208_CH_NUM];   ///< @var : ch ごとの AD 値 ( 対象外の ch は 0 )
+} SHalMcp3208Sample_t;
+
+
+// I2C デバイスのハンドルに使用する型
+typedef struct tagSHalI2cDev
+{
+    unsigned char       address;    ///< @var : スレーブアドレス ( 7bit )
+} SHalI2cDev_t;
+
+
+// シミュレータのバスアクセス回数に使用する型
+typedef struct tagSHalSimStats
+{
+    unsigned long       spi_msg;    ///< @var : SPI メッセージ ( ioctl ) の回数
+    unsigned long       spi_xfer;   ///< @var : SPI transfer の回数
+    unsigned long       i2c_slave;  ///< @var : I2C スレーブ切り替え ( ioctl ) の回数
+    unsigned long       i2c_write;  ///< @var : I2C 書き込み ( write ) の回数
+    unsigned long       i2c_read;   ///< @var : I2C 読み出し ( read ) の回数
+    unsigned long       i2c_byte;   ///< @var : I2C で転送した Byte 数
+    unsigned long       i2c_xfer;   ///< @var : I2C 複合転送 ( ioctl( I2C_RDWR ) ) の回数
+    unsigned long       i2c_msg;    ///< @var : I2C 複合転送に含まれるメッセージの数
+    unsigned long       gpio_mode;  ///< @var : GPIO 端子の機能設定の回数
+    unsigned long       gpio_write; ///< @var : GPIO 出力の回数
+    unsigned long       pwm_cfg;    ///< @var : PWM モード/クロック/レンジ設定の回数
+    unsigned long       pwm_write;  ///< @var : PWM デューティ設定の回数
+} SHalSimStats_t;
+
+
 //********************************************************
 /* 関数プロトタイプ宣言                                  */
 //********************************************************
 void            HalCmn_UpdateSenData( SHalSensor_t* curData, double newData );
+EHalBool_t      HalCmn_SetBackend( EHalBackend_t which );
+EHalBackend_t   HalCmn_GetBackendType( void );
 
 EHalBool_t      HalCmnGpio_Init( void );
 void            HalCmnGpio_Fini( void );
+void            HalCmnGpio_PinMode( int pin, EHalGpioMode_t mode );
+void            HalCmnGpio_Write( int pin, EHalOputputLevel_t level );
+void            HalCmnGpio_WriteMask( unsigned int mask, unsigned int value );
+int             HalCmnGpio_Read( int pin );
+
+void            HalCmnPwm_SetMode( EHalPwmMode_t mode );
+void            HalCmnPwm_SetClock( unsigned int clock );
+void            HalCmnPwm_SetRange( unsigned int range );
+void            HalCmnPwm_Write( int pin, unsigned int value );
 
 EHalBool_t      HalCmnI2c_Init( void );
 void            HalCmnI2c_Fini( void );
 EHalBool_t      HalCmnI2c_SetSlave( unsigned char address );
 EHalBool_t      HalCmnI2c_Write( unsigned char* data, unsigned int size );
 EHalBool_t      HalCmnI2c_Read( unsigned char* data, unsigned int size );
+void            HalCmnI2c_DevInit( SHalI2cDev_t* dev, unsigned char address );
+EHalBool_t      HalCmnI2c_DevWrite( const SHalI2cDev_t* dev, const unsigned char* data, unsigned int size );
+EHalBool_t      HalCmnI2c_DevRead( const SHalI2cDev_t* dev, unsigned char* data, unsigned int size );
+EHalBool_t      HalCmnI2c_DevReadReg( const SHalI2cDev_t* dev, unsigned char reg, unsigned char* data, unsigned int size );
 
 EHalBool_t      HalCmnSpi_Init( void );
 void            HalCmnSpi_Fini( void );
@@ -116,8 +194,25 @@ EHalBool_t      HalCmnSpi_Send( unsigned char data );
 EHalBool_t      HalCmnSpi_SendN( unsigned char* data, int );
 EHalBool_t      HalCmnSpi_SendBuffer( unsigned char* data, int size );
 EHalBool_t      HalCmnSpi_RecvN( unsigned char*  send, unsigned char*  recv, unsigned int size );
+EHalBool_t      HalCmnSpi_RecvMulti( unsigned char* send, unsigned char* recv, unsigned int size, unsigned int num );
 
 unsigned int    HalCmnSpiMcp3208_Get( EHalSensorMcp3208_t which );
+EHalBool_t      HalCmnSpiMcp3208_GetMulti( const EHalSensorMcp3208_t* which, unsigned int* data, unsigned int num );
+
+EHalBool_t          HalCmnSpiMcp3208_StreamStart( const EHalSensorMcp3208_t* which, unsigned int num, unsigned int period );
+void                HalCmnSpiMcp3208_StreamStop( void );
+unsigned long long  HalCmnSpiMcp3208_StreamHead( void );
+unsigned int        HalCmnSpiMcp3208_StreamRead( unsigned long long* pos, SHalMcp3208Sample_t* sample, unsigned int max );
+EHalBool_t          HalCmnSpiMcp3208_StreamLatest( EHalSensorMcp3208_t which, unsigned int* data );
+
+void            HalCmnSim_SetAdc( EHalSensorMcp3208_t which, unsigned int value );
+void            HalCmnSim_SetPin( int pin, int level );
+int             HalCmnSim_GetPin( int pin );
+unsigned int    HalCmnSim_GetPwm( int pin );
+unsigned char   HalCmnSim_GetPca9685Reg( unsigned char reg );
+void            HalCmnSim_GetLcdLine( int y, char* str );
+void            HalCmnSim_GetStats( SHalSimStats_t* stats );
+void            HalCmnSim_ClearStats( void );
 
 
 #endif /* _HAL_CMN_H_ */
@@ -0,0 +1,90 @@
+/**************************************************************************//*!
+ *  @file           hal_cmn_backend.h
+ *  @brief          [HAL] バス・バックエンド ( SPI / I2C / GPIO / PWM のプリミティブ ) を宣言したヘッダファイル。
+ *  @author         Ryoji Morita
+ *  @attention      HAL 内部でのみ使用する。
+ *                  関数命名規則
+ *                      通常         : Hal[デバイス名]_処理名()
+ *                      割込ハンドラ : Hal[デバイス名]_IH_処理名()
+ *  @sa             none.
+ *  @bug            none.
+ *  @warning        none.
+ *  @version        1.00
+ *  @last updated   2016.06.05
+ *************************************************************************** */
+
+// 多重コンパイル抑止
+#ifndef _HAL_CMN_BACKEND_H_
+#define _HAL_CMN_BACKEND_H_
+
+
+//********************************************************
+/* include                                               */
+//********************************************************
+#include <linux/spi/spidev.h>
+#include <linux/i2c.h>
+
+#include "hal_cmn.h"
+
+
+//********************************************************
+/*! @def                                                 */
+//********************************************************
+// なし
+
+
+//********************************************************
+/*! @enum                                                */
+//********************************************************
+// なし
+
+
+//********************************************************
+/*! @struct                                              */
+//********************************************************
+// バス・バックエンドの関数テーブル
+typedef struct tagSHalCmnBackend
+{
+    const char*     name;                                                                       ///< @var : バックエンド名
+
+    // SPI
+    int             (*SpiOpen)( void );                                                         ///< @var : オープンして設定する。戻り値 = fd ( 失敗時 -1 )
+    void            (*SpiClose)( int fd );                                                      ///< @var : クローズする
+    int             (*SpiTransfer)( int fd, struct spi_ioc_transfer* tr, unsigned int num );    ///< @var : SPI_IOC_MESSAGE(num) 相当。失敗時 < 0
+
+    // I2C
+    int             (*I2cOpen)( void );                                                         ///< @var : オープンする。戻り値 = fd ( 失敗時 -1 )
+    void            (*I2cClose)( int fd );                                                      ///< @var : クローズする
+    int             (*I2cSetSlave)( int fd, unsigned char address );                            ///< @var : ioctl( I2C_SLAVE ) 相当。失敗時 < 0
+    int             (*I2cWrite)( int fd, const unsigned char* data, unsigned int size );        ///< @var : write() 相当。戻り値 = 書き込んだ Byte 数
+    int             (*I2cRead)( int fd, unsigned char* data, unsigned int size );               ///< @var : read()  相当。戻り値 = 読み出した Byte 数
+    int             (*I2cTransfer)( int fd, struct i2c_msg* msgs, unsigned int num );           ///< @var : ioctl( I2C_RDWR ) 相当。戻り値 = 転送したメッセージ数
+
+    // GPIO
+    int             (*GpioSetup)( void );                                                       ///< @var : 初期化する。失敗時 -1
+    void            (*GpioPinMode)( int pin, EHalGpioMode_t mode );                             ///< @var : 端子の機能を設定する
+    void            (*GpioWrite)( int pin, int level );                                         ///< @var : 端子に出力する
+    int             (*GpioRead)( int pin );                                                     ///< @var : 端子の入力を読む
+
+    // PWM
+    void            (*PwmSetMode)( EHalPwmMode_t mode );                                        ///< @var : PWM モードを設定する
+    void            (*PwmSetClock)( unsigned int clock );                                       ///< @var : PWM クロックの分周比を設定する
+    void            (*PwmSetRange)( unsigned int range );                                       ///< @var : PWM の 1 周期のカウント数を設定する
+    void            (*PwmWrite)( int pin, unsigned int value );                                 ///< @var : PWM のデューティ ( カウント数 ) を設定する
+} SHalCmnBackend_t;
+
+
+//********************************************************
+/* 外部参照変数                                          */
+//********************************************************
+extern const SHalCmnBackend_t   g_halCmnBackendHw;      // 実機 ( spidev / i2c-dev / wiringPi )
+extern const SHalCmnBackend_t   g_halCmnBackendSim;     // シミュレータ
+
+
+//********************************************************
+/* 関数プロトタイプ宣言                                  */
+//********************************************************
+const SHalCmnBackend_t*     HalCmn_GetBackend( void );
+
+
+#endif /* _HAL_CMN_BACKEND_H_ */
@@ -0,0 +1,484 @@
+/**************************************************************************//*!
+ *  @file           hal_cmn_backend_hw.c
+ *  @brief          [HAL] 実機のバス・バックエンド ( spidev / i2c-dev / wiringPi ) を定義したファイル。
+ *  @author         Ryoji Morita
+ *  @attention      none.
+ *  @sa             none.
+ *  @bug            none.
+ *  @warning        none.
+ *  @version        1.00
+ *  @last updated   2016.06.05
+ *************************************************************************** */
+#ifdef __cplusplus
+    extern "C"{
+#endif
+
+
+//********************************************************
+/* include                                               */
+//********************************************************
+#include <fcntl.h>
+#include <wiringPi.h>
+
+#include <sys/ioctl.h>
+#include <linux/i2c-dev.h>
+#include <linux/spi/spidev.h>
+
+#include "hal_cmn.h"
+#include "hal_cmn_backend.h"
+
+
+//#define DBG_PRINT
+#define MY_NAME "HAL"
+#include "../app/log/log.h"
+
+
+//********************************************************
+/*! @def                                                 */
+//********************************************************
+#define SPI_DEVICE      "/dev/spidev0.0"
+#define SPI_SPEED       (8000000)   //  クロック 8MHz ( デフォルト )
+#define SPI_BITS        (8)         //  ビット数 ( 8bit のみ可能 )
+
+#define I2C_DEVICE      "/dev/i2c-1"
+
+
+//********************************************************
+/*! @enum                                                */
+//********************************************************
+// なし
+
+
+//********************************************************
+/*! @struct                                              */
+//********************************************************
+// なし
+
+
+//********************************************************
+/* モジュールグローバル変数                              */
+//********************************************************
+// なし
+
+
+//********************************************************
+/* 関数プロトタイプ宣言                                  */
+//********************************************************
+static int          SpiOpen( void );
+static void         SpiClose( int fd );
+static int          SpiTransfer( int fd, struct spi_ioc_transfer* tr, unsigned int num );
+
+static int          I2cOpen( void );
+static void         I2cClose( int fd );
+static int          I2cSetSlave( int fd, unsigned char address );
+static int          I2cWrite( int fd, const unsigned char* data, unsigned int size );
+static int          I2cRead( int fd, unsigned char* data, unsigned int size );
+static int          I2cTransfer( int fd, struct i2c_msg* msgs, unsigned int num );
+
+static int          GpioSetup( void );
+static void         GpioPinMode( int pin, EHalGpioMode_t mode );
+static void         GpioWrite( int pin, int level );
+static int          GpioRead( int pin );
+
+static void         PwmSetMode( EHalPwmMode_t mode );
+static void         PwmSetClock( unsigned int clock );
+static void         PwmSetRange( unsigned int range );
+static void         PwmWrite( int pin, unsigned int value );
+
+
+//********************************************************
+/* 外部公開変数                                          */
+//********************************************************
+const SHalCmnBackend_t  g_halCmnBackendHw = {
+    "hw",
+    SpiOpen, SpiClose, SpiTransfer,
+    I2cOpen, I2cClose, I2cSetSlave, I2cWrite, I2cRead, I2cTransfer,
+    GpioSetup, GpioPinMode, GpioWrite, GpioRead,
+    PwmSetMode, PwmSetClock, PwmSetRange, PwmWrite
+};
+
+
+
+
+/**************************************************************************//*!
+ * @brief     SPI デバイスをオープンし、モード・ビット数・クロックを設定する。
+ * @attention なし。
+ * @note      SPI_MODE_0 : CE 端子が通常 L で動作時に H 出力。SCLK の立ち上がり ( LOW  -> HIGH ) のタイミングで信号線から 1 ビットのデータを受信・送信する
+ *            SPI_MODE_1 : CE 端子が通常 L で動作時に H 出力。SCLK の立ち下がり ( HIGH -> LOW  ) のタイミングで信号線から 1 ビットのデータを受信・送信する
+ *            SPI_MODE_2 : CE 端子が通常 H で動作時に L 出力。SCLK の立ち下がり ( HIGH -> LOW  ) のタイミングで信号線から 1 ビットのデータを受信・送信する
+ *            SPI_MODE_3 : CE 端子が通常 H で動作時に L 出力。SCLK の立ち上がり ( LOW  -> HIGH ) のタイミングで信号線から 1 ビットのデータを受信・送信する
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    ファイルデスクリプタ ( 失敗時 -1 )
+ *************************************************************************** */
+static int
+SpiOpen(
+    void  ///< [in] ナシ
+){
+    int fd = -1;
+    int res = -1;
+    int speed = SPI_SPEED;
+    int bits = SPI_BITS;
+    int mode = SPI_MODE_0;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    fd = open( SPI_DEVICE, O_RDWR );
+    if( fd < 0 )
+    {
+        DBG_PRINT_ERROR( "Failed to open %s, try change permission. \n\r", SPI_DEVICE );
+        return -1;
+    }
+
+    res = ioctl( fd, SPI_IOC_WR_MODE, &mode );
+    if( res < 0 )
+    {
+        DBG_PRINT_ERROR( "Failed to setup SPI_IOC_WR_MODE. \n\r" );
+        goto err;
+    }
+
+    res = ioctl( fd, SPI_IOC_RD_MODE, &mode );
+    if( res < 0 )
+    {
+        DBG_PRINT_ERROR( "Failed to setup SPI_IOC_RD_MODE. \n\r" );
+        goto err;
+    }
+
+    res = ioctl( fd, SPI_IOC_WR_BITS_PER_WORD, &bits );
+    if( res < 0 )
+    {
+        DBG_PRINT_ERROR( "Failed to setup SPI_IOC_WR_BITS_PER_WORD. \n\r" );
+        goto err;
+    }
+
+    res = ioctl( fd, SPI_IOC_RD_BITS_PER_WORD, &bits );
+    if( res < 0 )
+    {
+        DBG_PRINT_ERROR( "Failed to setup SPI_IOC_RD_BITS_PER_WORD. \n\r" );
+        goto err;
+    }
+
+    res = ioctl( fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed );
+    if( res < 0 )
+    {
+        DBG_PRINT_ERROR( "Failed to setup SPI_IOC_WR_MAX_SPEED_HZ. \n\r" );
+        goto err;
+    }
+
+    res = ioctl( fd, SPI_IOC_RD_MAX_SPEED_HZ, &speed );
+    if( res < 0 )
+    {
+        DBG_PRINT_ERROR( "Failed to setup SPI_IOC_RD_MAX_SPEED_HZ. \n\r" );
+        goto err;
+    }
+
+    return fd;
+
+err:
+    close( fd );
+    return -1;
+}
+
+
+/**************************************************************************//*!
+ * @brief     SPI デバイスをクローズする。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+SpiClose(
+    int                         fd      ///< [in] ファイルデスクリプタ
+){
+    DBG_PRINT_TRACE( "\n\r" );
+    close( fd );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     SPI メッセージを転送する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    ioctl() の戻り値
+ *************************************************************************** */
+static int
+SpiTransfer(
+    int                         fd,     ///< [in] ファイルデスクリプタ
+    struct spi_ioc_transfer*    tr,     ///< [in] transfer の配列
+    unsigned int                num     ///< [in] transfer 数
+){
+    return ioctl( fd, SPI_IOC_MESSAGE(num), tr );
+}
+
+
+/**************************************************************************//*!
+ * @brief     I2C デバイスをオープンする。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    ファイルデスクリプタ ( 失敗時 -1 )
+ *************************************************************************** */
+static int
+I2cOpen(
+    void  ///< [in] ナシ
+){
+    int fd = -1;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    fd = open( I2C_DEVICE, O_RDWR );
+    if( fd < 0 )
+    {
+        DBG_PRINT_ERROR( "Failed to open %s, try change permission. \n\r", I2C_DEVICE );
+    }
+
+    return fd;
+}
+
+
+/**************************************************************************//*!
+ * @brief     I2C デバイスをクローズする。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+I2cClose(
+    int             fd      ///< [in] ファイルデスクリプタ
+){
+    DBG_PRINT_TRACE( "\n\r" );
+    close( fd );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     I2C スレーブデバイスのアドレスをセットする。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    ioctl() の戻り値
+ *************************************************************************** */
+static int
+I2cSetSlave(
+    int             fd,     ///< [in] ファイルデスクリプタ
+    unsigned char   address ///< [in] スレーブデバイスのアドレス
+){
+    return ioctl( fd, I2C_SLAVE, address );
+}
+
+
+/**************************************************************************//*!
+ * @brief     I2C スレーブデバイスに値を書き込む。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    write() の戻り値
+ *************************************************************************** */
+static int
+I2cWrite(
+    int                     fd,     ///< [in] ファイルデスクリプタ
+    const unsigned char*    data,   ///< [in] スレーブデバイスへ送るデータ
+    unsigned int            size    ///< [in] 送るデータサイズ
+){
+    return write( fd, data, size );
+}
+
+
+/**************************************************************************//*!
+ * @brief     I2C スレーブデバイスから値を読み出す。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    read() の戻り値
+ *************************************************************************** */
+static int
+I2cRead(
+    int             fd,     ///< [in]  ファイルデスクリプタ
+    unsigned char*  data,   ///< [out] スレーブデバイスからのデータを格納するバッファ
+    unsigned int    size    ///< [in]  受け取るデータサイズ
+){
+    return read( fd, data, size );
+}
+
+
+/**************************************************************************//*!
+ * @brief     I2C の複合転送 ( リピーテッド・スタート ) を行う。
+ * @attention なし。
+ * @note      スレーブアドレスは各メッセージに含まれるため、I2C_SLAVE は不要。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    ioctl() の戻り値 ( = 転送したメッセージ数 )
+ *************************************************************************** */
+static int
+I2cTransfer(
+    int                 fd,     ///< [in]     ファイルデスクリプタ
+    struct i2c_msg*     msgs,   ///< [in,out] 転送するメッセージ
+    unsigned int        num     ///< [in]     メッセージ数
+){
+    struct i2c_rdwr_ioctl_data  data;
+
+    data.msgs  = msgs;
+    data.nmsgs = num;
+    return ioctl( fd, I2C_RDWR, &data );
+}
+
+
+/**************************************************************************//*!
+ * @brief     wiringPi を BCM の GPIO 番号で初期化する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    wiringPiSetupGpio() の戻り値
+ *************************************************************************** */
+static int
+GpioSetup(
+    void  ///< [in] ナシ
+){
+    return wiringPiSetupGpio();
+}
+
+
+/**************************************************************************//*!
+ * @brief     端子の機能を設定する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+GpioPinMode(
+    int             pin,    ///< [in] GPIO 番号
+    EHalGpioMode_t  mode    ///< [in] 端子の機能
+){
+    switch( mode )
+    {
+    case EN_GPIO_INPUT      : pinMode( pin, INPUT );      break;
+    case EN_GPIO_OUTPUT     : pinMode( pin, OUTPUT );     break;
+    case EN_GPIO_PWM_OUTPUT : pinMode( pin, PWM_OUTPUT ); break;
+    default                 : break;
+    }
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     端子に出力する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+GpioWrite(
+    int             pin,    ///< [in] GPIO 番号
+    int             level   ///< [in] 出力レベル
+){
+    digitalWrite( pin, level );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     端子の入力を読む。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    入力レベル
+ *************************************************************************** */
+static int
+GpioRead(
+    int             pin     ///< [in] GPIO 番号
+){
+    return digitalRead( pin );
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM モードを設定する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+PwmSetMode(
+    EHalPwmMode_t   mode    ///< [in] PWM モード
+){
+    if( mode == EN_PWM_MODE_MS ){ pwmSetMode( PWM_MODE_MS  ); }
+    else                        { pwmSetMode( PWM_MODE_BAL ); }
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM クロックの分周比を設定する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+PwmSetClock(
+    unsigned int    clock   ///< [in] 分周比
+){
+    pwmSetClock( clock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM の 1 周期のカウント数を設定する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+PwmSetRange(
+    unsigned int    range   ///< [in] カウント数
+){
+    pwmSetRange( range );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM のデューティ ( カウント数 ) を設定する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+PwmWrite(
+    int             pin,    ///< [in] GPIO 番号
+    unsigned int    value   ///< [in] カウント数
+){
+    pwmWrite( pin, value );
+    return;
+}
+
+
+#ifdef __cplusplus
+    }
+#endif
@@ -0,0 +1,950 @@
+/**************************************************************************//*!
+ *  @file           hal_cmn_backend_sim.c
+ *  @brief          [HAL] シミュレータのバス・バックエンドを定義したファイル。
+ *  @author         Ryoji Morita
+ *  @attention      none.
+ *  @sa             none.
+ *  @note           H/W を接続していない PC 上でベンチマーク・回帰テストを行うために、
+ *                  以下のデバイスをメモリ上でモデル化する。
+ *                      SPI : AD コンバータ MCP3208
+ *                      I2C : PWM コントローラ PCA9685 ( I2C_SLAVE_PCA9685 )
+ *                            キャラクタ LCD           ( I2C_SLAVE_LCD )
+ *                      GPIO / PWM 端子
+ *  @bug            none.
+ *  @warning        none.
+ *  @version        1.00
+ *  @last updated   2016.06.05
+ *************************************************************************** */
+#ifdef __cplusplus
+    extern "C"{
+#endif
+
+
+//********************************************************
+/* include                                               */
+//********************************************************
+#include <pthread.h>
+#include <string.h>
+
+#include "hal_cmn.h"
+#include "hal_cmn_backend.h"
+
+
+//#define DBG_PRINT
+#define MY_NAME "HAL"
+#include "../app/log/log.h"
+
+
+//********************************************************
+/*! @def                                                 */
+//********************************************************
+#define SIM_SPI_FD          (100)       // 仮想のファイルデスクリプタ
+#define SIM_I2C_FD          (101)
+
+#define SIM_ADC_DEFAULT     (0x0800)    // MCP3208 の AD 値の初期値 ( 中点 )
+
+#define SIM_GPIO_NUM        (64)
+
+#define SIM_LCD_DDRAM       (0x80)      // LCD の DDRAM サイズ
+#define SIM_LCD_LINE        (0x20)      // LCD の 1 行あたりの DDRAM アドレス
+#define SIM_LCD_WIDTH       (16)
+
+#define PCA9685_MODE1       (0x00)
+#define PCA9685_MODE1_AI    (0x20)      // Auto-Increment
+#define LED0_ON_L           (0x06)
+#define ALLLED_ON_L         (0xFA)
+
+
+//********************************************************
+/*! @enum                                                */
+//********************************************************
+// なし
+
+
+//********************************************************
+/*! @struct                                              */
+//********************************************************
+typedef struct {
+    pthread_mutex_t     lock;
+    int                 ready;                      // 初期化済みか否か
+
+    // MCP3208
+    unsigned int        adc[MCP3208_CH_NUM];
+
+    // I2C
+    unsigned char       slave;                      // 現在のスレーブアドレス
+    unsigned char       pca9685[256];               // PCA9685 のレジスタ
+    unsigned char       pca9685Ptr;                 // PCA9685 のレジスタ・ポインタ
+    unsigned char       lcd[SIM_LCD_DDRAM];         // LCD の DDRAM
+    unsigned char       lcdAddr;                    // LCD の DDRAM アドレス
+    int                 lcdInc;                     // LCD のアドレスの進む方向 [ インクリメント = 1, デクリメント = 0 ]
+
+    // GPIO / PWM
+    EHalGpioMode_t      mode[SIM_GPIO_NUM];
+    int                 level[SIM_GPIO_NUM];
+    unsigned int        pwm[SIM_GPIO_NUM];
+    EHalPwmMode_t       pwmMode;
+    unsigned int        pwmClock;
+    unsigned int        pwmRange;
+
+    SHalSimStats_t      stats;
+} SHalCmnSim_t;
+
+
+//********************************************************
+/* モジュールグローバル変数                              */
+//********************************************************
+static SHalCmnSim_t     g_param = { PTHREAD_MUTEX_INITIALIZER, 0 };
+
+
+//********************************************************
+/* 関数プロトタイプ宣言                                  */
+//********************************************************
+static void         InitParam( void );
+static void         Lock( void );
+
+static int          SpiOpen( void );
+static void         SpiClose( int fd );
+static int          SpiTransfer( int fd, struct spi_ioc_transfer* tr, unsigned int num );
+
+static int          I2cOpen( void );
+static void         I2cClose( int fd );
+static int          I2cSetSlave( int fd, unsigned char address );
+static int          I2cWrite( int fd, const unsigned char* data, unsigned int size );
+static int          I2cRead( int fd, unsigned char* data, unsigned int size );
+static int          I2cTransfer( int fd, struct i2c_msg* msgs, unsigned int num );
+static int          SlaveWrite( unsigned char address, const unsigned char* data, unsigned int size );
+static int          SlaveRead( unsigned char address, unsigned char* data, unsigned int size );
+
+static void         Pca9685Write( const unsigned char* data, unsigned int size );
+static void         LcdWrite( const unsigned char* data, unsigned int size );
+static void         LcdExec( int rs, unsigned char code );
+
+static int          GpioSetup( void );
+static void         GpioPinMode( int pin, EHalGpioMode_t mode );
+static void         GpioWrite( int pin, int level );
+static int          GpioRead( int pin );
+
+static void         PwmSetMode( EHalPwmMode_t mode );
+static void         PwmSetClock( unsigned int clock );
+static void         PwmSetRange( unsigned int range );
+static void         PwmWrite( int pin, unsigned int value );
+
+
+//********************************************************
+/* 外部公開変数                                          */
+//********************************************************
+const SHalCmnBackend_t  g_halCmnBackendSim = {
+    "sim",
+    SpiOpen, SpiClose, SpiTransfer,
+    I2cOpen, I2cClose, I2cSetSlave, I2cWrite, I2cRead, I2cTransfer,
+    GpioSetup, GpioPinMode, GpioWrite, GpioRead,
+    PwmSetMode, PwmSetClock, PwmSetRange, PwmWrite
+};
+
+
+
+
+/**************************************************************************//*!
+ * @brief     ファイルスコープ内のグローバル変数を初期化する。
+ * @attention ロックを取ってから呼ぶこと。
+ * @note      GPIO 入力はプルアップされている ( = HIGH ) とする。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+InitParam(
+    void  ///< [in] ナシ
+){
+    int i = 0;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    for( i = 0; i < MCP3208_CH_NUM; i++ )
+    {
+        g_param.adc[i] = SIM_ADC_DEFAULT;
+    }
+
+    g_param.slave = 0;
+    memset( g_param.pca9685, 0, sizeof(g_param.pca9685) );
+    g_param.pca9685[PCA9685_MODE1] = 0x11;  // 電源投入時の値 ( SLEEP | ALLCALL )
+    g_param.pca9685Ptr = 0;
+    memset( g_param.lcd, ' ', sizeof(g_param.lcd) );
+    g_param.lcdAddr = 0;
+    g_param.lcdInc  = 1;
+
+    for( i = 0; i < SIM_GPIO_NUM; i++ )
+    {
+        g_param.mode[i]  = EN_GPIO_INPUT;
+        g_param.level[i] = EN_HIGH;
+        g_param.pwm[i]   = 0;
+    }
+    g_param.pwmMode  = EN_PWM_MODE_BAL;
+    g_param.pwmClock = 0;
+    g_param.pwmRange = 1024;
+
+    memset( &g_param.stats, 0, sizeof(g_param.stats) );
+    g_param.ready = 1;
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     シミュレータの状態をロックする。
+ * @attention 解除は pthread_mutex_unlock() で行う。
+ * @note      最初にロックした時に状態を初期化する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Lock(
+    void  ///< [in] ナシ
+){
+    pthread_mutex_lock( &g_param.lock );
+    if( !g_param.ready )
+    {
+        InitParam();
+    }
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     SPI デバイスをオープンする。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    仮想のファイルデスクリプタ
+ *************************************************************************** */
+static int
+SpiOpen(
+    void  ///< [in] ナシ
+){
+    DBG_PRINT_TRACE( "\n\r" );
+    return SIM_SPI_FD;
+}
+
+
+/**************************************************************************//*!
+ * @brief     SPI デバイスをクローズする。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+SpiClose(
+    int                         fd      ///< [in] ファイルデスクリプタ
+){
+    DBG_PRINT_TRACE( "\n\r" );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     SPI メッセージを転送する。
+ * @attention なし。
+ * @note      3 Byte の transfer を MCP3208 のシングルエンド変換コマンドとして解釈し、
+ *            HalCmnSim_SetAdc() で設定した AD 値を返す。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    転送した Byte 数
+ *************************************************************************** */
+static int
+SpiTransfer(
+    int                         fd,     ///< [in] ファイルデスクリプタ
+    struct spi_ioc_transfer*    tr,     ///< [in] transfer の配列
+    unsigned int                num     ///< [in] transfer 数
+){
+    unsigned int    i = 0;
+    int             total = 0;
+    unsigned char*  send;
+    unsigned char*  recv;
+    unsigned int    ch = 0;
+
+    Lock();
+    g_param.stats.spi_msg++;
+
+    for( i = 0; i < num; i++ )
+    {
+        send = (unsigned char*)(unsigned long)tr[i].tx_buf;
+        recv = (unsigned char*)(unsigned long)tr[i].rx_buf;
+
+        if( recv != NULL )
+        {
+            memset( recv, 0, tr[i].len );
+            if( send != NULL && tr[i].len == 3 && ( send[0] & 0x04 ) )
+            {
+                ch = ( ( send[0] & 0x01 ) << 2 ) | ( send[1] >> 6 );
+                recv[1] = ( g_param.adc[ch] >> 8 ) & 0x0F;
+                recv[2] = g_param.adc[ch] & 0xFF;
+            }
+        }
+
+        total += tr[i].len;
+        g_param.stats.spi_xfer++;
+    }
+
+    pthread_mutex_unlock( &g_param.lock );
+    return total;
+}
+
+
+/**************************************************************************//*!
+ * @brief     I2C デバイスをオープンする。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    仮想のファイルデスクリプタ
+ *************************************************************************** */
+static int
+I2cOpen(
+    void  ///< [in] ナシ
+){
+    DBG_PRINT_TRACE( "\n\r" );
+    return SIM_I2C_FD;
+}
+
+
+/**************************************************************************//*!
+ * @brief     I2C デバイスをクローズする。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+I2cClose(
+    int             fd      ///< [in] ファイルデスクリプタ
+){
+    DBG_PRINT_TRACE( "\n\r" );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     I2C スレーブデバイスのアドレスをセットする。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    0
+ *************************************************************************** */
+static int
+I2cSetSlave(
+    int             fd,     ///< [in] ファイルデスクリプタ
+    unsigned char   address ///< [in] スレーブデバイスのアドレス
+){
+    Lock();
+    g_param.slave = address;
+    g_param.stats.i2c_slave++;
+    pthread_mutex_unlock( &g_param.lock );
+    return 0;
+}
+
+
+/**************************************************************************//*!
+ * @brief     I2C スレーブデバイスに値を書き込む。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    書き込んだ Byte 数 ( 失敗時 -1 )
+ *************************************************************************** */
+static int
+I2cWrite(
+    int                     fd,     ///< [in] ファイルデスクリプタ
+    const unsigned char*    data,   ///< [in] スレーブデバイスへ送るデータ
+    unsigned int            size    ///< [in] 送るデータサイズ
+){
+    int     ret;
+
+    Lock();
+    g_param.stats.i2c_write++;
+    ret = SlaveWrite( g_param.slave, data, size );
+    pthread_mutex_unlock( &g_param.lock );
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     I2C スレーブデバイスから値を読み出す。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    読み出した Byte 数 ( 失敗時 -1 )
+ *************************************************************************** */
+static int
+I2cRead(
+    int             fd,     ///< [in]  ファイルデスクリプタ
+    unsigned char*  data,   ///< [out] スレーブデバイスからのデータを格納するバッファ
+    unsigned int    size    ///< [in]  受け取るデータサイズ
+){
+    int     ret;
+
+    Lock();
+    g_param.stats.i2c_read++;
+    ret = SlaveRead( g_param.slave, data, size );
+    pthread_mutex_unlock( &g_param.lock );
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     I2C の複合転送 ( リピーテッド・スタート ) を行う。
+ * @attention なし。
+ * @note      メッセージごとのスレーブアドレスで処理し、現在のスレーブアドレスは変えない。
+ *            途中のメッセージが NACK の場合は、以降を転送せずに -1 を返す。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    転送したメッセージ数 ( 失敗時 -1 )
+ *************************************************************************** */
+static int
+I2cTransfer(
+    int                 fd,     ///< [in]     ファイルデスクリプタ
+    struct i2c_msg*     msgs,   ///< [in,out] 転送するメッセージ
+    unsigned int        num     ///< [in]     メッセージ数
+){
+    int             ret = num;
+    int             res;
+    unsigned int    i;
+
+    Lock();
+    g_param.stats.i2c_xfer++;
+
+    for( i = 0; i < num; i++ )
+    {
+        g_param.stats.i2c_msg++;
+        if( msgs[i].flags & I2C_M_RD )
+        {
+            res = SlaveRead( msgs[i].addr, msgs[i].buf, msgs[i].len );
+        } else
+        {
+            res = SlaveWrite( msgs[i].addr, msgs[i].buf, msgs[i].len );
+        }
+
+        if( res < 0 )
+        {
+            ret = -1;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock( &g_param.lock );
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     指定したスレーブデバイスへの書き込みを処理する。
+ * @attention ロックを取ってから呼ぶこと。
+ * @note      存在しないスレーブアドレスへの書き込みは NACK ( = -1 ) とする。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    書き込んだ Byte 数 ( 失敗時 -1 )
+ *************************************************************************** */
+static int
+SlaveWrite(
+    unsigned char           address,    ///< [in] スレーブデバイスのアドレス
+    const unsigned char*    data,       ///< [in] スレーブデバイスへ送るデータ
+    unsigned int            size        ///< [in] 送るデータサイズ
+){
+    g_param.stats.i2c_byte += size;
+
+    if(      address == I2C_SLAVE_PCA9685 ){ Pca9685Write( data, size ); }
+    else if( address == I2C_SLAVE_LCD     ){ LcdWrite( data, size );     }
+    else                                   { return -1;                  }
+
+    return size;
+}
+
+
+/**************************************************************************//*!
+ * @brief     指定したスレーブデバイスからの読み出しを処理する。
+ * @attention ロックを取ってから呼ぶこと。
+ * @note      PCA9685 のみ、レジスタ・ポインタの位置から読み出せる。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    読み出した Byte 数 ( 失敗時 -1 )
+ *************************************************************************** */
+static int
+SlaveRead(
+    unsigned char   address,    ///< [in]  スレーブデバイスのアドレス
+    unsigned char*  data,       ///< [out] スレーブデバイスからのデータを格納するバッファ
+    unsigned int    size        ///< [in]  受け取るデータサイズ
+){
+    unsigned int    i = 0;
+
+    g_param.stats.i2c_byte += size;
+
+    if( address != I2C_SLAVE_PCA9685 )
+    {
+        return -1;
+    }
+
+    for( i = 0; i < size; i++ )
+    {
+        data[i] = g_param.pca9685[g_param.pca9685Ptr];
+        if( g_param.pca9685[PCA9685_MODE1] & PCA9685_MODE1_AI )
+        {
+            g_param.pca9685Ptr++;
+        }
+    }
+
+    return size;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PCA9685 への書き込みを処理する。
+ * @attention ロックを取ってから呼ぶこと。
+ * @note      先頭 1 Byte はレジスタ・ポインタ。MODE1 の AI ビットが 1 の場合は、
+ *            以降のデータを書き込むたびにポインタを進める。
+ *            ALLLED_* への書き込みは全 ch の LEDn_* に反映する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Pca9685Write(
+    const unsigned char*    data,   ///< [in] 書き込むデータ
+    unsigned int            size    ///< [in] データサイズ
+){
+    unsigned int    i = 0;
+    unsigned int    ch = 0;
+    unsigned char   reg = 0;
+
+    if( size == 0 )
+    {
+        return;
+    }
+
+    g_param.pca9685Ptr = data[0];
+    for( i = 1; i < size; i++ )
+    {
+        reg = g_param.pca9685Ptr;
+        g_param.pca9685[reg] = data[i];
+
+        if( reg >= ALLLED_ON_L && reg <= ALLLED_ON_L + 3 )
+        {
+            for( ch = 0; ch < 16; ch++ )
+            {
+                g_param.pca9685[LED0_ON_L + ( 4 * ch ) + ( reg - ALLLED_ON_L )] = data[i];
+            }
+        }
+
+        if( g_param.pca9685[PCA9685_MODE1] & PCA9685_MODE1_AI )
+        {
+            g_param.pca9685Ptr++;
+        }
+    }
+
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     LCD への書き込みを処理する。
+ * @attention ロックを取ってから呼ぶこと。
+ * @note      コントロール・バイトの Co ビット ( 0x80 ) が 1 の場合は、1 Byte ごとにコントロール・バイトが続く。
+ *            Co ビットが 0 の場合は、残りのデータを全て RS ビット ( 0x40 ) に従って処理する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+LcdWrite(
+    const unsigned char*    data,   ///< [in] 書き込むデータ
+    unsigned int            size    ///< [in] データサイズ
+){
+    unsigned int    i = 0;
+    unsigned char   ctrl = 0;
+
+    while( i + 1 < size )
+    {
+        ctrl = data[i++];
+        if( ctrl & 0x80 )
+        {
+            LcdExec( ctrl & 0x40, data[i++] );
+        } else
+        {
+            while( i < size )
+            {
+                LcdExec( ctrl & 0x40, data[i++] );
+            }
+        }
+    }
+
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     LCD のコマンド or データを 1 Byte 処理する。
+ * @attention ロックを取ってから呼ぶこと。
+ * @note      Clear Display / Return Home / Set DDRAM Address のみモデル化する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+LcdExec(
+    int             rs,     ///< [in] Register Select ( 0 = コマンド )
+    unsigned char   code    ///< [in] コマンド or データ
+){
+    if( rs )
+    {
+        g_param.lcd[g_param.lcdAddr % SIM_LCD_DDRAM] = code;
+        g_param.lcdAddr = ( g_param.lcdAddr + ( g_param.lcdInc ? 1 : SIM_LCD_DDRAM - 1 ) ) % SIM_LCD_DDRAM;
+    } else if( code & 0x80 )
+    {
+        g_param.lcdAddr = code & 0x7F;
+    } else if( code == 0x01 )
+    {
+        memset( g_param.lcd, ' ', sizeof(g_param.lcd) );
+        g_param.lcdAddr = 0;
+    } else if( code == 0x02 )
+    {
+        g_param.lcdAddr = 0;
+    } else if( ( code & 0xFC ) == 0x04 )
+    {
+        g_param.lcdInc = ( code & 0x02 ) ? 1 : 0;
+    } else
+    {
+        ;
+    }
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     GPIO を初期化する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    0
+ *************************************************************************** */
+static int
+GpioSetup(
+    void  ///< [in] ナシ
+){
+    DBG_PRINT_TRACE( "\n\r" );
+
+    Lock();
+    pthread_mutex_unlock( &g_param.lock );
+    return 0;
+}
+
+
+/**************************************************************************//*!
+ * @brief     端子の機能を設定する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+GpioPinMode(
+    int             pin,    ///< [in] GPIO 番号
+    EHalGpioMode_t  mode    ///< [in] 端子の機能
+){
+    Lock();
+    g_param.mode[pin % SIM_GPIO_NUM] = mode;
+    g_param.stats.gpio_mode++;
+    pthread_mutex_unlock( &g_param.lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     端子に出力する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+GpioWrite(
+    int             pin,    ///< [in] GPIO 番号
+    int             level   ///< [in] 出力レベル
+){
+    Lock();
+    g_param.level[pin % SIM_GPIO_NUM] = level;
+    g_param.stats.gpio_write++;
+    pthread_mutex_unlock( &g_param.lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     端子の入力を読む。
+ * @attention なし。
+ * @note      なし。
+ * @sa        HalCmnSim_SetPin()
+ * @author    Ryoji Morita
+ * @return    入力レベル
+ *************************************************************************** */
+static int
+GpioRead(
+    int             pin     ///< [in] GPIO 番号
+){
+    int level = 0;
+
+    Lock();
+    level = g_param.level[pin % SIM_GPIO_NUM];
+    pthread_mutex_unlock( &g_param.lock );
+    return level;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM モードを設定する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+PwmSetMode(
+    EHalPwmMode_t   mode    ///< [in] PWM モード
+){
+    Lock();
+    g_param.pwmMode = mode;
+    g_param.stats.pwm_cfg++;
+    pthread_mutex_unlock( &g_param.lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM クロックの分周比を設定する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+PwmSetClock(
+    unsigned int    clock   ///< [in] 分周比
+){
+    Lock();
+    g_param.pwmClock = clock;
+    g_param.stats.pwm_cfg++;
+    pthread_mutex_unlock( &g_param.lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM の 1 周期のカウント数を設定する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+PwmSetRange(
+    unsigned int    range   ///< [in] カウント数
+){
+    Lock();
+    g_param.pwmRange = range;
+    g_param.stats.pwm_cfg++;
+    pthread_mutex_unlock( &g_param.lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM のデューティ ( カウント数 ) を設定する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+PwmWrite(
+    int             pin,    ///< [in] GPIO 番号
+    unsigned int    value   ///< [in] カウント数
+){
+    Lock();
+    g_param.pwm[pin % SIM_GPIO_NUM] = value;
+    g_param.stats.pwm_write++;
+    pthread_mutex_unlock( &g_param.lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     [シミュレータ] MCP3208 の AD 値を設定する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalCmnSim_SetAdc(
+    EHalSensorMcp3208_t which,  ///< [in] 対象のセンサ
+    unsigned int        value   ///< [in] AD 値 ( 12 bit )
+){
+    Lock();
+    g_param.adc[which % MCP3208_CH_NUM] = value & 0x0FFF;
+    pthread_mutex_unlock( &g_param.lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     [シミュレータ] GPIO 端子のレベルを外部から設定する。
+ * @attention なし。
+ * @note      スイッチ入力などを模擬するために使う。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalCmnSim_SetPin(
+    int                 pin,    ///< [in] GPIO 番号
+    int                 level   ///< [in] レベル
+){
+    Lock();
+    g_param.level[pin % SIM_GPIO_NUM] = level;
+    pthread_mutex_unlock( &g_param.lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     [シミュレータ] GPIO 端子のレベルを返す。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    レベル
+ *************************************************************************** */
+int
+HalCmnSim_GetPin(
+    int                 pin     ///< [in] GPIO 番号
+){
+    return GpioRead( pin );
+}
+
+
+/**************************************************************************//*!
+ * @brief     [シミュレータ] PWM 端子のデューティ ( カウント数 ) を返す。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    カウント数
+ *************************************************************************** */
+unsigned int
+HalCmnSim_GetPwm(
+    int                 pin     ///< [in] GPIO 番号
+){
+    unsigned int value = 0;
+
+    Lock();
+    value = g_param.pwm[pin % SIM_GPIO_NUM];
+    pthread_mutex_unlock( &g_param.lock );
+    return value;
+}
+
+
+/**************************************************************************//*!
+ * @brief     [シミュレータ] PCA9685 のレジスタ値を返す。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    レジスタ値
+ *************************************************************************** */
+unsigned char
+HalCmnSim_GetPca9685Reg(
+    unsigned char       reg     ///< [in] レジスタ・アドレス
+){
+    unsigned char value = 0;
+
+    Lock();
+    value = g_param.pca9685[reg];
+    pthread_mutex_unlock( &g_param.lock );
+    return value;
+}
+
+
+/**************************************************************************//*!
+ * @brief     [シミュレータ] LCD の 1 行分の表示内容を返す。
+ * @attention str は 17 Byte 以上確保すること。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalCmnSim_GetLcdLine(
+    int                 y,      ///< [in]  行 ( 0 or 1 )
+    char*               str     ///< [out] 表示内容 ( '\0' 終端 )
+){
+    Lock();
+    memcpy( str, &g_param.lcd[( y * SIM_LCD_LINE ) % SIM_LCD_DDRAM], SIM_LCD_WIDTH );
+    str[SIM_LCD_WIDTH] = '\0';
+    pthread_mutex_unlock( &g_param.lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     [シミュレータ] バスアクセス回数を返す。
+ * @attention なし。
+ * @note      なし。
+ * @sa        HalCmnSim_ClearStats()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalCmnSim_GetStats(
+    SHalSimStats_t*     stats   ///< [out] バスアクセス回数
+){
+    Lock();
+    memcpy( stats, &g_param.stats, sizeof(SHalSimStats_t) );
+    pthread_mutex_unlock( &g_param.lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     [シミュレータ] バスアクセス回数をクリアする。
+ * @attention なし。
+ * @note      なし。
+ * @sa        HalCmnSim_GetStats()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalCmnSim_ClearStats(
+    void  ///< [in] ナシ
+){
+    Lock();
+    memset( &g_param.stats, 0, sizeof(SHalSimStats_t) );
+    pthread_mutex_unlock( &g_param.lock );
+    return;
+}
+
+
+#ifdef __cplusplus
+    }
+#endif
@@ -17,9 +17,14 @@
 //********************************************************
 /* include                                               */
 //********************************************************
-#include <wiringPi.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #include "hal_cmn.h"
+#include "hal_cmn_backend.h"
 
 
 //#define DBG_PRINT
@@ -30,7 +35,15 @@
 //********************************************************
 /*! @def                                                 */
 //********************************************************
-// なし
+#define GPIO_MEM_DEVICE     "/dev/gpiomem"
+#define GPIO_MEM_ENV        "HAL_GPIOMEM"   // 代わりに mmap するファイル ( テスト用の疑似レジスタ )
+#define GPIO_MEM_SIZE       (4096)
+
+#define GPSET0              (0x1C / 4)      // GPIO Pin Output Set 0   ( GPIO 0 ～ 31 )
+#define GPCLR0              (0x28 / 4)      // GPIO Pin Output Clear 0 ( GPIO 0 ～ 31 )
+
+#define GPIO_PIN_NUM        (32)            // 設定をキャッシュする端子数 ( GPIO 0 ～ 31 )
+#define PWM_UNKNOWN         (0xFFFFFFFFU)   // PWM の設定値が不明 ( 次の設定で必ず書き込む )
 
 
 //********************************************************
@@ -42,13 +55,26 @@
 //********************************************************
 /*! @struct                                              */
 //********************************************************
-// なし
+typedef struct {
+    int                     fd;     // "/dev/gpiomem" のファイルデスクリプタ
+    volatile unsigned int*  map;    // GPIO レジスタ ( mmap できない場合は NULL )
+
+    // 設定済みの値 ( 同じ値の再設定を省くために使う )
+    int                     mode[GPIO_PIN_NUM];     // 端子の機能 ( 不明の場合は -1 )
+    unsigned int            duty[GPIO_PIN_NUM];     // PWM のデューティ ( カウント数 )
+    unsigned int            pwmMode;                // PWM モード
+    unsigned int            pwmClock;               // PWM クロックの分周比
+    unsigned int            pwmRange;               // PWM の 1 周期のカウント数
+} SHalCmnGpio_t;
 
 
 //********************************************************
 /* モジュールグローバル変数                              */
 //********************************************************
-// なし
+static SHalCmnGpio_t    g_param = { -1, NULL };
+
+// 端子の機能 / PWM の共通設定の排他 ( デバイスの初期化は複数スレッドで並行して行われる )
+static pthread_mutex_t  g_lock = PTHREAD_MUTEX_INITIALIZER;
 
 
 //********************************************************
@@ -56,6 +82,8 @@
 //********************************************************
 static void         InitParam( void );
 static EHalBool_t   InitReg( void );
+static void         OpenMap( void );
+static void         InvalidatePwm( void );
 
 
 
@@ -72,7 +100,101 @@ static void
 InitParam(
     void  ///< [in] ナシ
 ){
+    int     i = 0;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    g_param.fd  = -1;
+    g_param.map = NULL;
+
+    for( i = 0; i < GPIO_PIN_NUM; i++ )
+    {
+        g_param.mode[i] = -1;
+    }
+    InvalidatePwm();
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM の設定済みの値を不明にする。
+ * @attention なし。
+ * @note      wiringPi の pinMode( PWM_OUTPUT ) は PWM モード / クロック / レンジを既定値に戻すため、
+ *            端子を PWM 出力に切り替えたときにも呼ぶ。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+InvalidatePwm(
+    void  ///< [in] ナシ
+){
+    int     i = 0;
+
+    for( i = 0; i < GPIO_PIN_NUM; i++ )
+    {
+        g_param.duty[i] = PWM_UNKNOWN;
+    }
+    g_param.pwmMode  = PWM_UNKNOWN;
+    g_param.pwmClock = PWM_UNKNOWN;
+    g_param.pwmRange = PWM_UNKNOWN;
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     GPIO レジスタを mmap する。
+ * @attention なし。
+ * @note      環境変数 HAL_GPIOMEM にファイルを指定した場合は、そのファイルを疑似レジスタとして mmap する。
+ *            指定がなく実機バックエンドの場合は "/dev/gpiomem" を mmap する。
+ *            mmap できない場合は、HalCmnGpio_WriteMask() は 1 端子ずつの出力で代用する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+OpenMap(
+    void  ///< [in] ナシ
+){
+    const char*     path = getenv( GPIO_MEM_ENV );
+    void*           map = NULL;
+
     DBG_PRINT_TRACE( "\n\r" );
+
+    if( path == NULL )
+    {
+        if( HalCmn_GetBackendType() != EN_BACKEND_HW )
+        {
+            return;
+        }
+        path = GPIO_MEM_DEVICE;
+        g_param.fd = open( path, O_RDWR | O_SYNC );
+    } else
+    {
+        g_param.fd = open( path, O_RDWR | O_CREAT, 0644 );
+        if( g_param.fd >= 0 && ftruncate( g_param.fd, GPIO_MEM_SIZE ) < 0 )
+        {
+            close( g_param.fd );
+            g_param.fd = -1;
+        }
+    }
+
+    if( g_param.fd < 0 )
+    {
+        DBG_PRINT_WARN( "Failed to open %s, use per-pin write. \n\r", path );
+        return;
+    }
+
+    map = mmap( NULL, GPIO_MEM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, g_param.fd, 0 );
+    if( map == MAP_FAILED )
+    {
+        DBG_PRINT_WARN( "Failed to mmap %s, use per-pin write. \n\r", path );
+        close( g_param.fd );
+        g_param.fd = -1;
+        return;
+    }
+
+    g_param.map = (volatile unsigned int*)map;
     return;
 }
 
@@ -94,12 +216,13 @@ InitReg(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    res = wiringPiSetupGpio();
+    res = HalCmn_GetBackend()->GpioSetup();
     if( res != -1 )
     {
         ret = EN_TRUE;
     }
 
+    OpenMap();
     return ret;
 }
 
@@ -140,6 +263,229 @@ HalCmnGpio_Fini(
     void
 ){
     DBG_PRINT_TRACE( "\n\r" );
+
+    if( g_param.map != NULL )
+    {
+        munmap( (void*)g_param.map, GPIO_MEM_SIZE );
+        g_param.map = NULL;
+    }
+
+    if( g_param.fd >= 0 )
+    {
+        close( g_param.fd );
+        g_param.fd = -1;
+    }
+
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     端子の機能を設定する。
+ * @attention なし。
+ * @note      設定済みの機能と同じ場合は何もしない。
+ *            複数スレッドから呼んでよい。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalCmnGpio_PinMode(
+    int                 pin,    ///< [in] GPIO 番号 ( BCM )
+    EHalGpioMode_t      mode    ///< [in] 端子の機能
+){
+    pthread_mutex_lock( &g_lock );
+    if( pin >= 0 && pin < GPIO_PIN_NUM )
+    {
+        if( g_param.mode[pin] == (int)mode )
+        {
+            pthread_mutex_unlock( &g_lock );
+            return;
+        }
+        g_param.mode[pin] = (int)mode;
+    }
+
+    HalCmn_GetBackend()->GpioPinMode( pin, mode );
+    if( mode == EN_GPIO_PWM_OUTPUT )
+    {
+        InvalidatePwm();
+    }
+    pthread_mutex_unlock( &g_lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     端子に出力する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalCmnGpio_Write(
+    int                 pin,    ///< [in] GPIO 番号 ( BCM )
+    EHalOputputLevel_t  level   ///< [in] 出力レベル
+){
+    HalCmn_GetBackend()->GpioWrite( pin, level );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     複数の端子にまとめて出力する。
+ * @attention GPIO 0 ～ 31 のみ対象。
+ * @note      mmap した GPCLR0 / GPSET0 にそれぞれ 1 回ずつ書き込むため、
+ *            L にする端子どうし、H にする端子どうしは同時に切り替わる。
+ *            L にする端子を先に書き込む ( break-before-make )。
+ *            mmap できていない場合は、1 端子ずつ出力する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalCmnGpio_WriteMask(
+    unsigned int        mask,   ///< [in] 出力する端子のビットマスク ( bit n = GPIO n )
+    unsigned int        value   ///< [in] 出力レベル ( bit n = GPIO n の出力レベル )
+){
+    int                 pin;
+
+    if( g_param.map != NULL )
+    {
+        g_param.map[GPCLR0] = mask & ~value;
+        g_param.map[GPSET0] = mask &  value;
+        return;
+    }
+
+    for( pin = 0; pin < 32; pin++ )
+    {
+        if( ( mask & ~value ) & ( 1U << pin ) ){ HalCmn_GetBackend()->GpioWrite( pin, EN_LOW ); }
+    }
+
+    for( pin = 0; pin < 32; pin++ )
+    {
+        if( ( mask &  value ) & ( 1U << pin ) ){ HalCmn_GetBackend()->GpioWrite( pin, EN_HIGH ); }
+    }
+
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     端子の入力を読む。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    入力レベル ( 0 or 1 )
+ *************************************************************************** */
+int
+HalCmnGpio_Read(
+    int                 pin     ///< [in] GPIO 番号 ( BCM )
+){
+    return HalCmn_GetBackend()->GpioRead( pin );
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM モードを設定する。
+ * @attention PWM の全 ch に共通の設定。
+ * @note      設定済みの値と同じ場合は何もしない。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalCmnPwm_SetMode(
+    EHalPwmMode_t       mode    ///< [in] PWM モード
+){
+    pthread_mutex_lock( &g_lock );
+    if( g_param.pwmMode != (unsigned int)mode )
+    {
+        g_param.pwmMode = (unsigned int)mode;
+        HalCmn_GetBackend()->PwmSetMode( mode );
+    }
+    pthread_mutex_unlock( &g_lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM クロックの分周比を設定する。
+ * @attention PWM の全 ch に共通の設定。
+ * @note      PWM カウンタのクロック = 19.2MHz / clock
+ *            設定済みの値と同じ場合は何もしない ( 分周比の再設定は PWM 出力を一旦止めるため )。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalCmnPwm_SetClock(
+    unsigned int        clock   ///< [in] 分周比
+){
+    pthread_mutex_lock( &g_lock );
+    if( g_param.pwmClock != clock )
+    {
+        g_param.pwmClock = clock;
+        HalCmn_GetBackend()->PwmSetClock( clock );
+    }
+    pthread_mutex_unlock( &g_lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM の 1 周期のカウント数を設定する。
+ * @attention PWM の全 ch に共通の設定。
+ * @note      設定済みの値と同じ場合は何もしない。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalCmnPwm_SetRange(
+    unsigned int        range   ///< [in] カウント数
+){
+    pthread_mutex_lock( &g_lock );
+    if( g_param.pwmRange != range )
+    {
+        g_param.pwmRange = range;
+        HalCmn_GetBackend()->PwmSetRange( range );
+    }
+    pthread_mutex_unlock( &g_lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM のデューティ ( カウント数 ) を設定する。
+ * @attention なし。
+ * @note      デューティ比 = value / range
+ *            設定済みの値と同じ場合は何もしない。
+ *            キャッシュの比較 / 更新と出力は、PinMode などによるキャッシュの無効化と競合しないよう g_lock の中で行う。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalCmnPwm_Write(
+    int                 pin,    ///< [in] GPIO 番号 ( BCM )
+    unsigned int        value   ///< [in] カウント数
+){
+    pthread_mutex_lock( &g_lock );
+    if( pin >= 0 && pin < GPIO_PIN_NUM )
+    {
+        if( g_param.duty[pin] == value )
+        {
+            pthread_mutex_unlock( &g_lock );
+            return;
+        }
+        g_param.duty[pin] = value;
+    }
+
+    HalCmn_GetBackend()->PwmWrite( pin, value );
+    pthread_mutex_unlock( &g_lock );
     return;
 }
 
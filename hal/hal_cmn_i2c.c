@@ -17,13 +17,8 @@
 //********************************************************
 /* include                                               */
 //********************************************************
-#include <fcntl.h>
-#include <sys/mman.h>
-
-#include <sys/ioctl.h>
-#include <linux/i2c-dev.h>
-
 #include "hal_cmn.h"
+#include "hal_cmn_backend.h"
 
 
 //#define DBG_PRINT
@@ -47,7 +42,8 @@
 /*! @struct                                              */
 //********************************************************
 typedef struct {
-    int                 fd; // "/dev/i2c-*" のファイルデスクリプタ
+    int                 fd;     // "/dev/i2c-*" のファイルデスクリプタ
+    int                 slave;  // 現在のスレーブアドレス ( 未設定 = -1 )
 } SHalCmnI2c_t;
 
 
@@ -81,6 +77,7 @@ InitParam(
     DBG_PRINT_TRACE( "\n\r" );
 
     g_param.fd = -1;
+    g_param.slave = -1;
     return;
 }
 
@@ -101,10 +98,9 @@ InitReg(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    g_param.fd = open( "/dev/i2c-1", O_RDWR );
+    g_param.fd = HalCmn_GetBackend()->I2cOpen();
     if( g_param.fd < 0 )
     {
-        DBG_PRINT_ERROR( "Failed to open /dev/i2c-1, try change permission. \n\r" );
         return ret;
     }
 
@@ -150,7 +146,7 @@ HalCmnI2c_Fini(
 ){
     DBG_PRINT_TRACE( "\n\r" );
 
-    close( g_param.fd );
+    HalCmn_GetBackend()->I2cClose( g_param.fd );
     return;
 }
 
@@ -158,7 +154,7 @@ HalCmnI2c_Fini(
 /**************************************************************************//*!
  * @brief     I2C スレーブデバイスのアドレスをセットする。
  * @attention なし。
- * @note      なし。
+ * @note      現在のスレーブアドレスと同じ場合は ioctl( I2C_SLAVE ) を発行しない。
  * @sa        なし。
  * @author    Ryoji Morita
  * @return    EN_TRUE : 成功, EN_FALSE : 失敗
@@ -172,13 +168,20 @@ HalCmnI2c_SetSlave(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    res = ioctl( g_param.fd, I2C_SLAVE, address );
+    if( g_param.slave == address )
+    {
+        ret = EN_TRUE;
+        return ret;
+    }
+
+    res = HalCmn_GetBackend()->I2cSetSlave( g_param.fd, address );
     if( res < 0) {
         DBG_PRINT_WARN( "Unable to get bus access to talk to i2c slave. \n\r" );
-        close( g_param.fd );
+        g_param.slave = -1;
         return ret;
     }
 
+    g_param.slave = address;
     ret = EN_TRUE;
     return ret;
 }
@@ -202,7 +205,7 @@ HalCmnI2c_Write(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    res = write( g_param.fd, data, size );
+    res = HalCmn_GetBackend()->I2cWrite( g_param.fd, data, size );
     if( res != size )
     {
         DBG_PRINT_WARN( "fail to write data to i2c slave. \n\r" );
@@ -232,7 +235,7 @@ HalCmnI2c_Read(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    res = read( g_param.fd, data, size );
+    res = HalCmn_GetBackend()->I2cRead( g_param.fd, data, size );
     if( res != size )
     {
         DBG_PRINT_WARN( "fail to read data from i2c slave. \n\r" );
@@ -244,6 +247,145 @@ HalCmnI2c_Read(
 }
 
 
+/**************************************************************************//*!
+ * @brief     I2C デバイスのハンドルを初期化する。
+ * @attention なし。
+ * @note      ハンドルはスレーブアドレスを保持し、HalCmnI2c_Dev*() の転送ごとに
+ *            i2c_msg に埋め込む。現在のスレーブアドレス ( I2C_SLAVE ) には依存しない。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalCmnI2c_DevInit(
+    SHalI2cDev_t*   dev,        ///< [out] I2C デバイスのハンドル
+    unsigned char   address     ///< [in]  スレーブデバイスのアドレス
+){
+    DBG_PRINT_TRACE( "\n\r" );
+
+    dev->address = address;
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     I2C デバイスに値を書き込む。
+ * @attention なし。
+ * @note      ioctl( I2C_RDWR ) 1 回で転送する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+HalCmnI2c_DevWrite(
+    const SHalI2cDev_t*     dev,    ///< [in] I2C デバイスのハンドル
+    const unsigned char*    data,   ///< [in] スレーブデバイスへ送るデータ
+    unsigned int            size    ///< [in] 送るデータサイズ
+){
+    EHalBool_t      ret = EN_FALSE;
+    struct i2c_msg  msg;
+    int             res = -1;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    msg.addr  = dev->address;
+    msg.flags = 0;
+    msg.len   = size;
+    msg.buf   = (unsigned char*)data;
+
+    res = HalCmn_GetBackend()->I2cTransfer( g_param.fd, &msg, 1 );
+    if( res != 1 )
+    {
+        DBG_PRINT_WARN( "fail to write data to i2c slave. : 0x%02X \n\r", dev->address );
+        return ret;
+    }
+
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     I2C デバイスから値を読み出す。
+ * @attention なし。
+ * @note      ioctl( I2C_RDWR ) 1 回で転送する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+HalCmnI2c_DevRead(
+    const SHalI2cDev_t*     dev,    ///< [in]  I2C デバイスのハンドル
+    unsigned char*          data,   ///< [out] スレーブデバイスからのデータを格納するバッファ
+    unsigned int            size    ///< [in]  受け取るデータサイズ
+){
+    EHalBool_t      ret = EN_FALSE;
+    struct i2c_msg  msg;
+    int             res = -1;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    msg.addr  = dev->address;
+    msg.flags = I2C_M_RD;
+    msg.len   = size;
+    msg.buf   = data;
+
+    res = HalCmn_GetBackend()->I2cTransfer( g_param.fd, &msg, 1 );
+    if( res != 1 )
+    {
+        DBG_PRINT_WARN( "fail to read data from i2c slave. : 0x%02X \n\r", dev->address );
+        return ret;
+    }
+
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     I2C デバイスのレジスタから値を読み出す。
+ * @attention なし。
+ * @note      レジスタ・アドレスの書き込みと読み出しを、リピーテッド・スタートで
+ *            つないだ 1 回の ioctl( I2C_RDWR ) で転送する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+HalCmnI2c_DevReadReg(
+    const SHalI2cDev_t*     dev,    ///< [in]  I2C デバイスのハンドル
+    unsigned char           reg,    ///< [in]  レジスタ・アドレス
+    unsigned char*          data,   ///< [out] スレーブデバイスからのデータを格納するバッファ
+    unsigned int            size    ///< [in]  受け取るデータサイズ
+){
+    EHalBool_t      ret = EN_FALSE;
+    struct i2c_msg  msg[2];
+    int             res = -1;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    msg[0].addr  = dev->address;
+    msg[0].flags = 0;
+    msg[0].len   = 1;
+    msg[0].buf   = &reg;
+
+    msg[1].addr  = dev->address;
+    msg[1].flags = I2C_M_RD;
+    msg[1].len   = size;
+    msg[1].buf   = data;
+
+    res = HalCmn_GetBackend()->I2cTransfer( g_param.fd, msg, 2 );
+    if( res != 2 )
+    {
+        DBG_PRINT_WARN( "fail to read register from i2c slave. : 0x%02X \n\r", dev->address );
+        return ret;
+    }
+
+    ret = EN_TRUE;
+    return ret;
+}
+
+
 #ifdef __cplusplus
     }
 #endif
@@ -18,12 +18,14 @@
 /* include                                               */
 //********************************************************
 #include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
 #include <sys/mman.h>
 
-#include <sys/ioctl.h>
 #include <linux/spi/spidev.h>
 
 #include "hal_cmn.h"
+#include "hal_cmn_backend.h"
 
 
 //#define DBG_PRINT
@@ -37,7 +39,9 @@
 #define SPI_SPEED       (8000000)   //  クロック 8MHz ( デフォルト )
 #define SPI_BITS        (8)         //  ビット数 ( 8bit のみ可能 )
 #define SPI_DELAY       (0)
-#define SPI_BLOCKSIZE   (2048)      //  ブロック転送サイズ
+#define SPI_BLOCKSIZE   (2048)      //  ブロック転送サイズ ( spidev の bufsiz が取得できない場合 )
+#define SPI_XFER_MAX    (8)         //  1 回の ioctl でまとめて転送できる transfer の最大数
+#define SPI_BUFSIZ_PATH "/sys/module/spidev/parameters/bufsiz"
 
 
 //********************************************************
@@ -50,8 +54,10 @@
 /*! @struct                                              */
 //********************************************************
 typedef struct {
-    int                     fd; // "/dev/spidev0.*" のファイルデスクリプタ
+    int                     fd;     // "/dev/spidev0.*" のファイルデスクリプタ
+    unsigned int            bufsiz; // spidev が 1 メッセージで転送できる最大 Byte 数 ( = ブロック転送サイズ )
     struct spi_ioc_transfer tr;
+    pthread_mutex_t         lock;   // 複数スレッドからのバスアクセスを排他する
 } SHalCmnSpi_t;
 
 
@@ -66,6 +72,7 @@ static SHalCmnSpi_t     g_param;
 //********************************************************
 static void         InitParam( void );
 static EHalBool_t   InitReg( void );
+static unsigned int GetBufsiz( void );
 
 
 
@@ -85,9 +92,11 @@ InitParam(
     DBG_PRINT_TRACE( "\n\r" );
 
     g_param.fd = -1;
+    g_param.bufsiz = SPI_BLOCKSIZE;
+    pthread_mutex_init( &g_param.lock, NULL );
 
-    g_param.tr.tx_buf        = (unsigned int)0;
-    g_param.tr.rx_buf        = (unsigned int)NULL;
+    g_param.tr.tx_buf        = (unsigned long)0;
+    g_param.tr.rx_buf        = (unsigned long)NULL;
     g_param.tr.len           = 1;
     g_param.tr.speed_hz      = SPI_SPEED;
     g_param.tr.delay_usecs   = SPI_DELAY;
@@ -100,11 +109,8 @@ InitParam(
 /**************************************************************************//*!
  * @brief     H/W レジスタを初期化する。
  * @attention なし。
- * @note      SPI_MODE_0 : CE 端子が通常 L で動作時に H 出力。SCLK の立ち上がり ( LOW  -> HIGH ) のタイミングで信号線から 1 ビットのデータを受信・送信する
- *            SPI_MODE_1 : CE 端子が通常 L で動作時に H 出力。SCLK の立ち下がり ( HIGH -> LOW  ) のタイミングで信号線から 1 ビットのデータを受信・送信する
- *            SPI_MODE_2 : CE 端子が通常 H で動作時に L 出力。SCLK の立ち下がり ( HIGH -> LOW  ) のタイミングで信号線から 1 ビットのデータを受信・送信する
- *            SPI_MODE_3 : CE 端子が通常 H で動作時に L 出力。SCLK の立ち上がり ( LOW  -> HIGH ) のタイミングで信号線から 1 ビットのデータを受信・送信する
- * @sa        なし。
+ * @note      デバイスのオープンと SPI モード・ビット数・クロックの設定はバックエンドが行う。
+ * @sa        hal_cmn_backend_hw.c
  * @author    Ryoji Morita
  * @return    EN_TRUE : 成功, EN_FALSE : 失敗
  *************************************************************************** */
@@ -114,70 +120,52 @@ InitReg(
 ){
     EHalBool_t      ret = EN_FALSE;
 
-    int res = -1;
-    int speed = SPI_SPEED;
-    int bits = SPI_BITS;
-    int mode = SPI_MODE_0;
-
     DBG_PRINT_TRACE( "\n\r" );
 
-    g_param.fd = open( "/dev/spidev0.0", O_RDWR );
+    g_param.fd = HalCmn_GetBackend()->SpiOpen();
     if( g_param.fd < 0 )
     {
-        DBG_PRINT_ERROR( "Failed to open /dev/spidev0.0, try change permission. \n\r" );
         return ret;
     }
 
-    res = ioctl( g_param.fd, SPI_IOC_WR_MODE, &mode );
-    if( res < 0 )
-    {
-        DBG_PRINT_ERROR( "Failed to setup SPI_IOC_WR_MODE. \n\r" );
-        close( g_param.fd );
-        return ret;
-    }
+    ret = EN_TRUE;
+    return ret;
+}
 
-    res = ioctl( g_param.fd, SPI_IOC_RD_MODE, &mode );
-    if( res < 0 )
-    {
-        DBG_PRINT_ERROR( "Failed to setup SPI_IOC_RD_MODE. \n\r" );
-        close( g_param.fd );
-        return ret;
-    }
 
-    res = ioctl( g_param.fd, SPI_IOC_WR_BITS_PER_WORD, &bits );
-    if( res < 0 )
-    {
-        DBG_PRINT_ERROR( "Failed to setup SPI_IOC_WR_BITS_PER_WORD. \n\r" );
-        close( g_param.fd );
-        return ret;
-    }
+/**************************************************************************//*!
+ * @brief     spidev の bufsiz モジュール・パラメータを読み出す。
+ * @attention なし。
+ * @note      spidev は 1 メッセージ ( = 1 回の ioctl ) の送信・受信の合計を bufsiz Byte までに制限する。
+ *            読み出せない場合は SPI_BLOCKSIZE を返す。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    bufsiz ( 単位: Byte )
+ *************************************************************************** */
+static unsigned int
+GetBufsiz(
+    void  ///< [in] ナシ
+){
+    FILE*           fp = NULL;
+    unsigned int    bufsiz = 0;
 
-    res = ioctl( g_param.fd, SPI_IOC_RD_BITS_PER_WORD, &bits );
-    if( res < 0 )
-    {
-        DBG_PRINT_ERROR( "Failed to setup SPI_IOC_RD_BITS_PER_WORD. \n\r" );
-        close( g_param.fd );
-        return ret;
-    }
+    DBG_PRINT_TRACE( "\n\r" );
 
-    res = ioctl( g_param.fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed );
-    if( res < 0 )
+    fp = fopen( SPI_BUFSIZ_PATH, "r" );
+    if( fp == NULL )
     {
-        DBG_PRINT_ERROR( "Failed to setup SPI_IOC_WR_MAX_SPEED_HZ. \n\r" );
-        close( g_param.fd );
-        return ret;
+        DBG_PRINT_WARN( "Failed to open %s, use default block size. \n\r", SPI_BUFSIZ_PATH );
+        return SPI_BLOCKSIZE;
     }
 
-    res = ioctl( g_param.fd, SPI_IOC_RD_MAX_SPEED_HZ, &speed );
-    if( res < 0 )
+    if( 1 != fscanf( fp, "%u", &bufsiz ) || bufsiz == 0 )
     {
-        DBG_PRINT_ERROR( "Failed to setup SPI_IOC_RD_MAX_SPEED_HZ. \n\r" );
-        close( g_param.fd );
-        return ret;
+        DBG_PRINT_WARN( "Failed to read %s, use default block size. \n\r", SPI_BUFSIZ_PATH );
+        bufsiz = SPI_BLOCKSIZE;
     }
 
-    ret = EN_TRUE;
-    return ret;
+    fclose( fp );
+    return bufsiz;
 }
 
 
@@ -200,6 +188,12 @@ HalCmnSpi_Init(
     InitParam();
     ret = InitReg();
 
+    if( HalCmn_GetBackendType() == EN_BACKEND_HW )
+    {
+        g_param.bufsiz = GetBufsiz();
+    }
+    DBG_PRINT_DEBUG( "bufsiz = %d \n\r", g_param.bufsiz );
+
     return ret;
 }
 
@@ -218,7 +212,7 @@ HalCmnSpi_Fini(
 ){
     DBG_PRINT_TRACE( "\n\r" );
 
-    close( g_param.fd );
+    HalCmn_GetBackend()->SpiClose( g_param.fd );
     return;
 }
 
@@ -240,11 +234,13 @@ HalCmnSpi_Send(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    g_param.tr.tx_buf = (unsigned int)data;
-    g_param.tr.rx_buf = (unsigned int)NULL;
+    pthread_mutex_lock( &g_param.lock );
+    g_param.tr.tx_buf = (unsigned long)&data;
+    g_param.tr.rx_buf = (unsigned long)NULL;
     g_param.tr.len    = 1;
 
-    res = ioctl( g_param.fd, SPI_IOC_MESSAGE(1), &g_param.tr );
+    res = HalCmn_GetBackend()->SpiTransfer( g_param.fd, &g_param.tr, 1 );
+    pthread_mutex_unlock( &g_param.lock );
     if( res < 0 )
     {
         DBG_PRINT_ERROR( "error: cannot send spi message. \n\r" );
@@ -274,11 +270,13 @@ HalCmnSpi_SendN(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    g_param.tr.tx_buf = (unsigned int)data;
-    g_param.tr.rx_buf = (unsigned int)NULL;
+    pthread_mutex_lock( &g_param.lock );
+    g_param.tr.tx_buf = (unsigned long)data;
+    g_param.tr.rx_buf = (unsigned long)NULL;
     g_param.tr.len    = size;
 
-    res = ioctl( g_param.fd, SPI_IOC_MESSAGE(1), &g_param.tr );
+    res = HalCmn_GetBackend()->SpiTransfer( g_param.fd, &g_param.tr, 1 );
+    pthread_mutex_unlock( &g_param.lock );
     if( res < 0 )
     {
         DBG_PRINT_ERROR( "error: cannot send spi message. \n\r" );
@@ -291,57 +289,48 @@ HalCmnSpi_SendN(
 
 
 /**************************************************************************//*!
- * @brief     SPI スレーブデバイスに SPI_BUFFERSIZE Byte 以上のデータを送信する。
+ * @brief     SPI スレーブデバイスに bufsiz Byte 以上のデータを送信する。
  * @attention なし。
- * @note      なし。
- * @sa        なし。
+ * @note      spidev は 1 メッセージの合計を bufsiz Byte までに制限するため、
+ *            データを bufsiz Byte のブロックに分割し、1 ブロックずつ 1 回の ioctl で送信する。
+ *            ブロック数を減らすには bufsiz モジュール・パラメータを大きくする。
+ *            ブロックの途中で他スレッドの転送が割り込まないよう、全ブロックを送るまでロックを保持する。
+ * @sa        GetBufsiz()
  * @author    Ryoji Morita
  * @return    EN_TRUE : 成功, EN_FALSE : 失敗
  *************************************************************************** */
 EHalBool_t
 HalCmnSpi_SendBuffer(
     unsigned char*  data,   ///< [in] スレーブデバイスへ送るデータ
-    int             size    ///< [in] 送信する Byte 数 ( n <= SPI_BUFFERSIZE )
+    int             size    ///< [in] 送信する Byte 数
 ){
     EHalBool_t      ret = EN_FALSE;
-    int             i = 0;
-    int             numBlock = 0;
-    int             lastBlock = 0;
+    int             res = 0;
+    unsigned int    len = 0;
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    // ブロック数の計算
-    numBlock  = size / SPI_BLOCKSIZE;
-    lastBlock = size % SPI_BLOCKSIZE;
+    pthread_mutex_lock( &g_param.lock );
+    while( size > 0 && res >= 0 )
+    {
+        len = ( (unsigned int)size < g_param.bufsiz ) ? (unsigned int)size : g_param.bufsiz;
 
-    g_param.tr.tx_buf = (unsigned int)data;
-    g_param.tr.rx_buf = (unsigned int)NULL;
-    g_param.tr.len    = size;
+        g_param.tr.tx_buf = (unsigned long)data;
+        g_param.tr.rx_buf = (unsigned long)NULL;
+        g_param.tr.len    = len;
 
-    for( i = 0; i < numBlock; i++ )
-    {
-        ret = HalCmnSpi_SendN( data, SPI_BLOCKSIZE );
-        if( ret == EN_FALSE )
-        {
-            DBG_PRINT_ERROR( "error: cannot send spi message. \n\r" );
-            goto err;
-        }
-        data += SPI_BLOCKSIZE;
+        res = HalCmn_GetBackend()->SpiTransfer( g_param.fd, &g_param.tr, 1 );
+        data += len;
+        size -= len;
     }
-
-    //  残りを送信
-    if( lastBlock )
+    pthread_mutex_unlock( &g_param.lock );
+    if( res < 0 )
     {
-        ret = HalCmnSpi_SendN( data, lastBlock );
-        if( ret == EN_FALSE )
-        {
-            DBG_PRINT_ERROR( "error: cannot send spi message. \n\r" );
-            goto err;
-        }
+        DBG_PRINT_ERROR( "error: cannot send spi message. \n\r" );
+        return ret;
     }
 
     ret = EN_TRUE;
-err:
     return ret;
 }
 
@@ -365,11 +354,68 @@ HalCmnSpi_RecvN(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    g_param.tr.tx_buf = (unsigned int)send;
-    g_param.tr.rx_buf = (unsigned int)recv;
+    pthread_mutex_lock( &g_param.lock );
+    g_param.tr.tx_buf = (unsigned long)send;
+    g_param.tr.rx_buf = (unsigned long)recv;
     g_param.tr.len    = size;
 
-    res = ioctl( g_param.fd, SPI_IOC_MESSAGE(1), &g_param.tr );
+    res = HalCmn_GetBackend()->SpiTransfer( g_param.fd, &g_param.tr, 1 );
+    pthread_mutex_unlock( &g_param.lock );
+    if( res < 0 )
+    {
+        DBG_PRINT_ERROR( "error: cannot send spi message. \n\r" );
+        return ret;
+    }
+
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     SPI スレーブデバイスと size Byte の転送を num 回、1 回の ioctl でまとめて行う。
+ * @attention num <= SPI_XFER_MAX であること。
+ * @note      send / recv は size * num Byte の連続したバッファ。
+ *            各 transfer の間は cs_change = 1 で CS を一度解除する。
+ * @sa        HalCmnSpi_RecvN()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+HalCmnSpi_RecvMulti(
+    unsigned char*  send,   ///< [in]  スレーブデバイスへ送るデータ ( size * num Byte )
+    unsigned char*  recv,   ///< [out] スレーブデバイスからのデータを格納するバッファ ( size * num Byte )
+    unsigned int    size,   ///< [in]  1 transfer あたりのデータサイズ
+    unsigned int    num     ///< [in]  transfer 数 ( 1 ～ SPI_XFER_MAX )
+){
+    EHalBool_t              ret = EN_FALSE;
+    int                     res = -1;
+    unsigned int            i = 0;
+    struct spi_ioc_transfer tr[SPI_XFER_MAX];
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    if( num == 0 || num > SPI_XFER_MAX )
+    {
+        DBG_PRINT_ERROR( "invalid number of transfers. : %d \n\r", num );
+        return ret;
+    }
+
+    memset( tr, 0, sizeof(tr) );
+    for( i = 0; i < num; i++ )
+    {
+        tr[i].tx_buf        = (unsigned long)( send + ( size * i ) );
+        tr[i].rx_buf        = (unsigned long)( recv + ( size * i ) );
+        tr[i].len           = size;
+        tr[i].speed_hz      = SPI_SPEED;
+        tr[i].delay_usecs   = SPI_DELAY;
+        tr[i].bits_per_word = SPI_BITS;
+        tr[i].cs_change     = ( i < num - 1 ) ? 1 : 0;   // 最後の transfer 以外は CS を解除する
+    }
+
+    pthread_mutex_lock( &g_param.lock );
+    res = HalCmn_GetBackend()->SpiTransfer( g_param.fd, tr, num );
+    pthread_mutex_unlock( &g_param.lock );
     if( res < 0 )
     {
         DBG_PRINT_ERROR( "error: cannot send spi message. \n\r" );
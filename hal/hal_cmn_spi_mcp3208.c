@@ -53,11 +53,48 @@
 //********************************************************
 /* 関数プロトタイプ宣言                                  */
 //********************************************************
-// なし
+static void         SetCommand( EHalSensorMcp3208_t which, unsigned char* send );
+static unsigned int GetValue( unsigned char* recv );
 
 
 
 
+/**************************************************************************//*!
+ * @brief     対象の ch を読み出すためのコマンド 3 Byte をセットする。
+ * @attention なし。
+ * @note      シングルエンド入力で変換する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+SetCommand(
+    EHalSensorMcp3208_t which,  ///< [in]  対象のセンサ
+    unsigned char*      send    ///< [out] コマンドを格納するバッファ ( 3 Byte )
+){
+    send[0] = ( which & 0x04 ) ? 0x07 : 0x06;
+    send[1] = ( which & 0x03 ) << 6;
+    send[2] = 0;
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     受信した 3 Byte から 12 bit の AD 値を取り出す。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    MCP3208 の AD 値
+ *************************************************************************** */
+static unsigned int
+GetValue(
+    unsigned char*      recv    ///< [in] 受信したデータ ( 3 Byte )
+){
+    return ((recv[1] & 0x0f) << 8) | recv[2];
+}
+
+
 /**************************************************************************//*!
  * @brief     MCP3208 の対象の ch の AD 値を読み出す
  * @attention なし。
@@ -76,18 +113,64 @@ HalCmnSpiMcp3208_Get(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    send[0] = ( which & 0x04 ) ? 0x07 : 0x06;
-    send[1] = ( which & 0x03 ) << 6;
-    send[2] = 0;
+    SetCommand( which, send );
 
     HalCmnSpi_RecvN( send, recv, 3 );
 
-    data = ((recv[1] & 0x0f) << 8) | recv[2];
+    data = GetValue( recv );
 
     return data;
 }
 
 
+/**************************************************************************//*!
+ * @brief     MCP3208 の複数の ch の AD 値を 1 回の SPI 転送でまとめて読み出す。
+ * @attention num <= MCP3208_CH_NUM であること。
+ * @note      ch ごとに 3 Byte の transfer を並べ、SPI_IOC_MESSAGE(num) で一括転送する。
+ * @sa        HalCmnSpiMcp3208_Get()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+HalCmnSpiMcp3208_GetMulti(
+    const EHalSensorMcp3208_t*  which,  ///< [in]  対象のセンサのリスト
+    unsigned int*               data,   ///< [out] AD 値を格納する配列 ( num 個 )
+    unsigned int                num     ///< [in]  対象のセンサの数
+){
+    EHalBool_t          ret = EN_FALSE;
+    unsigned char       send[3 * MCP3208_CH_NUM];
+    unsigned char       recv[3 * MCP3208_CH_NUM];
+    unsigned int        i = 0;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    if( num == 0 || num > MCP3208_CH_NUM )
+    {
+        DBG_PRINT_ERROR( "invalid number of channels. : %d \n\r", num );
+        return ret;
+    }
+
+    for( i = 0; i < num; i++ )
+    {
+        SetCommand( which[i], &send[3 * i] );
+    }
+
+    ret = HalCmnSpi_RecvMulti( send, recv, 3, num );
+    if( ret == EN_FALSE )
+    {
+        return ret;
+    }
+
+    for( i = 0; i < num; i++ )
+    {
+        data[i] = GetValue( &recv[3 * i] );
+    }
+
+    ret = EN_TRUE;
+    return ret;
+}
+
+
 #ifdef __cplusplus
     }
 #endif
@@ -0,0 +1,364 @@
+/**************************************************************************//*!
+ *  @file           hal_cmn_spi_mcp3208_stream.c
+ *  @brief          [HAL] SPI AD コンバータ MCP3208 のストリーミング・サンプラ API を定義したファイル。
+ *  @author         Ryoji Morita
+ *  @attention      none.
+ *  @sa             none.
+ *  @note           サンプラ・スレッドが一定周期で AD 値を読み出し、リングバッファに書き込む。
+ *                  書き込みは 1 スレッドのみ、読み出しは複数スレッドから可能 ( SPMC )。
+ *                  読み出し側はロックを取らず、SPI バスにもアクセスしない。
+ *  @bug            none.
+ *  @warning        none.
+ *  @version        1.00
+ *  @last updated   2016.06.23
+ *************************************************************************** */
+#ifdef __cplusplus
+    extern "C"{
+#endif
+
+
+//********************************************************
+/* include                                               */
+//********************************************************
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#include "hal_cmn.h"
+#include "hal.h"
+
+
+//#define DBG_PRINT
+#define MY_NAME "HAL"
+#include "../app/log/log.h"
+
+
+//********************************************************
+/*! @def                                                 */
+//********************************************************
+#define STREAM_MASK     (MCP3208_STREAM_NUM - 1)
+#define NSEC_PER_SEC    (1000000000ULL)
+
+
+//********************************************************
+/*! @enum                                                */
+//********************************************************
+// なし
+
+
+//********************************************************
+/*! @struct                                              */
+//********************************************************
+typedef struct {
+    unsigned long long      seq;    // 書き込み中 = 奇数, 書き込み完了 = 偶数 ( 2 * 位置 + 2 )
+    SHalMcp3208Sample_t     sample;
+} SHalMcp3208Slot_t;
+
+typedef struct {
+    pthread_t               thread;
+    int                     running;                // サンプラ・スレッドが動作中か否か
+    int                     stop;                   // サンプラ・スレッドへの停止要求
+    unsigned int            period;                 // サンプリング周期 ( 単位: usec )
+    unsigned int            num;                    // 対象の ch 数
+    EHalSensorMcp3208_t     which[MCP3208_CH_NUM];  // 対象の ch のリスト
+    unsigned int            mask;                   // 対象の ch のビットマスク
+    unsigned long           overrun;                // 周期に間に合わなかった回数
+    unsigned long long      head;                   // 次に書き込む位置 ( = 書き込み済みのサンプル数 )
+    SHalMcp3208Slot_t       ring[MCP3208_STREAM_NUM];
+} SHalMcp3208Stream_t;
+
+
+//********************************************************
+/* モジュールグローバル変数                              */
+//********************************************************
+static SHalMcp3208Stream_t  g_param;
+
+
+//********************************************************
+/* 関数プロトタイプ宣言                                  */
+//********************************************************
+static void                 Push( const SHalMcp3208Sample_t* sample );
+static void*                Sampler( void* arg );
+
+
+
+
+/**************************************************************************//*!
+ * @brief     リングバッファに 1 サンプルを書き込む。
+ * @attention サンプラ・スレッドからのみ呼ぶこと。
+ * @note      スロットの seq を奇数にしてから書き込み、書き込み後に偶数にする。
+ *            読み出し側は前後の seq が一致することで書き込み途中でないことを確認する。
+ * @sa        HalCmnSpiMcp3208_StreamRead()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Push(
+    const SHalMcp3208Sample_t*  sample  ///< [in] 書き込むサンプル
+){
+    unsigned long long  pos = g_param.head;
+    SHalMcp3208Slot_t*  slot = &g_param.ring[pos & STREAM_MASK];
+
+    __atomic_store_n( &slot->seq, 2 * pos + 1, __ATOMIC_RELAXED );
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+
+    memcpy( &slot->sample, sample, sizeof(SHalMcp3208Sample_t) );
+
+    __atomic_store_n( &slot->seq, 2 * pos + 2, __ATOMIC_RELEASE );
+    __atomic_store_n( &g_param.head, pos + 1, __ATOMIC_RELEASE );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     サンプラ・スレッド。
+ * @attention なし。
+ * @note      clock_nanosleep() の絶対時刻指定で周期を保つため、処理時間による周期のずれが累積しない。
+ *            処理が周期に間に合わなかった場合は、次の周期から再開する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    NULL
+ *************************************************************************** */
+static void*
+Sampler(
+    void*       arg     ///< [in] ナシ
+){
+    SHalMcp3208Sample_t     sample;
+    unsigned int            data[MCP3208_CH_NUM];
+    unsigned int            i = 0;
+    unsigned long long      next = 0;
+    unsigned long long      period = (unsigned long long)g_param.period * 1000;
+    unsigned long long      now = 0;
+    struct timespec         ts;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    next = HalTime_GetMonotonicNs();
+    while( 0 == __atomic_load_n( &g_param.stop, __ATOMIC_ACQUIRE ) )
+    {
+        memset( &sample, 0, sizeof(sample) );
+        sample.time = HalTime_GetMonotonicNs();
+
+        if( EN_TRUE == HalCmnSpiMcp3208_GetMulti( g_param.which, data, g_param.num ) )
+        {
+            for( i = 0; i < g_param.num; i++ )
+            {
+                sample.data[ g_param.which[i] ] = data[i];
+            }
+            Push( &sample );
+        }
+
+        next += period;
+        now = HalTime_GetMonotonicNs();
+        if( next < now )
+        {
+            DBG_PRINT_DEBUG( "sampler overrun. \n\r" );
+            g_param.overrun++;
+            next = now;
+        }
+
+        ts.tv_sec  = next / NSEC_PER_SEC;
+        ts.tv_nsec = next % NSEC_PER_SEC;
+        while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL ) != 0 )
+        {
+            ;   // シグナルで中断された場合は再度待つ
+        }
+    }
+
+    return NULL;
+}
+
+
+/**************************************************************************//*!
+ * @brief     ストリーミング・サンプリングを開始する。
+ * @attention HalCmnSpi_Init() の後に呼ぶこと。
+ * @note      開始すると、リングバッファの内容はクリアされる。
+ * @sa        HalCmnSpiMcp3208_StreamStop()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+HalCmnSpiMcp3208_StreamStart(
+    const EHalSensorMcp3208_t*  which,  ///< [in] 対象のセンサのリスト
+    unsigned int                num,    ///< [in] 対象のセンサの数 ( 1 ～ MCP3208_CH_NUM )
+    unsigned int                period  ///< [in] サンプリング周期 ( 単位: usec )
+){
+    EHalBool_t      ret = EN_FALSE;
+    unsigned int    i = 0;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    if( g_param.running )
+    {
+        DBG_PRINT_ERROR( "sampler is already running. \n\r" );
+        return ret;
+    }
+
+    if( num == 0 || num > MCP3208_CH_NUM || period == 0 )
+    {
+        DBG_PRINT_ERROR( "invalid argument error. \n\r" );
+        return ret;
+    }
+
+    memset( &g_param, 0, sizeof(g_param) );
+    g_param.period = period;
+    g_param.num    = num;
+    for( i = 0; i < num; i++ )
+    {
+        g_param.which[i] = which[i];
+        g_param.mask |= ( 1 << which[i] );
+    }
+
+    if( 0 != pthread_create( &g_param.thread, NULL, Sampler, NULL ) )
+    {
+        DBG_PRINT_ERROR( "fail to create sampler thread. \n\r" );
+        return ret;
+    }
+
+    g_param.running = 1;
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     ストリーミング・サンプリングを停止する。
+ * @attention なし。
+ * @note      リングバッファの内容は停止後も読み出せる。
+ * @sa        HalCmnSpiMcp3208_StreamStart()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalCmnSpiMcp3208_StreamStop(
+    void  ///< [in] ナシ
+){
+    DBG_PRINT_TRACE( "\n\r" );
+
+    if( g_param.running )
+    {
+        __atomic_store_n( &g_param.stop, 1, __ATOMIC_RELEASE );
+        pthread_join( g_param.thread, NULL );
+        g_param.running = 0;
+    }
+
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     現在の書き込み位置を返す。
+ * @attention なし。
+ * @note      読み出し側は、この値を読み出し位置の初期値にする。
+ * @sa        HalCmnSpiMcp3208_StreamRead()
+ * @author    Ryoji Morita
+ * @return    書き込み位置
+ *************************************************************************** */
+unsigned long long
+HalCmnSpiMcp3208_StreamHead(
+    void  ///< [in] ナシ
+){
+    return __atomic_load_n( &g_param.head, __ATOMIC_ACQUIRE );
+}
+
+
+/**************************************************************************//*!
+ * @brief     リングバッファから、読み出し位置以降のサンプルを最大 max 個読み出す。
+ * @attention 読み出し位置は呼び出し元ごとに持つこと。
+ * @note      ロックを取らないため、複数スレッドから同時に呼んでよい。
+ *            読み出しが遅れて上書きされたサンプルは読み飛ばす。
+ * @sa        HalCmnSpiMcp3208_StreamHead()
+ * @author    Ryoji Morita
+ * @return    読み出したサンプル数
+ *************************************************************************** */
+unsigned int
+HalCmnSpiMcp3208_StreamRead(
+    unsigned long long*     pos,    ///< [in,out] 読み出し位置 ( 読み出した分だけ進める )
+    SHalMcp3208Sample_t*    sample, ///< [out]    サンプルを格納する配列 ( max 個 )
+    unsigned int            max     ///< [in]     読み出すサンプルの最大数
+){
+    unsigned int            cnt = 0;
+    unsigned long long      head = 0;
+    unsigned long long      seq1 = 0;
+    unsigned long long      seq2 = 0;
+    SHalMcp3208Slot_t*      slot;
+
+    while( cnt < max )
+    {
+        head = __atomic_load_n( &g_param.head, __ATOMIC_ACQUIRE );
+        if( *pos >= head )
+        {
+            break;
+        }
+
+        if( head - *pos > MCP3208_STREAM_NUM )
+        {
+            *pos = head - MCP3208_STREAM_NUM;   // 上書きされたサンプルを読み飛ばす
+        }
+
+        slot = &g_param.ring[*pos & STREAM_MASK];
+        seq1 = __atomic_load_n( &slot->seq, __ATOMIC_ACQUIRE );
+        if( seq1 != 2 * (*pos) + 2 )
+        {
+            continue;   // 書き込み中 or 上書き済み。head を読み直す
+        }
+
+        memcpy( &sample[cnt], &slot->sample, sizeof(SHalMcp3208Sample_t) );
+
+        __atomic_thread_fence( __ATOMIC_ACQUIRE );
+        seq2 = __atomic_load_n( &slot->seq, __ATOMIC_RELAXED );
+        if( seq1 != seq2 )
+        {
+            continue;   // 読み出し中に上書きされた
+        }
+
+        (*pos)++;
+        cnt++;
+    }
+
+    return cnt;
+}
+
+
+/**************************************************************************//*!
+ * @brief     対象の ch の最新の AD 値を返す。
+ * @attention なし。
+ * @note      サンプラが動作していない or 対象の ch がサンプリング対象でない場合は失敗する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+HalCmnSpiMcp3208_StreamLatest(
+    EHalSensorMcp3208_t     which,  ///< [in]  対象のセンサ
+    unsigned int*           data    ///< [out] AD 値
+){
+    SHalMcp3208Sample_t     sample;
+    unsigned long long      head = 0;
+    unsigned long long      pos = 0;
+
+    if( !g_param.running || !( g_param.mask & ( 1 << which ) ) )
+    {
+        return EN_FALSE;
+    }
+
+    head = HalCmnSpiMcp3208_StreamHead();
+    if( head == 0 )
+    {
+        return EN_FALSE;
+    }
+
+    pos = head - 1;
+    if( 0 == HalCmnSpiMcp3208_StreamRead( &pos, &sample, 1 ) )
+    {
+        return EN_FALSE;
+    }
+
+    *data = sample.data[which];
+    return EN_TRUE;
+}
+
+
+#ifdef __cplusplus
+    }
+#endif
@@ -17,6 +17,8 @@
 //********************************************************
 /* include                                               */
 //********************************************************
+#include <string.h>
+
 #include "hal_cmn.h"
 #include "hal.h"
 
@@ -29,7 +31,7 @@
 //********************************************************
 /*! @def                                                 */
 //********************************************************
-// なし
+#define LCD_DATA_MAX    (64)    // 1 回の I2C 転送で送るデータの最大 Byte 数
 
 
 //********************************************************
@@ -41,13 +43,15 @@
 //********************************************************
 /*! @struct                                              */
 //********************************************************
-// なし
+typedef struct {
+    SHalI2cDev_t        dev;    // I2C デバイスのハンドル
+} SHalI2cLcd_t;
 
 
 //********************************************************
 /* モジュールグローバル変数                              */
 //********************************************************
-// なし
+static SHalI2cLcd_t     g_param = { { I2C_SLAVE_LCD } };
 
 
 //********************************************************
@@ -74,6 +78,8 @@ InitParam(
     void  ///< [in] ナシ
 ){
     DBG_PRINT_TRACE( "\n\r" );
+
+    HalCmnI2c_DevInit( &g_param.dev, I2C_SLAVE_LCD );
     return;
 }
 
@@ -140,9 +146,6 @@ HalI2cLcd_Init(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    // I2C スレーブデバイスを LCD に変える
-    HalCmnI2c_SetSlave( I2C_SLAVE_LCD );
-
     InitParam();
     ret = InitReg();
     if( ret == EN_FALSE )
@@ -199,7 +202,7 @@ HalI2cLcd_Write(
 
     buff[1] = code;
 
-    ret = HalCmnI2c_Write( buff, 2 );
+    ret = HalCmnI2c_DevWrite( &g_param.dev, buff, 2 );
     if( ret == EN_FALSE )
     {
         DBG_PRINT_ERROR( "fail to write data to i2c slave. \n\r" );
@@ -211,6 +214,87 @@ HalI2cLcd_Write(
 }
 
 
+/**************************************************************************//*!
+ * @brief     LCD にデータ ( 文字列 ) を連続して書き込む。
+ * @attention なし。
+ * @note      制御バイト 0x40 ( Co = 0, RS = 1 ) の後にデータを続け、1 回の I2C 転送で送る。
+ *            LCD_DATA_MAX を超える分は分割して送る。
+ * @sa        HalI2cLcd_WriteCmdData
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+HalI2cLcd_WriteData(
+    const unsigned char*    data,   ///< [in] LCD に書き込むデータ
+    unsigned int            size    ///< [in] データサイズ
+){
+    return HalI2cLcd_WriteCmdData( -1, data, size );
+}
+
+
+/**************************************************************************//*!
+ * @brief     LCD にコマンド 1 Byte とデータを連続して書き込む。
+ * @attention なし。
+ * @note      制御バイト 0x80 ( Co = 1, RS = 0 ) + コマンドの後に、制御バイト 0x40 ( Co = 0, RS = 1 ) +
+ *            データを続け、1 回の I2C 転送で送る。カーソル移動と文字列の書き込みを 1 回にまとめられる。
+ *            cmd が負の場合は、データのみを送る。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+HalI2cLcd_WriteCmdData(
+    int                     cmd,    ///< [in] LCD に書き込むコマンド ( なし = -1 )
+    const unsigned char*    data,   ///< [in] LCD に書き込むデータ
+    unsigned int            size    ///< [in] データサイズ
+){
+    EHalBool_t      ret = EN_TRUE;
+    unsigned char   buff[3 + LCD_DATA_MAX];
+    unsigned int    len = 0;
+    unsigned int    num = 0;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    if( cmd < 0 && size == 0 )
+    {
+        return ret;
+    }
+
+    do
+    {
+        len = 0;
+        if( cmd >= 0 )
+        {
+            buff[len++] = 0x80;
+            buff[len++] = cmd;
+            cmd = -1;
+        }
+
+        num = ( size > LCD_DATA_MAX ) ? LCD_DATA_MAX : size;
+        if( num > 0 )
+        {
+            buff[len++] = 0x40;
+            memcpy( &buff[len], data, num );
+            len  += num;
+            data += num;
+            size -= num;
+        } else
+        {
+            buff[len - 2] = 0x00;   // データなし : 最後の制御バイトは Co = 0
+        }
+
+        ret = HalCmnI2c_DevWrite( &g_param.dev, buff, len );
+        if( ret == EN_FALSE )
+        {
+            DBG_PRINT_ERROR( "fail to write data to i2c slave. \n\r" );
+            return ret;
+        }
+    } while( size > 0 );
+
+    return ret;
+}
+
+
 #ifdef __cplusplus
     }
 #endif
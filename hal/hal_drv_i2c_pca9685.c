@@ -48,6 +48,10 @@
 #define ALLLED_OFF_L      (0xFC)
 #define ALLLED_OFF_H      (0xFD)
 
+#define PCA9685_CH_NUM    (16)
+
+#define MODE1_AI          (0x20)    // MODE1 : Auto-Increment ビット
+
 
 //********************************************************
 /*! @enum                                                */
@@ -58,13 +62,22 @@
 //********************************************************
 /*! @struct                                              */
 //********************************************************
-// なし
+// PCA9685 のレジスタの写し ( シャドウ・レジスタ )
+typedef struct {
+    SHalI2cDev_t        dev;                    // I2C デバイスのハンドル
+    unsigned char       mode1;                  // MODE1 に最後に書き込んだ値 ( RESTART ビットを除く )
+    unsigned char       prescale;               // PRESCALE に最後に書き込んだ値
+    int                 modeValid;              // mode1 / prescale の値が確定しているか否か
+    unsigned int        on[PCA9685_CH_NUM];     // LEDn_ON  に最後に書き込んだ値
+    unsigned int        off[PCA9685_CH_NUM];    // LEDn_OFF に最後に書き込んだ値
+    unsigned int        valid;                  // on / off の値が確定している ch のビットマスク
+} SHalPca9685_t;
 
 
 //********************************************************
 /* モジュールグローバル変数                              */
 //********************************************************
-// なし
+static SHalPca9685_t    g_param = { { I2C_SLAVE_PCA9685 } };
 
 
 //********************************************************
@@ -74,8 +87,12 @@ static void         InitParam( void );
 static EHalBool_t   InitReg( void );
 
 static void         InitDevice( void );
+static EHalBool_t   WriteReg( unsigned char reg, unsigned char value );
 static EHalBool_t   SetPwmFreq( double freq );
 static EHalBool_t   SetPwm( unsigned char ch, unsigned int on, unsigned int off );
+static EHalBool_t   SetAutoIncrement( void );
+static EHalBool_t   SetPwmBurst( unsigned char ch, unsigned char num, const unsigned int* off );
+static unsigned int GetOffCount( EHalMotorState_t status, double rate );
 
 
 
@@ -93,6 +110,12 @@ InitParam(
     void  ///< [in] ナシ
 ){
     DBG_PRINT_TRACE( "\n\r" );
+
+    HalCmnI2c_DevInit( &g_param.dev, I2C_SLAVE_PCA9685 );
+    g_param.mode1     = 0;
+    g_param.prescale  = 0;
+    g_param.modeValid = 0;
+    g_param.valid     = 0;
     return;
 }
 
@@ -148,9 +171,6 @@ HalI2cPca9685_Init(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    // I2C スレーブデバイスを PCA9685 に変える
-    HalCmnI2c_SetSlave( I2C_SLAVE_PCA9685 );
-
     InitParam();
     ret = InitReg();
     if( ret == EN_FALSE )
@@ -185,7 +205,7 @@ HalI2cPca9685_Fini(
 
 
 /**************************************************************************//*!
- * @brief     PWM 周波数を設定する
+ * @brief     MODE1 / PRESCALE レジスタに 1 Byte 書き込み、シャドウ・レジスタを更新する。
  * @attention なし。
  * @note      なし。
  * @sa        なし。
@@ -193,13 +213,49 @@ HalI2cPca9685_Fini(
  * @return    EN_TRUE : 成功, EN_FALSE : 失敗
  *************************************************************************** */
 static EHalBool_t
+WriteReg(
+    unsigned char   reg,    ///< [in] レジスタ・アドレス ( PCA9685_MODE1 or PCA9685_PRESCALE )
+    unsigned char   value   ///< [in] 書き込む値
+){
+    EHalBool_t      ret = EN_FALSE;
+    unsigned char   buff[2];
+
+    buff[0] = reg;
+    buff[1] = value;
+    ret = HalCmnI2c_DevWrite( &g_param.dev, buff, 2 );
+    if( ret == EN_FALSE )
+    {
+        DBG_PRINT_ERROR( "fail to write data to i2c slave. \n\r" );
+        g_param.modeValid = 0;
+        return ret;
+    }
+
+    if( reg == PCA9685_MODE1 )
+    {
+        g_param.mode1 = value & 0x7F;   // RESTART ビットは書き込むとクリアされる
+    } else if( reg == PCA9685_PRESCALE )
+    {
+        g_param.prescale = value;
+    }
+
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM 周波数を設定する
+ * @attention なし。
+ * @note      PRESCALE がシャドウ・レジスタと同じ値の場合は、バスアクセスせずに戻る。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
 SetPwmFreq(
     double          freq            ///< [in] PWM 周波数
 ){
     EHalBool_t      ret = EN_FALSE;
-    unsigned char   regAddr;        // コマンドのレジスタ・アドレスをセット
     unsigned char   oldreg = 0x0;
-    unsigned char   buff[2];
     double          prescaleval = 25000000;
     unsigned int    prescale = 0;
 
@@ -210,29 +266,20 @@ SetPwmFreq(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    // I2C スレーブデバイスを PCA9685 に変える
-    HalCmnI2c_SetSlave( I2C_SLAVE_PCA9685 );
-
-    // PCA9685_MODE1 に 0x0 を書き込む ( reset )
-    buff[0] = PCA9685_MODE1;
-    buff[1] = 0x0;
-    ret = HalCmnI2c_Write( buff, 2 );
-    if( ret == EN_FALSE )
+    if( g_param.modeValid && g_param.prescale == prescale )
     {
-        DBG_PRINT_ERROR( "fail to write data to i2c slave. \n\r" );
-        return ret;
+        return EN_TRUE;
     }
 
-    // PCA9685_MODE1 のデータをスレーブデバイスから読み出す
-    regAddr = PCA9685_MODE1;
-    ret = HalCmnI2c_Write( &regAddr, 1 );
+    // PCA9685_MODE1 に 0x0 を書き込む ( reset )
+    ret = WriteReg( PCA9685_MODE1, 0x0 );
     if( ret == EN_FALSE )
     {
-        DBG_PRINT_ERROR( "fail to write 0x0 to i2c slave. \n\r" );
         return ret;
     }
 
-    ret = HalCmnI2c_Read( &oldreg, 1 );
+    // PCA9685_MODE1 のデータをスレーブデバイスから読み出す ( リピーテッド・スタート )
+    ret = HalCmnI2c_DevReadReg( &g_param.dev, PCA9685_MODE1, &oldreg, 1 );
     if( ret == EN_FALSE )
     {
         DBG_PRINT_ERROR( "fail to read data from i2c slave. \n\r" );
@@ -240,47 +287,36 @@ SetPwmFreq(
     }
 
     // PCA9685_MODE1 に (buff & 0x7F) | 0x10 を書き込む
-    buff[0] = PCA9685_MODE1;
-    buff[1] = (oldreg & 0x7F) | 0x10;
-    ret = HalCmnI2c_Write( buff, 2 );
+    ret = WriteReg( PCA9685_MODE1, (oldreg & 0x7F) | 0x10 );
     if( ret == EN_FALSE )
     {
-        DBG_PRINT_ERROR( "fail to write data to i2c slave. \n\r" );
         return ret;
     }
 
     // PCA9685_PRESCALE に prescale を書き込む
-    buff[0] = PCA9685_PRESCALE;
-    buff[1] = prescale;
-    ret = HalCmnI2c_Write( buff, 2 );
+    ret = WriteReg( PCA9685_PRESCALE, prescale );
     if( ret == EN_FALSE )
     {
-        DBG_PRINT_ERROR( "fail to write data to i2c slave. \n\r" );
         return ret;
     }
 
     // PCA9685_MODE1 に oldreg を書き込む
-    buff[0] = PCA9685_MODE1;
-    buff[1] = oldreg;
-    ret = HalCmnI2c_Write( buff, 2 );
+    ret = WriteReg( PCA9685_MODE1, oldreg );
     if( ret == EN_FALSE )
     {
-        DBG_PRINT_ERROR( "fail to write data to i2c slave. \n\r" );
         return ret;
     }
 
     usleep( 5 * 1000 );
 
     // PCA9685_MODE1 に oldreg | 0xa1 を書き込む
-    buff[0] = PCA9685_MODE1;
-    buff[1] = oldreg | 0xA1;
-    ret = HalCmnI2c_Write( buff, 2 );
+    ret = WriteReg( PCA9685_MODE1, oldreg | 0xA1 );
     if( ret == EN_FALSE )
     {
-        DBG_PRINT_ERROR( "fail to write data to i2c slave. \n\r" );
         return ret;
     }
 
+    g_param.modeValid = 1;
     return EN_TRUE;
 }
 
@@ -288,7 +324,7 @@ SetPwmFreq(
 /**************************************************************************//*!
  * @brief     指定した ch に PWM 波形を出力する。
  * @attention なし。
- * @note      なし。
+ * @note      シャドウ・レジスタと同じ値の場合は、バスアクセスせずに戻る。
  * @sa        なし。
  * @author    Ryoji Morita
  * @return    EN_TRUE : 成功, EN_FALSE : 失敗
@@ -304,8 +340,10 @@ SetPwm(
 
 //    DBG_PRINT_TRACE( "\n\r" );
 
-    // I2C スレーブデバイスを PCA9685 に変える
-    HalCmnI2c_SetSlave( I2C_SLAVE_PCA9685 );
+    if( ( g_param.valid & ( 1 << ch ) ) && g_param.on[ch] == on && g_param.off[ch] == off )
+    {
+        return EN_TRUE;
+    }
 
     buff[0] = LED0_ON_L + ( 4 * ch );
     buff[1] = on;
@@ -313,18 +351,174 @@ SetPwm(
     buff[3] = off;
     buff[4] = off >> 8;
 
-    ret = HalCmnI2c_Write( buff, 5 );
+    ret = HalCmnI2c_DevWrite( &g_param.dev, buff, 5 );
     if( ret == EN_FALSE )
     {
         DBG_PRINT_ERROR( "fail to write data to i2c slave. \n\r" );
+        g_param.valid &= ~( 1 << ch );
         return ret;
     }
 
+    g_param.on[ch]  = on;
+    g_param.off[ch] = off;
+    g_param.valid  |= ( 1 << ch );
+
     ret = EN_TRUE;
     return ret;
 }
 
 
+/**************************************************************************//*!
+ * @brief     MODE1 の Auto-Increment を有効にする。
+ * @attention なし。
+ * @note      シャドウ・レジスタで既に有効な場合は、バスアクセスせずに戻る。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+SetAutoIncrement(
+    void  ///< [in] ナシ
+){
+    if( g_param.modeValid && ( g_param.mode1 & MODE1_AI ) )
+    {
+        return EN_TRUE;
+    }
+
+    return WriteReg( PCA9685_MODE1, g_param.mode1 | MODE1_AI );
+}
+
+
+/**************************************************************************//*!
+ * @brief     連続した ch の PWM 波形を 1 回の I2C 転送でまとめて出力する。
+ * @attention num は 1 以上、ch + num は PCA9685_CH_NUM 以下であること。
+ * @note      Auto-Increment を使って LEDn_ON_L から 4 * num Byte を続けて書き込む。
+ *            全 ch に同じ値を書き込む場合は ALLLED_* レジスタを使う。
+ *            シャドウ・レジスタと同じ値の ch は両端から除いて転送する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+SetPwmBurst(
+    unsigned char       ch,     ///< [in] 先頭の ch ( 0 ～ 15 )
+    unsigned char       num,    ///< [in] ch 数
+    const unsigned int* off     ///< [in] ch ごとの PWM の L 出力する時間 ( num 個 )
+){
+    EHalBool_t      ret = EN_FALSE;
+    unsigned char   buff[1 + 4 * PCA9685_CH_NUM];
+    unsigned int    mask = 0;
+    unsigned int    size = 0;
+    int             same = 1;
+    int             first = -1;
+    int             last = -1;
+    int             i;
+
+//    DBG_PRINT_TRACE( "\n\r" );
+
+    // シャドウ・レジスタと異なる ch の範囲を求める
+    for( i = 0; i < num; i++ )
+    {
+        if( off[i] != off[0] )
+        {
+            same = 0;
+        }
+
+        if( !( g_param.valid & ( 1 << ( ch + i ) ) )
+         || g_param.on[ch + i] != 0 || g_param.off[ch + i] != off[i] )
+        {
+            if( first < 0 ){ first = i; }
+            last = i;
+        }
+    }
+
+    if( first < 0 )
+    {
+        return EN_TRUE;
+    }
+
+    if( first == last )
+    {
+        return SetPwm( ch + first, 0, off[first] );
+    }
+
+    ret = SetAutoIncrement();
+    if( ret == EN_FALSE )
+    {
+        return ret;
+    }
+
+    if( same && ch == 0 && num == PCA9685_CH_NUM )
+    {
+        // 全 ch に同じ値を書き込む
+        buff[0] = ALLLED_ON_L;
+        buff[1] = 0;
+        buff[2] = 0;
+        buff[3] = off[0];
+        buff[4] = off[0] >> 8;
+        size = 5;
+        first = 0;
+        last = PCA9685_CH_NUM - 1;
+    } else
+    {
+        buff[0] = LED0_ON_L + ( 4 * ( ch + first ) );
+        size = 1;
+        for( i = first; i <= last; i++ )
+        {
+            buff[size++] = 0;
+            buff[size++] = 0;
+            buff[size++] = off[i];
+            buff[size++] = off[i] >> 8;
+        }
+    }
+
+    for( i = first; i <= last; i++ )
+    {
+        mask |= ( 1 << ( ch + i ) );
+    }
+
+    ret = HalCmnI2c_DevWrite( &g_param.dev, buff, size );
+    if( ret == EN_FALSE )
+    {
+        DBG_PRINT_ERROR( "fail to write data to i2c slave. \n\r" );
+        g_param.valid &= ~mask;
+        return ret;
+    }
+
+    for( i = first; i <= last; i++ )
+    {
+        g_param.on[ch + i]  = 0;
+        g_param.off[ch + i] = off[i];
+    }
+    g_param.valid |= mask;
+
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     モータの状態とデューティ比から LEDn_OFF のカウント値を求める。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    LEDn_OFF のカウント値 ( 0 ～ 0xFFF )
+ *************************************************************************** */
+static unsigned int
+GetOffCount(
+    EHalMotorState_t    status, ///< [in] モータの状態
+    double              rate    ///< [in] デューティ比 : 0.0% ～ 100.0% まで
+){
+    if( status == EN_MOTOR_CCW || status == EN_MOTOR_CW )
+    {
+        return 0xFFF * rate / 100;
+    }
+
+    return 0;
+}
+
+
 /**************************************************************************//*!
  * @brief     指定した ch に PWM 波形を出力する。
  * @attention なし。
@@ -341,34 +535,54 @@ HalI2cPca9685_SetPwmDuty(
     double              rate    ///< [in] デューティ比 : 0.0% ～ 100.0% まで
 ){
     EHalBool_t      ret = EN_FALSE;
-    unsigned int    on = 0;
-    unsigned int    off = 0;
 
 //    DBG_PRINT_TRACE( "\n\r" );
 
-    on = 0;
-    off = 0xFFF * rate / 100;
+    if( ch >= PCA9685_CH_NUM )
+    {
+        DBG_PRINT_ERROR( "invalid channel. : %d \n\r", ch );
+        return ret;
+    }
 
-    // I2C スレーブデバイスを PCA9685 に変える
-    HalCmnI2c_SetSlave( I2C_SLAVE_PCA9685 );
+    ret = SetPwm( ch, 0, GetOffCount( status, rate ) );
+    return ret;
+}
 
-    if( status == EN_MOTOR_STANDBY )
-    {
-        ret = SetPwm( ch, on, 0 );
-    } else if( status == EN_MOTOR_BRAKE )
-    {
-        ret = SetPwm( ch, on, 0 );
-    } else if( status == EN_MOTOR_CCW || status == EN_MOTOR_CW )
-    {
-        ret = SetPwm( ch, on, off );
-    } else if( status == EN_MOTOR_STOP )
+
+/**************************************************************************//*!
+ * @brief     連続した複数の ch に PWM 波形をまとめて出力する。
+ * @attention なし。
+ * @note      全 ch の ON / OFF レジスタを 1 回の I2C 転送で書き込むため、
+ *            各 ch の出力が同じ PWM 周期で切り替わる。
+ * @sa        HalI2cPca9685_SetPwmDuty
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+HalI2cPca9685_SetPwmDutyMulti(
+    unsigned char       ch,     ///< [in] 先頭の ch ( 0 ～ 15 )
+    unsigned char       num,    ///< [in] ch 数 ( ch + num <= 16 )
+    EHalMotorState_t    status, ///< [in] モータの状態 ( 全 ch 共通 )
+    const double*       rate    ///< [in] ch ごとのデューティ比 : 0.0% ～ 100.0% まで ( num 個 )
+){
+    EHalBool_t      ret = EN_FALSE;
+    unsigned int    off[PCA9685_CH_NUM];
+    int             i;
+
+//    DBG_PRINT_TRACE( "\n\r" );
+
+    if( num == 0 || ch + num > PCA9685_CH_NUM || rate == NULL )
     {
-        ret = SetPwm( ch, on, 0 );
-    } else
+        DBG_PRINT_ERROR( "invalid channel. : ch = %d, num = %d \n\r", ch, num );
+        return ret;
+    }
+
+    for( i = 0; i < num; i++ )
     {
-        ;
+        off[i] = GetOffCount( status, rate[i] );
     }
 
+    ret = SetPwmBurst( ch, num, off );
     return ret;
 }
 
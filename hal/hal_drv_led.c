@@ -17,8 +17,6 @@
 //********************************************************
 /* include                                               */
 //********************************************************
-#include <wiringPi.h>
-
 #include "hal_cmn.h"
 #include "hal.h"
 
@@ -35,6 +33,7 @@
 #define LED1_OUT    (15)
 #define LED2_OUT    (23)
 #define LED3_OUT    (24)
+#define LED_MASK    ( ( 1U << LED0_OUT ) | ( 1U << LED1_OUT ) | ( 1U << LED2_OUT ) | ( 1U << LED3_OUT ) )
 
 
 //********************************************************
@@ -95,10 +94,10 @@ InitReg(
 ){
     DBG_PRINT_TRACE( "\n\r" );
 
-    pinMode( LED0_OUT, OUTPUT );
-    pinMode( LED1_OUT, OUTPUT );
-    pinMode( LED2_OUT, OUTPUT );
-    pinMode( LED3_OUT, OUTPUT );
+    HalCmnGpio_PinMode( LED0_OUT, EN_GPIO_OUTPUT );
+    HalCmnGpio_PinMode( LED1_OUT, EN_GPIO_OUTPUT );
+    HalCmnGpio_PinMode( LED2_OUT, EN_GPIO_OUTPUT );
+    HalCmnGpio_PinMode( LED3_OUT, EN_GPIO_OUTPUT );
 
     return EN_TRUE;
 }
@@ -162,26 +161,17 @@ void
 HalLed_Set(
     unsigned char   value   ///< [in] 点灯する値
 ){
-    unsigned char   flg = 0;
+    unsigned int    out = 0;
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    flg = ( value & 0x01 ) >> 0;
-    if( flg == 1 ){ digitalWrite( LED0_OUT, EN_HIGH ); }
-    else          { digitalWrite( LED0_OUT, EN_LOW  ); }
-
-    flg = ( value & 0x02 ) >> 1;
-    if( flg == 1 ){ digitalWrite( LED1_OUT, EN_HIGH ); }
-    else          { digitalWrite( LED1_OUT, EN_LOW  ); }
-
-    flg = ( value & 0x04 ) >> 2;
-    if( flg == 1 ){ digitalWrite( LED2_OUT, EN_HIGH ); }
-    else          { digitalWrite( LED2_OUT, EN_LOW  ); }
-
-    flg = ( value & 0x08 ) >> 3;
-    if( flg == 1 ){ digitalWrite( LED3_OUT, EN_HIGH ); }
-    else          { digitalWrite( LED3_OUT, EN_LOW  ); }
+    if( value & 0x01 ){ out |= ( 1U << LED0_OUT ); }
+    if( value & 0x02 ){ out |= ( 1U << LED1_OUT ); }
+    if( value & 0x04 ){ out |= ( 1U << LED2_OUT ); }
+    if( value & 0x08 ){ out |= ( 1U << LED3_OUT ); }
 
+    // 4 つの LED をまとめて切り替える
+    HalCmnGpio_WriteMask( LED_MASK, out );
     return;
 }
 
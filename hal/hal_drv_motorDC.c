@@ -17,7 +17,7 @@
 //********************************************************
 /* include                                               */
 //********************************************************
-#include <wiringPi.h>
+#include <math.h>
 
 #include "hal_cmn.h"
 #include "hal.h"
@@ -31,7 +31,15 @@
 //********************************************************
 /*! @def                                                 */
 //********************************************************
-#define MOTOR_OUT    (13)
+#define MOTOR_OUT           (13)
+
+#define PWM_BASE_CLOCK      (19200000.0)    ///< @def : PWM クロックの分周前の周波数 ( 単位: Hz )
+#define PWM_CLOCK_MIN       (2)             ///< @def : 分周比の最小値
+#define PWM_CLOCK_MAX       (4095)          ///< @def : 分周比の最大値
+#define PWM_RANGE_MIN       (2)             ///< @def : 1 周期のカウント数の最小値
+#define PWM_RANGE_MAX       (0x7FFFFFFFU)   ///< @def : 1 周期のカウント数の最大値
+#define PWM_CLOCK_DEFAULT   (3840)          ///< @def : 初期値の分周比   : カウンタ = 19.2MHz / 3840 = 5kHz
+#define PWM_RANGE_DEFAULT   (100)           ///< @def : 初期値のカウント数 : 周期 = 100 / 5kHz = 20 msec ( 50Hz, HalMotorSV と同じ )
 
 
 //********************************************************
@@ -43,13 +51,18 @@
 //********************************************************
 /*! @struct                                              */
 //********************************************************
-// なし
+typedef struct {
+    unsigned int        clock;      // PWM クロックの分周比
+    unsigned int        range;      // PWM の 1 周期のカウント数
+    EHalMotorState_t    status;     // モータの状態
+    double              rate;       // デューティ比 ( 単位: % )
+} SHalMotorDC_t;
 
 
 //********************************************************
 /* モジュールグローバル変数                              */
 //********************************************************
-// なし
+static SHalMotorDC_t    g_param = { PWM_CLOCK_DEFAULT, PWM_RANGE_DEFAULT, EN_MOTOR_STANDBY, 0.0 };
 
 
 //********************************************************
@@ -57,6 +70,7 @@
 //********************************************************
 static void         InitParam( void );
 static EHalBool_t   InitReg( void );
+static void         Output( double rate );
 
 
 
@@ -74,6 +88,11 @@ InitParam(
     void  ///< [in] ナシ
 ){
     DBG_PRINT_TRACE( "\n\r" );
+
+    g_param.clock  = PWM_CLOCK_DEFAULT;
+    g_param.range  = PWM_RANGE_DEFAULT;
+    g_param.status = EN_MOTOR_STOP;
+    g_param.rate   = 0.0;
     return;
 }
 
@@ -96,11 +115,34 @@ InitReg(
 
 
 /**************************************************************************//*!
- * @brief     DC モータを初期化する。
+ * @brief     PWM を出力する。
  * @attention なし。
- * @note      なし。
+ * @note      端子の機能 / PWM モード / クロック / レンジは変わったものだけが書き込まれる。
  * @sa        なし。
  * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Output(
+    double          rate    ///< [in] デューティ比 ( 単位: % )
+){
+    HalCmnGpio_PinMode( MOTOR_OUT, EN_GPIO_PWM_OUTPUT );
+    HalCmnPwm_SetMode( EN_PWM_MODE_MS );
+    HalCmnPwm_SetClock( g_param.clock );
+    HalCmnPwm_SetRange( g_param.range );
+
+    // デューティ比 = value / range
+    HalCmnPwm_Write( MOTOR_OUT, (unsigned int)lround( rate * g_param.range / 100.0 ) );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     DC モータを初期化する。
+ * @attention なし。
+ * @note      PWM 周波数は 50Hz ( 19.2MHz / 3840 / 100 ) で始める。変更は HalMotorDC_SetPwmFreq() で行う。
+ * @sa        HalMotorDC_SetPwmFreq
+ * @author    Ryoji Morita
  * @return    EN_TRUE : 成功, EN_FALSE : 失敗
  *************************************************************************** */
 EHalBool_t
@@ -109,9 +151,6 @@ HalMotorDC_Init(
 ){
     EHalBool_t      ret = EN_FALSE;
 
-    unsigned int        clock = 3840;
-    unsigned int        cnt = 100;
-
     DBG_PRINT_TRACE( "\n\r" );
 
     InitParam();
@@ -124,11 +163,6 @@ HalMotorDC_Init(
 
     HalMotorDC_SetPwmDuty( EN_MOTOR_STOP, 0 );
 
-    pinMode( MOTOR_OUT, PWM_OUTPUT );
-    pwmSetMode( PWM_MODE_MS );
-    pwmSetClock( clock );
-    pwmSetRange( cnt );
-
     ret = EN_TRUE;
     return ret;
 }
@@ -153,42 +187,220 @@ HalMotorDC_Fini(
 
 /**************************************************************************//*!
  * @brief     DC モータを回す。
- * @note      PWM のカウンタのカウントアップを 5kHz (= 0.2ms ) の速さでカウントアップする設定
- *              => 19.2MHz / clock(=3840) = 5kHz
- *            100 カウントアップで PWM 1 周期に設定
- *              => 0.2ms * cnt(=100) = 20ms (= 50Hz )
- * @sa        なし。
+ * @attention なし。
+ * @note      デューティ比は HalMotorDC_SetPwmDutyF() と同じ。
+ * @sa        HalMotorDC_SetPwmDutyF
  * @author    Ryoji Morita
- * @return    なし。
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗 ( サーボと PWM が競合する )
  *************************************************************************** */
-void
+EHalBool_t
 HalMotorDC_SetPwmDuty(
     EHalMotorState_t    status, ///< [in] モータの状態
     int                 rate    ///< [in] デューティ比 : 0% ～ 100% まで
 ){
-    unsigned int        value = 0;
-
     DBG_PRINT_TRACE( "status = %d \n\r", status );
     DBG_PRINT_TRACE( "rate   = %d%% \n\r", rate );
 
-    // デューティ比 = value / range
-    value = rate;
+    return HalMotorDC_SetPwmDutyF( status, (double)rate );
+}
+
+
+/**************************************************************************//*!
+ * @brief     DC モータを回す ( デューティ比を小数で指定する )。
+ * @attention なし。
+ * @note      デューティ比は 1 周期のカウント数 ( range ) の分解能で丸める。
+ *            分解能は HalMotorDC_GetPwmInfo() で取得できる。
+ *            サーボの出力中に周波数の違う PWM は出力しない ( スタンバイは常に設定できる )。
+ * @sa        HalMotorDC_SetPwmFreq, HalMotorDC_IsPwmFree
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗 ( サーボと PWM が競合する )
+ *************************************************************************** */
+EHalBool_t
+HalMotorDC_SetPwmDutyF(
+    EHalMotorState_t    status, ///< [in] モータの状態
+    double              rate    ///< [in] デューティ比 : 0.0% ～ 100.0% まで
+){
+    EHalBool_t          ret = EN_FALSE;
+
+    DBG_PRINT_TRACE( "status = %d \n\r", status );
+    DBG_PRINT_TRACE( "rate   = %f%% \n\r", rate );
+
+    if( rate < 0.0 )
+    {
+        rate = 0.0;
+    } else if( rate > 100.0 )
+    {
+        rate = 100.0;
+    }
+
+    if( status != EN_MOTOR_STANDBY && EN_FALSE == HalMotorDC_IsPwmFree( g_param.clock, g_param.range ) )
+    {
+        DBG_PRINT_ERROR( "PWM is used by the servo motor. \n\r" );
+        return ret;
+    }
 
     if( status == EN_MOTOR_STANDBY )
     {
-        pinMode( MOTOR_OUT, OUTPUT );
-        digitalWrite( MOTOR_OUT, EN_LOW );
+        HalCmnGpio_PinMode( MOTOR_OUT, EN_GPIO_OUTPUT );
+        HalCmnGpio_Write( MOTOR_OUT, EN_LOW );
     } else if( status == EN_MOTOR_BRAKE || status == EN_MOTOR_STOP )
     {
-        pwmWrite( MOTOR_OUT, 0 );
+        Output( 0.0 );
     } else if( status == EN_MOTOR_CCW || status == EN_MOTOR_CW )
     {
-        pwmWrite( MOTOR_OUT, value );
+        Output( rate );
     } else
     {
-        ;
+        return ret;
+    }
+
+    g_param.status = status;
+    g_param.rate   = rate;
+
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM 周波数を設定する。
+ * @attention PWM クロックの分周比は全 ch に共通なので、HalMotorDC2 も同じ周波数になる。
+ *            サーボの出力中は、サーボと同じ設定 ( 初期値の 50Hz ) 以外は失敗とする。
+ * @note      周波数 = 19.2MHz / ( clock * range )
+ *            分解能を最大にするため、分周比は clock = ceil( 19.2MHz / ( freq * PWM_RANGE_MAX ) ) を
+ *            PWM_CLOCK_MIN 以上にした値とする ( PWM_RANGE_MAX が大きいので、ほぼ常に PWM_CLOCK_MIN )。
+ *            周波数の誤差は range の丸め分 ( 1 / ( 2 * range ) 以下 ) になる。
+ *            現在のデューティ比は DC / DC2 とも新しい range で設定し直す ( range が変わるとデューティ比も変わるため )。
+ * @sa        HalMotorDC_GetPwmInfo
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗 ( 設定できない周波数 / サーボと PWM が競合する )
+ *************************************************************************** */
+EHalBool_t
+HalMotorDC_SetPwmFreq(
+    double              freq    ///< [in] PWM 周波数 ( 単位: Hz )
+){
+    EHalBool_t          ret = EN_FALSE;
+    unsigned int        clock = 0;
+    double              div = 0.0;
+    double              range = 0.0;
+    SHalMotorState_t    state;
+
+    DBG_PRINT_TRACE( "freq = %f Hz \n\r", freq );
+
+    if( freq <= 0.0 )
+    {
+        DBG_PRINT_ERROR( "invalid frequency. : %f \n\r", freq );
+        return ret;
+    }
+
+    // range が PWM_RANGE_MAX を超えない最小の分周比
+    div = ceil( PWM_BASE_CLOCK / ( freq * PWM_RANGE_MAX ) );
+    if( div > PWM_CLOCK_MAX )
+    {
+        DBG_PRINT_ERROR( "frequency out of range. : %f \n\r", freq );
+        return ret;
+    }
+
+    clock = ( div < PWM_CLOCK_MIN ) ? PWM_CLOCK_MIN : (unsigned int)div;
+    range = floor( PWM_BASE_CLOCK / ( clock * freq ) + 0.5 );
+    if( range < PWM_RANGE_MIN || range > PWM_RANGE_MAX )
+    {
+        DBG_PRINT_ERROR( "frequency out of range. : %f \n\r", freq );
+        return ret;
     }
 
+    // サーボの出力中は、サーボと同じ設定で出せる周波数 ( 50Hz ) だけを受け付ける
+    if( EN_FALSE == HalMotorDC_IsPwmFree( clock, (unsigned int)range ) )
+    {
+        if( freq != PWM_BASE_CLOCK / ( PWM_CLOCK_DEFAULT * PWM_RANGE_DEFAULT ) )
+        {
+            DBG_PRINT_ERROR( "PWM is used by the servo motor. \n\r" );
+            return ret;
+        }
+        clock = PWM_CLOCK_DEFAULT;
+        range = PWM_RANGE_DEFAULT;
+    }
+
+    g_param.clock = clock;
+    g_param.range = (unsigned int)range;
+    DBG_PRINT_TRACE( "clock = %u, range = %u \n\r", g_param.clock, g_param.range );
+
+    if( g_param.status != EN_MOTOR_STANDBY )
+    {
+        HalMotorDC_SetPwmDutyF( g_param.status, g_param.rate );
+    }
+
+    HalMotorDC2_GetState( &state );
+    if( state.status != EN_MOTOR_STANDBY )
+    {
+        HalMotorDC2_SetPwmDutyF( state.status, state.rate );
+    }
+
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM の設定を取得する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        HalMotorDC_SetPwmFreq
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalMotorDC_GetPwmInfo(
+    SHalPwmInfo_t*      info    ///< [out] PWM の設定
+){
+    info->clock      = g_param.clock;
+    info->range      = g_param.range;
+    info->freq       = PWM_BASE_CLOCK / ( (double)g_param.clock * g_param.range );
+    info->resolution = 100.0 / g_param.range;
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM をサーボと競合せずに出力できるか調べる。
+ * @attention なし。
+ * @note      PWM クロックの分周比と range は全 ch に共通で、サーボは初期値 ( 50Hz ) の設定で出力する。
+ *            サーボの出力中に別の設定で出力すると、サーボの周期とデューティ比が変わってしまう。
+ * @sa        HalMotorSV_SetPwmDuty
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 出力できる, EN_FALSE : サーボと競合する
+ *************************************************************************** */
+EHalBool_t
+HalMotorDC_IsPwmFree(
+    unsigned int        clock,  ///< [in] 出力したい分周比
+    unsigned int        range   ///< [in] 出力したい 1 周期のカウント数
+){
+    SHalMotorState_t    sv;
+
+    if( clock == PWM_CLOCK_DEFAULT && range == PWM_RANGE_DEFAULT )
+    {
+        return EN_TRUE;
+    }
+
+    HalMotorSV_GetState( &sv );
+    return ( sv.status == EN_MOTOR_CW || sv.status == EN_MOTOR_CCW ) ? EN_FALSE : EN_TRUE;
+}
+
+
+/**************************************************************************//*!
+ * @brief     DC モータの状態を取得する。
+ * @attention なし。
+ * @note      最後に設定した状態とデューティ比を返す。H/W にはアクセスしない。
+ * @sa        HalMotorDC_SetPwmDutyF
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalMotorDC_GetState(
+    SHalMotorState_t*   state   ///< [out] モータの状態
+){
+    state->status = g_param.status;
+    state->rate   = g_param.rate;
     return;
 }
 
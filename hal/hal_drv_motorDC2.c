@@ -17,7 +17,7 @@
 //********************************************************
 /* include                                               */
 //********************************************************
-#include <wiringPi.h>
+#include <math.h>
 
 #include "hal_cmn.h"
 #include "hal.h"
@@ -43,13 +43,16 @@
 //********************************************************
 /*! @struct                                              */
 //********************************************************
-// なし
+typedef struct {
+    EHalMotorState_t    status;     // 最後に設定した状態
+    double              rate;       // 最後に設定したデューティ比 ( 単位: % )
+} SHalMotorParam_t;
 
 
 //********************************************************
 /* モジュールグローバル変数                              */
 //********************************************************
-// なし
+static SHalMotorParam_t g_param;
 
 
 //********************************************************
@@ -57,6 +60,7 @@
 //********************************************************
 static void         InitParam( void );
 static EHalBool_t   InitReg( void );
+static void         Output( double rate );
 
 
 
@@ -74,6 +78,9 @@ InitParam(
     void  ///< [in] ナシ
 ){
     DBG_PRINT_TRACE( "\n\r" );
+
+    g_param.status = EN_MOTOR_STANDBY;
+    g_param.rate   = 0.0;
     return;
 }
 
@@ -95,6 +102,35 @@ InitReg(
 }
 
 
+/**************************************************************************//*!
+ * @brief     PWM を出力する。
+ * @attention なし。
+ * @note      PWM クロックとレンジは全 ch に共通なので、HalMotorDC で設定した周波数に従う。
+ *            端子の機能 / PWM モード / クロック / レンジは HalCmnGpio / HalCmnPwm 側で設定済みの値と比べ、
+ *            変わったものだけを書き込む。定常状態ではデューティの書き込み 1 回だけになる。
+ * @sa        HalMotorDC_SetPwmFreq
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Output(
+    double          rate    ///< [in] デューティ比 ( 単位: % )
+){
+    SHalPwmInfo_t   info;
+
+    HalMotorDC_GetPwmInfo( &info );
+
+    HalCmnGpio_PinMode( MOTOR_OUT, EN_GPIO_PWM_OUTPUT );
+    HalCmnPwm_SetMode( EN_PWM_MODE_MS );
+    HalCmnPwm_SetClock( info.clock );
+    HalCmnPwm_SetRange( info.range );
+
+    // デューティ比 = value / range
+    HalCmnPwm_Write( MOTOR_OUT, (unsigned int)lround( rate * info.range / 100.0 ) );
+    return;
+}
+
+
 /**************************************************************************//*!
  * @brief     DC モータを初期化する。
  * @attention なし。
@@ -144,59 +180,99 @@ HalMotorDC2_Fini(
 
 /**************************************************************************//*!
  * @brief     DC モータを回す。
- * @note      PWM のカウンタのカウントアップを 5kHz (= 0.2ms ) の速さでカウントアップする設定
- *              => 19.2MHz / clock(=3840) = 5kHz
- *            100 カウントアップで PWM 1 周期に設定
- *              => 0.2ms * cnt(=100) = 20ms (= 50Hz )
- * @sa        なし。
+ * @attention なし。
+ * @note      デューティ比は HalMotorDC2_SetPwmDutyF() と同じ。
+ * @sa        HalMotorDC2_SetPwmDutyF
  * @author    Ryoji Morita
- * @return    なし。
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗 ( サーボと PWM が競合する )
  *************************************************************************** */
-void
+EHalBool_t
 HalMotorDC2_SetPwmDuty(
     EHalMotorState_t    status, ///< [in] モータの状態
     int                 rate    ///< [in] デューティ比 : 0% ～ 100% まで
 ){
-    unsigned int        value = 0;
-    unsigned int        clock = 3840;
-    unsigned int        cnt = 100;
-
     DBG_PRINT_TRACE( "status = %d \n\r", status );
     DBG_PRINT_TRACE( "rate   = %d%% \n\r", rate );
 
-    // デューティ比 = value / range
-    value = rate;
+    return HalMotorDC2_SetPwmDutyF( status, (double)rate );
+}
+
+
+/**************************************************************************//*!
+ * @brief     DC モータを回す ( デューティ比を小数で指定する )。
+ * @attention なし。
+ * @note      デューティ比は HalMotorDC で設定した PWM の分解能で丸める。
+ *            サーボの出力中に周波数の違う PWM は出力しない ( スタンバイは常に設定できる )。
+ * @sa        HalMotorDC_GetPwmInfo, HalMotorDC_IsPwmFree
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗 ( サーボと PWM が競合する )
+ *************************************************************************** */
+EHalBool_t
+HalMotorDC2_SetPwmDutyF(
+    EHalMotorState_t    status, ///< [in] モータの状態
+    double              rate    ///< [in] デューティ比 : 0.0% ～ 100.0% まで
+){
+    EHalBool_t          ret = EN_FALSE;
+    SHalPwmInfo_t       info;
+
+    DBG_PRINT_TRACE( "status = %d \n\r", status );
+    DBG_PRINT_TRACE( "rate   = %f%% \n\r", rate );
+
+    if( rate < 0.0 )
+    {
+        rate = 0.0;
+    } else if( rate > 100.0 )
+    {
+        rate = 100.0;
+    }
+
+    HalMotorDC_GetPwmInfo( &info );
+    if( status != EN_MOTOR_STANDBY && EN_FALSE == HalMotorDC_IsPwmFree( info.clock, info.range ) )
+    {
+        DBG_PRINT_ERROR( "PWM is used by the servo motor. \n\r" );
+        return ret;
+    }
 
     if( status == EN_MOTOR_STANDBY )
     {
-        pinMode( MOTOR_OUT, OUTPUT );
-        digitalWrite( MOTOR_OUT, EN_LOW );
+        HalCmnGpio_PinMode( MOTOR_OUT, EN_GPIO_OUTPUT );
+        HalCmnGpio_Write( MOTOR_OUT, EN_LOW );
     } else if( status == EN_MOTOR_BRAKE )
     {
-        pinMode( MOTOR_OUT, PWM_OUTPUT );
-        pwmSetMode( PWM_MODE_MS );
-        pwmSetClock( clock );
-        pwmSetRange( cnt );
-        pwmWrite( MOTOR_OUT, 0 );
+        Output( 0.0 );
     } else if( status == EN_MOTOR_CCW || status == EN_MOTOR_CW )
     {
-        pinMode( MOTOR_OUT, PWM_OUTPUT );
-        pwmSetMode( PWM_MODE_MS );
-        pwmSetClock( clock );
-        pwmSetRange( cnt );
-        pwmWrite( MOTOR_OUT, value );
+        Output( rate );
     } else if( status == EN_MOTOR_STOP )
     {
-        pinMode( MOTOR_OUT, PWM_OUTPUT );
-        pwmSetMode( PWM_MODE_MS );
-        pwmSetClock( clock );
-        pwmSetRange( cnt );
-        pwmWrite( MOTOR_OUT, 0 );
+        Output( 0.0 );
     } else
     {
-        ;
+        return ret;
     }
 
+    g_param.status = status;
+    g_param.rate   = rate;
+
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     DC モータの状態を取得する。
+ * @attention なし。
+ * @note      最後に設定した状態とデューティ比を返す。H/W にはアクセスしない。
+ * @sa        HalMotorDC2_SetPwmDutyF
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalMotorDC2_GetState(
+    SHalMotorState_t*   state   ///< [out] モータの状態
+){
+    state->status = g_param.status;
+    state->rate   = g_param.rate;
     return;
 }
 
@@ -17,7 +17,9 @@
 //********************************************************
 /* include                                               */
 //********************************************************
-#include <wiringPi.h>
+#include <math.h>
+#include <pthread.h>
+#include <time.h>
 
 #include "hal_cmn.h"
 #include "hal.h"
@@ -40,7 +42,16 @@
 // PULSE = 1 PULSE で 0.17578125°回転。
 #define ANGLE_MIN           (1.8)       ///< @def :  指定可能な最小の回転角度
 #define PULSE_ANGLE_360     (200)       ///< @def : 360°回転するパルス数 ( 360 / 1.8 = 200 )
-#define PULSE_ERROR         (1)         ///< @def : 誤差
+#define USTEP_360           (PULSE_ANGLE_360 * 2)   ///< @def : 360°回転するマイクロ・ステップ数 ( ハーフ・ステップ単位 )
+#define MDEG_360            (360000LL)  ///< @def : 360°のミリ度
+
+#define SEQ_NUM             (8)         ///< @def : 励磁パターンのテーブルの状態数 ( ハーフ・ステップ )
+#define PIN_NUM             (4)         ///< @def : モータ出力の端子数
+#define STEP_RATE           (200.0)     ///< @def : 加減速なしの場合の速度 ( 単位: step/s ) : 1 相あたり 5 msec
+#define RAMP_NUM            (1024)      ///< @def : 加速テーブルの最大 step 数
+#define RAMP_DT             (1.0e-5)    ///< @def : S 字加減速のテーブル計算の刻み時間 ( 単位: sec )
+#define MOVE_QUEUE_NUM      (16)        ///< @def : 移動要求のキューの段数
+#define NSEC_PER_SEC        (1000000000ULL)
 
 
 //********************************************************
@@ -52,23 +63,74 @@
 //********************************************************
 /*! @struct                                              */
 //********************************************************
-// なし
+// 移動要求
+typedef struct {
+    unsigned int        id;         // ハンドル
+    long long           to;         // 移動先の位置 ( 単位: マイクロ・ステップ )
+} SHalMotorSTMove_t;
+
+typedef struct {
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;       // キューへの追加 / 移動の完了を通知する
+    pthread_t           thread;
+    int                 running;    // ステップ生成スレッドが動作中か否か
+    int                 stop;       // ステップ生成スレッドへの停止要求
+    int                 abort;      // 実行中 / キュー内の移動の中止要求
+    unsigned int        abortId;    // 中止する移動のハンドルの最大値
+    SHalMotorSTMove_t   queue[MOVE_QUEUE_NUM];
+    unsigned int        head;       // 次に実行する位置
+    unsigned int        tail;       // 次に追加する位置
+    unsigned int        nextId;     // 次に発行するハンドル
+    unsigned int        doneId;     // 最後に完了したハンドル
+    EHalMotorSTStep_t   mode;       // 励磁方式
+    long long           pos;        // 現在位置 ( 単位: マイクロ・ステップ )
+    int                 seqOfs;     // 位置 0 の励磁パターンの位置 : 励磁パターンの位置 = ( seqOfs + pos ) % SEQ_NUM
+    long long           plan;       // キュー内の移動をすべて終えたときの位置 ( 単位: マイクロ・ステップ )
+    long long           target;     // 指令した角度 ( 単位: ミリ度 )
+    unsigned int        out;        // 現在の出力 ( g_pin の順のビットマスク )
+    unsigned int        ramp[RAMP_NUM]; // 加速区間の step 間隔 ( 単位: nsec ) : 減速区間は逆順に使う
+    unsigned int        rampNum;    // 加速区間の step 数
+    unsigned int        cruise;     // 定速区間の step 間隔 ( 単位: nsec )
+} SHalMotorST_t;
 
 
 //********************************************************
 /* モジュールグローバル変数                              */
 //********************************************************
-// なし
+static SHalMotorST_t    g_param = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+// モータ出力の端子 ( 励磁パターンのビット順 )
+static const int            g_pin[PIN_NUM] = { MOTOR_OUT_A1, MOTOR_OUT_B1, MOTOR_OUT_A2, MOTOR_OUT_B2 };
+
+// 励磁パターン ( CW 方向 ) : 偶数 = 1 相励磁, 奇数 = 2 相励磁, 全体 = 1-2 相励磁
+static const unsigned char  g_seq[SEQ_NUM] = {
+    0x1,    // A1
+    0x3,    // A1 + B1
+    0x2,    //      B1
+    0x6,    //      B1 + A2
+    0x4,    //           A2
+    0xC,    //           A2 + B2
+    0x8,    //                B2
+    0x9     // A1 +           B2
+};
 
 
 //********************************************************
 /* 関数プロトタイプ宣言                                  */
 //********************************************************
-static void         InitParam( void );
-static EHalBool_t   InitReg( void );
+static void                 InitParam( void );
+static EHalBool_t           InitReg( void );
 
-static void         StepCw( void );
-static void         StepCcw( void );
+static unsigned int         BuildTrapezoid( const SHalMotorSTProfile_t* profile, unsigned int* ramp );
+static unsigned int         BuildSCurve( const SHalMotorSTProfile_t* profile, unsigned int* ramp );
+static void                 Output( unsigned int out );
+static int                  Step( int dir );
+static void                 Release( void );
+static long long            DivRound( long long num, long long den );
+static long long            ToUstep( long long mdeg );
+static int                  RunMove( int ustep );
+static void*                StepGen( void* arg );
+static unsigned int         Enqueue( long long target );
 
 
 
@@ -86,6 +148,23 @@ InitParam(
     void    ///< [in] ナシ
 ){
     DBG_PRINT_TRACE( "\n\r" );
+
+    g_param.running = 0;
+    g_param.stop    = 0;
+    g_param.abort   = 0;
+    g_param.abortId = 0;
+    g_param.head    = 0;
+    g_param.tail    = 0;
+    g_param.nextId  = 1;
+    g_param.doneId  = 0;
+    g_param.mode    = EN_ST_STEP_WAVE;
+    g_param.pos     = 0;
+    g_param.seqOfs  = SEQ_NUM - 2;      // 最初の CW の 1 Step は MOTOR_OUT_A1
+    g_param.plan    = 0;
+    g_param.target  = 0;
+    g_param.out     = 0xC;              // HalMotorST_Init() で A2 + B2 を H にする
+    g_param.rampNum = 0;
+    g_param.cruise  = NSEC_PER_SEC / STEP_RATE;
     return;
 }
 
@@ -104,10 +183,10 @@ InitReg(
 ){
     DBG_PRINT_TRACE( "\n\r" );
 
-    pinMode( MOTOR_OUT_A1, OUTPUT );
-    pinMode( MOTOR_OUT_A2, OUTPUT );
-    pinMode( MOTOR_OUT_B1, OUTPUT );
-    pinMode( MOTOR_OUT_B2, OUTPUT );
+    HalCmnGpio_PinMode( MOTOR_OUT_A1, EN_GPIO_OUTPUT );
+    HalCmnGpio_PinMode( MOTOR_OUT_A2, EN_GPIO_OUTPUT );
+    HalCmnGpio_PinMode( MOTOR_OUT_B1, EN_GPIO_OUTPUT );
+    HalCmnGpio_PinMode( MOTOR_OUT_B2, EN_GPIO_OUTPUT );
 
     return EN_TRUE;
 }
@@ -116,7 +195,7 @@ InitReg(
 /**************************************************************************//*!
  * @brief     ステッピング・モータを初期化する。
  * @attention なし。
- * @note      なし。
+ * @note      ステップ生成スレッドを起動する。
  * @sa        なし。
  * @author    Ryoji Morita
  * @return    EN_TRUE : 成功, EN_FALSE : 失敗
@@ -129,6 +208,12 @@ HalMotorST_Init(
 
     DBG_PRINT_TRACE( "\n\r" );
 
+    if( g_param.running )
+    {
+        ret = EN_TRUE;
+        return ret;
+    }
+
     InitParam();
     ret = InitReg();
     if( ret == EN_FALSE )
@@ -137,8 +222,17 @@ HalMotorST_Init(
         return ret;
     }
 
-    digitalWrite( MOTOR_OUT_A2, EN_HIGH );
-    digitalWrite( MOTOR_OUT_B2, EN_HIGH );
+    HalCmnGpio_Write( MOTOR_OUT_A2, EN_HIGH );
+    HalCmnGpio_Write( MOTOR_OUT_B2, EN_HIGH );
+
+    if( 0 != pthread_create( &g_param.thread, NULL, StepGen, NULL ) )
+    {
+        DBG_PRINT_ERROR( "fail to create step generator thread. \n\r" );
+        ret = EN_FALSE;
+        return ret;
+    }
+
+    g_param.running = 1;
     ret = EN_TRUE;
     return ret;
 }
@@ -147,7 +241,7 @@ HalMotorST_Init(
 /**************************************************************************//*!
  * @brief     ステッピング・モータを終了する。
  * @attention なし。
- * @note      なし。
+ * @note      実行中 / キュー内の移動を中止し、ステップ生成スレッドを停止する。
  * @sa        なし。
  * @author    Ryoji Morita
  * @return    なし。
@@ -157,127 +251,719 @@ HalMotorST_Fini(
     void  ///< [in] ナシ
 ){
     DBG_PRINT_TRACE( "\n\r" );
+
+    if( g_param.running )
+    {
+        pthread_mutex_lock( &g_param.lock );
+        __atomic_store_n( &g_param.stop,  1, __ATOMIC_RELEASE );
+        __atomic_store_n( &g_param.abort, 1, __ATOMIC_RELEASE );
+        pthread_cond_broadcast( &g_param.cond );
+        pthread_mutex_unlock( &g_param.lock );
+
+        pthread_join( g_param.thread, NULL );
+        g_param.running = 0;
+    }
+
     return;
 }
 
 
 /**************************************************************************//*!
- * @brief     CW に 1 Step 移動する。
+ * @brief     台形加減速の加速テーブルを作成する。
  * @attention なし。
- * @note      なし。
+ * @note      加速度一定で vmin から vmax まで加速する。s step 目に達する時刻は
+ *            s = vmin * t + accel * t^2 / 2 を t について解いて求める。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    加速区間の step 数
+ *************************************************************************** */
+static unsigned int
+BuildTrapezoid(
+    const SHalMotorSTProfile_t* profile,    ///< [in]  加減速プロファイル
+    unsigned int*               ramp        ///< [out] step 間隔のテーブル ( RAMP_NUM 個 )
+){
+    double          v0 = profile->vmin;
+    double          a  = profile->accel;
+    double          t0 = 0.0;
+    double          t1 = 0.0;
+    unsigned int    i  = 0;
+
+    for( i = 0; i < RAMP_NUM; i++ )
+    {
+        t1 = ( sqrt( v0 * v0 + 2.0 * a * ( i + 1 ) ) - v0 ) / a;
+        if( 1.0 / ( t1 - t0 ) >= profile->vmax )
+        {
+            break;
+        }
+
+        ramp[i] = ( t1 - t0 ) * NSEC_PER_SEC;
+        t0 = t1;
+    }
+
+    return i;
+}
+
+
+/**************************************************************************//*!
+ * @brief     S 字加減速の加速テーブルを作成する。
+ * @attention なし。
+ * @note      加加速度 jerk で加速度を accel まで上げ、加速度一定で加速した後、
+ *            加加速度 -jerk で加速度を 0 に戻して vmax に達する。
+ *            vmax - vmin が小さく accel に達しない場合は、加速度の最大値を下げる。
+ *            位置を RAMP_DT 刻みで積分し、各 step に達した時刻から間隔を求める。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    加速区間の step 数
+ *************************************************************************** */
+static unsigned int
+BuildSCurve(
+    const SHalMotorSTProfile_t* profile,    ///< [in]  加減速プロファイル
+    unsigned int*               ramp        ///< [out] step 間隔のテーブル ( RAMP_NUM 個 )
+){
+    double          dv = profile->vmax - profile->vmin;
+    double          j  = profile->jerk;
+    double          ap = profile->accel;    // 加速度の最大値
+    double          tj = 0.0;               // 加速度を変化させる時間
+    double          ta = 0.0;               // 加速度一定の時間
+    double          tt = 0.0;               // 加速にかかる時間
+    double          t  = 0.0;
+    double          a  = 0.0;
+    double          v  = profile->vmin;
+    double          s  = 0.0;
+    double          prev = 0.0;
+    unsigned int    i  = 0;
+
+    if( dv * j < ap * ap )
+    {
+        ap = sqrt( dv * j );
+    }
+    tj = ap / j;
+    ta = dv / ap - tj;
+    tt = 2.0 * tj + ta;
+
+    while( i < RAMP_NUM && t < tt )
+    {
+        if(      t < tj      ){ a = j * t;          }
+        else if( t < tj + ta ){ a = ap;             }
+        else                  { a = j * ( tt - t ); }
+
+        v += a * RAMP_DT;
+        s += v * RAMP_DT;
+        t += RAMP_DT;
+
+        if( s >= i + 1 )
+        {
+            ramp[i++] = ( t - prev ) * NSEC_PER_SEC;
+            prev = t;
+        }
+    }
+
+    return i;
+}
+
+
+/**************************************************************************//*!
+ * @brief     加減速プロファイルを設定する。
+ * @attention 移動中 ( キューに移動要求がある間 ) は変更できない。
+ * @note      加速区間の step 間隔のテーブルをここで計算しておき、ステップ生成スレッドは
+ *            1 step ごとにテーブルを引くだけにする。減速区間は加速テーブルを逆順に使う。
+ *            加速が RAMP_NUM step で vmax に達しない場合は、到達した速度で定速とする。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+HalMotorST_SetProfile(
+    const SHalMotorSTProfile_t* profile     ///< [in] 加減速プロファイル
+){
+    EHalBool_t      ret = EN_FALSE;
+    unsigned int    num = 0;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    if( profile == NULL || profile->vmax <= 0.0
+     || ( profile->type != EN_ST_PROFILE_CONST
+       && ( profile->vmin <= 0.0 || profile->vmin > profile->vmax || profile->accel <= 0.0 ) )
+     || ( profile->type == EN_ST_PROFILE_SCURVE && profile->jerk <= 0.0 ) )
+    {
+        DBG_PRINT_ERROR( "invalid argument error. \n\r" );
+        return ret;
+    }
+
+    pthread_mutex_lock( &g_param.lock );
+    if( g_param.head != g_param.tail )
+    {
+        pthread_mutex_unlock( &g_param.lock );
+        DBG_PRINT_ERROR( "stepper is moving. \n\r" );
+        return ret;
+    }
+
+    if(      profile->type == EN_ST_PROFILE_TRAPEZOID ){ num = BuildTrapezoid( profile, g_param.ramp ); }
+    else if( profile->type == EN_ST_PROFILE_SCURVE    ){ num = BuildSCurve( profile, g_param.ramp );    }
+    else                                               { num = 0;                                       }
+
+    g_param.rampNum = num;
+    if( num == RAMP_NUM )
+    {
+        g_param.cruise = g_param.ramp[num - 1];
+    } else
+    {
+        g_param.cruise = NSEC_PER_SEC / profile->vmax;
+    }
+
+    DBG_PRINT_DEBUG( "ramp = %u step, cruise = %u nsec \n\r", g_param.rampNum, g_param.cruise );
+
+    pthread_mutex_unlock( &g_param.lock );
+
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     励磁パターンを出力する。
+ * @attention ステップ生成スレッドからのみ呼ぶこと。
+ * @note      4 端子を HalCmnGpio_WriteMask() でまとめて切り替え、相の切り替わりのずれをなくす。
  * @sa        なし。
  * @author    Ryoji Morita
  * @return    なし。
  *************************************************************************** */
 static void
-StepCw(
-    void  ///< [in] ナシ
+Output(
+    unsigned int    out     ///< [in] 出力 ( g_pin の順のビットマスク )
 ){
-//    DBG_PRINT_TRACE( "\n\r" );
-    digitalWrite( MOTOR_OUT_A1, EN_HIGH );
-    usleep( 5 * 1000 );
-    digitalWrite( MOTOR_OUT_A1, EN_LOW );
-
-    digitalWrite( MOTOR_OUT_B1, EN_HIGH );
-    usleep( 5 * 1000 );
-    digitalWrite( MOTOR_OUT_B1, EN_LOW );
-
-    digitalWrite( MOTOR_OUT_A2, EN_HIGH );
-    usleep( 5 * 1000 );
-    digitalWrite( MOTOR_OUT_A2, EN_LOW );
-
-    digitalWrite( MOTOR_OUT_B2, EN_HIGH );
-    usleep( 5 * 1000 );
-    digitalWrite( MOTOR_OUT_B2, EN_LOW );
+    unsigned int    mask = 0;
+    unsigned int    value = 0;
+    int             i;
+
+    for( i = 0; i < PIN_NUM; i++ )
+    {
+        mask |= ( 1U << g_pin[i] );
+        if( out & ( 1 << i ) ){ value |= ( 1U << g_pin[i] ); }
+    }
+
+    HalCmnGpio_WriteMask( mask, value );
+    g_param.out = out;
     return;
 }
 
 
 /**************************************************************************//*!
- * @brief     CCW に 1 Step 移動する。
- * @attention なし。
- * @note      なし。
+ * @brief     1 Step 進める。
+ * @attention ステップ生成スレッドからのみ呼ぶこと。
+ * @note      位置を進めて、対応する励磁パターンを出力する。
+ *            1-2 相励磁は 1 マイクロ・ステップずつ、1 相 / 2 相励磁は 2 マイクロ・ステップずつ進める。
+ *            励磁方式を切り替えた直後で位置の偶奇が合わない場合は、1 つだけ進めて合わせる。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    進めたマイクロ・ステップ数 ( CW = 正, CCW = 負 )
+ *************************************************************************** */
+static int
+Step(
+    int     dir     ///< [in] 方向 ( CW = 1, CCW = -1 )
+){
+    int         parity = ( g_param.mode == EN_ST_STEP_TWO_PHASE ) ? 1 : 0;
+    long long   pos = g_param.pos;
+
+    if( g_param.mode != EN_ST_STEP_HALF && ( ( g_param.seqOfs + pos ) & 1 ) == parity )
+    {
+        dir *= 2;
+    }
+
+    pos += dir;
+    Output( g_seq[( g_param.seqOfs + pos ) & ( SEQ_NUM - 1 )] );
+    __atomic_store_n( &g_param.pos, pos, __ATOMIC_RELEASE );
+    return dir;
+}
+
+
+/**************************************************************************//*!
+ * @brief     励磁を解除する。
+ * @attention ステップ生成スレッドからのみ呼ぶこと。
+ * @note      テーブルの位置は保持するため、次の移動は同じ位置から再開する。
  * @sa        なし。
  * @author    Ryoji Morita
  * @return    なし。
  *************************************************************************** */
 static void
-StepCcw(
+Release(
     void  ///< [in] ナシ
 ){
-//    DBG_PRINT_TRACE( "\n\r" );
-    digitalWrite( MOTOR_OUT_B2, EN_HIGH );
-    usleep( 5 * 1000 );
-    digitalWrite( MOTOR_OUT_B2, EN_LOW );
-
-    digitalWrite( MOTOR_OUT_A2, EN_HIGH );
-    usleep( 5 * 1000 );
-    digitalWrite( MOTOR_OUT_A2, EN_LOW );
-
-    digitalWrite( MOTOR_OUT_B1, EN_HIGH );
-    usleep( 5 * 1000 );
-    digitalWrite( MOTOR_OUT_B1, EN_LOW );
-
-    digitalWrite( MOTOR_OUT_A1, EN_HIGH );
-    usleep( 5 * 1000 );
-    digitalWrite( MOTOR_OUT_A1, EN_LOW );
+    Output( 0 );
     return;
 }
 
 
 /**************************************************************************//*!
- * @brief     ステッピング・モータの状態と回転する角度をセットする。
- * @note      なし。
+ * @brief     励磁方式を設定する。
+ * @attention 移動中 ( キューに移動要求がある間 ) は変更できない。
+ * @note      1-2 相励磁では 1 Step の角度が半分になり、同じ回転角度の step 数は 2 倍になる。
+ *            加減速プロファイルの速度 ( step/s ) もこの step 単位となる。
  * @sa        なし。
  * @author    Ryoji Morita
- * @return    なし。
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
  *************************************************************************** */
-void
-HalMotorST_SetPosition(
-    EHalMotorState_t  status, ///< [in] モータの状態
-    int               deg     ///< [in] 回転角度
+EHalBool_t
+HalMotorST_SetStepMode(
+    EHalMotorSTStep_t   mode    ///< [in] 励磁方式
 ){
-    static  int       cnt = 1;    // 回転角度の誤差を修正するためのカウンタ
-                                  // この関数が 3 回呼ばれるたびに value の値を + PULSE_ERROR して回転角度の誤差を正す
-    unsigned int      value = 0;
+    EHalBool_t      ret = EN_FALSE;
 
-    DBG_PRINT_TRACE( "dir = %d \n\r", status );
-    DBG_PRINT_TRACE( "deg = %d \n\r", deg );
+    DBG_PRINT_TRACE( "mode = %d \n\r", mode );
 
-    value = PULSE_ANGLE_360 * deg / 360 / 4;
+    if( mode != EN_ST_STEP_WAVE && mode != EN_ST_STEP_TWO_PHASE && mode != EN_ST_STEP_HALF )
+    {
+        DBG_PRINT_ERROR( "invalid argument error. \n\r" );
+        return ret;
+    }
 
-    cnt = ( cnt + 1 ) % 3;
-    if( cnt == 0 )
+    pthread_mutex_lock( &g_param.lock );
+    if( g_param.head != g_param.tail )
     {
-        value += PULSE_ERROR;
+        pthread_mutex_unlock( &g_param.lock );
+        DBG_PRINT_ERROR( "stepper is moving. \n\r" );
+        return ret;
     }
 
-    if( status == EN_MOTOR_STANDBY )
+    g_param.mode = mode;
+    pthread_mutex_unlock( &g_param.lock );
+
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     四捨五入つきの整数除算を行う。
+ * @attention den は正であること。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    num / den を四捨五入した値
+ *************************************************************************** */
+static long long
+DivRound(
+    long long   num,    ///< [in] 被除数
+    long long   den     ///< [in] 除数
+){
+    if( num >= 0 ){ return ( num + den / 2 ) / den; }
+    else          { return -( ( -num + den / 2 ) / den ); }
+}
+
+
+/**************************************************************************//*!
+ * @brief     角度を、現在の励磁方式で停止できる位置に変換する。
+ * @attention ロックを取ってから呼ぶこと。
+ * @note      角度 ( ミリ度 ) から毎回整数演算で求めるため、移動を繰り返しても誤差が累積しない。
+ *            1 相励磁は励磁パターンの偶数、2 相励磁は奇数の位置にだけ停止できるため、
+ *            その中で最も近い位置に丸める。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    位置 ( 単位: マイクロ・ステップ )
+ *************************************************************************** */
+static long long
+ToUstep(
+    long long   mdeg    ///< [in] 角度 ( 単位: ミリ度 )
+){
+    int         parity = ( g_param.mode == EN_ST_STEP_TWO_PHASE ) ? 1 : 0;
+
+    parity ^= ( g_param.seqOfs & 1 );
+    if( g_param.mode == EN_ST_STEP_HALF )
     {
+        return DivRound( mdeg * USTEP_360, MDEG_360 );
+    }
+
+    return 2 * DivRound( mdeg * USTEP_360 - parity * MDEG_360, 2 * MDEG_360 ) + parity;
+}
+
 
-    } else if( status == EN_MOTOR_BRAKE )
+/**************************************************************************//*!
+ * @brief     指定したマイクロ・ステップ数だけ進める。
+ * @attention ステップ生成スレッドからのみ呼ぶこと。
+ * @note      clock_nanosleep() の絶対時刻指定で 1 相ごとの期限を決めるため、
+ *            GPIO 出力の処理時間による周期のずれが累積しない。
+ *            step 間隔は加速テーブル → 定速 → 加速テーブルの逆順の順に引く。
+ *            移動量が加速 + 減速に足りない場合は、半分ずつを加速と減速に使う。
+ * @sa        HalMotorST_SetProfile()
+ * @author    Ryoji Morita
+ * @return    進めたマイクロ・ステップ数
+ *************************************************************************** */
+static int
+RunMove(
+    int     ustep   ///< [in] 移動量 ( 単位: マイクロ・ステップ, CW = 正, CCW = 負 )
+){
+    int                 dir = ( ustep < 0 ) ? -1 : 1;
+    unsigned int        rest = ( ustep < 0 ) ? -ustep : ustep;
+    unsigned int        num = 0;
+    unsigned int        ramp = g_param.rampNum;
+    unsigned int        i = 0;
+    unsigned long long  next = HalTime_GetMonotonicNs();
+    struct timespec     ts;
+
+    // step 数 : 1 相 / 2 相励磁は 2 マイクロ・ステップずつ ( 偶奇合わせの 1 step を含む )
+    num = ( g_param.mode == EN_ST_STEP_HALF ) ? rest : ( rest + 1 ) / 2;
+    if( ramp > num / 2 )
     {
+        ramp = num / 2;
+    }
 
-    } else  if( status == EN_MOTOR_CCW )
+    for( i = 0; i < num && rest > 0; i++ )
     {
-        while( value-- )
+        if( __atomic_load_n( &g_param.abort, __ATOMIC_ACQUIRE ) )
         {
-            StepCcw();
+            break;
         }
-    } else if( status == EN_MOTOR_CW )
+
+        rest -= Step( dir ) * dir;
+
+        if(      i <  ramp       ){ next += g_param.ramp[i];           }
+        else if( i >= num - ramp ){ next += g_param.ramp[num - 1 - i]; }
+        else                      { next += g_param.cruise;            }
+
+        ts.tv_sec  = next / NSEC_PER_SEC;
+        ts.tv_nsec = next % NSEC_PER_SEC;
+        while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL ) != 0 )
+        {
+            ;   // シグナルで中断された場合は再度待つ
+        }
+    }
+
+    Release();
+    return ( ustep < 0 ? -ustep : ustep ) - rest;
+}
+
+
+/**************************************************************************//*!
+ * @brief     ステップ生成スレッド。
+ * @attention なし。
+ * @note      キューから移動要求を 1 つずつ取り出して実行し、完了を通知する。
+ *            移動量は取り出したときの現在位置から求めるため、中止で途中で止まった後の移動も移動先に正しく着く。
+ *            中止要求があった場合は、中止対象の移動をすべて完了扱いにし、
+ *            指令位置を現在位置 ( 残った移動があればその移動先 ) に合わせ直す。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    NULL
+ *************************************************************************** */
+static void*
+StepGen(
+    void*       arg     ///< [in] ナシ
+){
+    SHalMotorSTMove_t   move;
+    long long           ustep = 0;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    pthread_mutex_lock( &g_param.lock );
+    while( !g_param.stop )
     {
-        while( value-- )
+        if( g_param.abort )
         {
-            StepCw();
+            while( g_param.head != g_param.tail
+                && (int)( g_param.abortId - g_param.queue[g_param.head % MOVE_QUEUE_NUM].id ) >= 0 )
+            {
+                g_param.doneId = g_param.queue[g_param.head % MOVE_QUEUE_NUM].id;
+                g_param.head++;
+            }
+
+            g_param.plan = ( g_param.head != g_param.tail )
+                         ? g_param.queue[( g_param.tail - 1 ) % MOVE_QUEUE_NUM].to
+                         : g_param.pos;
+            g_param.target = DivRound( g_param.plan * MDEG_360, USTEP_360 );
+            __atomic_store_n( &g_param.abort, 0, __ATOMIC_RELEASE );
+            pthread_cond_broadcast( &g_param.cond );
+            continue;
         }
-    } else if( status == EN_MOTOR_STOP )
+
+        if( g_param.head == g_param.tail )
+        {
+            pthread_cond_wait( &g_param.cond, &g_param.lock );
+            continue;
+        }
+
+        move  = g_param.queue[g_param.head % MOVE_QUEUE_NUM];
+        ustep = move.to - g_param.pos;
+        pthread_mutex_unlock( &g_param.lock );
+
+        RunMove( (int)ustep );
+
+        pthread_mutex_lock( &g_param.lock );
+        g_param.head++;
+        g_param.doneId = move.id;
+        pthread_cond_broadcast( &g_param.cond );
+    }
+
+    g_param.head   = g_param.tail;
+    g_param.doneId = g_param.nextId - 1;
+    __atomic_store_n( &g_param.abort, 0, __ATOMIC_RELEASE );
+    pthread_cond_broadcast( &g_param.cond );
+    pthread_mutex_unlock( &g_param.lock );
+    return NULL;
+}
+
+
+/**************************************************************************//*!
+ * @brief     指令角度への移動をキューに追加する。
+ * @attention ロックを取ってから呼ぶこと。
+ * @note      キューには移動先の位置を格納し、移動量はステップ生成スレッドが取り出したときに求める。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    移動のハンドル ( 失敗時 0 )
+ *************************************************************************** */
+static unsigned int
+Enqueue(
+    long long   target  ///< [in] 指令角度 ( 単位: ミリ度 )
+){
+    unsigned int    id = 0;
+    long long       ustep = ToUstep( target );
+
+    if( g_param.tail - g_param.head >= MOVE_QUEUE_NUM )
     {
+        DBG_PRINT_ERROR( "move queue is full. \n\r" );
+        return id;
+    }
 
-    } else
+    id = g_param.nextId++;
+    if( g_param.nextId == 0 )
     {
-        ;
+        g_param.nextId = 1;     // 0 は失敗を表すため使わない
     }
 
+    g_param.queue[g_param.tail % MOVE_QUEUE_NUM].id    = id;
+    g_param.queue[g_param.tail % MOVE_QUEUE_NUM].to    = ustep;
+    g_param.tail++;
+    g_param.plan   = ustep;
+    g_param.target = target;
+    pthread_cond_broadcast( &g_param.cond );
+
+    return id;
+}
+
+
+/**************************************************************************//*!
+ * @brief     ステッピング・モータの移動を要求する。
+ * @attention HalMotorST_Init() の後に呼ぶこと。
+ * @note      移動はステップ生成スレッドで実行され、この関数はすぐに戻る。
+ *            複数の移動を要求した場合は、要求した順に実行する。
+ *            指令角度に deg を加えた絶対角度へ移動するため、丸め誤差は累積しない。
+ * @sa        HalMotorST_IsDone(), HalMotorST_Wait()
+ * @author    Ryoji Morita
+ * @return    移動のハンドル ( 失敗時 0 )
+ *************************************************************************** */
+unsigned int
+HalMotorST_Move(
+    EHalMotorState_t  status, ///< [in] モータの状態
+    int               deg     ///< [in] 回転角度
+){
+    unsigned int      id = 0;
+    long long         target = 0;
+
+    DBG_PRINT_TRACE( "dir = %d \n\r", status );
+    DBG_PRINT_TRACE( "deg = %d \n\r", deg );
+
+    if( !g_param.running )
+    {
+        DBG_PRINT_ERROR( "step generator is not running. \n\r" );
+        return id;
+    }
+
+    pthread_mutex_lock( &g_param.lock );
+
+    target = g_param.target;
+    if(      status == EN_MOTOR_CCW ){ target -= (long long)deg * 1000; }
+    else if( status == EN_MOTOR_CW  ){ target += (long long)deg * 1000; }
+    else                             { ;                                }
+
+    id = Enqueue( target );
+
+    pthread_mutex_unlock( &g_param.lock );
+    return id;
+}
+
+
+/**************************************************************************//*!
+ * @brief     ステッピング・モータの絶対角度への移動を要求する。
+ * @attention HalMotorST_Init() の後に呼ぶこと。
+ * @note      角度は HalMotorST_SetOrigin() した位置を 0 とし、CW を正とする。
+ *            移動はステップ生成スレッドで実行され、この関数はすぐに戻る。
+ * @sa        HalMotorST_IsDone(), HalMotorST_Wait()
+ * @author    Ryoji Morita
+ * @return    移動のハンドル ( 失敗時 0 )
+ *************************************************************************** */
+unsigned int
+HalMotorST_MoveTo(
+    long            mdeg    ///< [in] 絶対角度 ( 単位: ミリ度 )
+){
+    unsigned int    id = 0;
+
+    DBG_PRINT_TRACE( "mdeg = %ld \n\r", mdeg );
+
+    if( !g_param.running )
+    {
+        DBG_PRINT_ERROR( "step generator is not running. \n\r" );
+        return id;
+    }
+
+    pthread_mutex_lock( &g_param.lock );
+    id = Enqueue( mdeg );
+    pthread_mutex_unlock( &g_param.lock );
+
+    return id;
+}
+
+
+/**************************************************************************//*!
+ * @brief     ステッピング・モータの現在位置を返す。
+ * @attention なし。
+ * @note      移動中でも呼んでよい。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    現在位置 ( 単位: ミリ度 )
+ *************************************************************************** */
+long
+HalMotorST_GetPosition(
+    void  ///< [in] ナシ
+){
+    long long   pos = __atomic_load_n( &g_param.pos, __ATOMIC_ACQUIRE );
+
+    return DivRound( pos * MDEG_360, USTEP_360 );
+}
+
+
+/**************************************************************************//*!
+ * @brief     現在位置を原点 ( 0 ミリ度 ) にする。
+ * @attention 移動中 ( キューに移動要求がある間 ) は設定できない。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+HalMotorST_SetOrigin(
+    void  ///< [in] ナシ
+){
+    EHalBool_t      ret = EN_FALSE;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    pthread_mutex_lock( &g_param.lock );
+    if( g_param.head != g_param.tail )
+    {
+        pthread_mutex_unlock( &g_param.lock );
+        DBG_PRINT_ERROR( "stepper is moving. \n\r" );
+        return ret;
+    }
+
+    // 励磁パターンの位置は変えずに、位置 0 をずらす
+    g_param.seqOfs = ( g_param.seqOfs + g_param.pos ) & ( SEQ_NUM - 1 );
+    __atomic_store_n( &g_param.pos, 0, __ATOMIC_RELEASE );
+    g_param.plan   = 0;
+    g_param.target = 0;
+    pthread_mutex_unlock( &g_param.lock );
+
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     移動が完了したか否かを返す。
+ * @attention なし。
+ * @note      中止された移動も完了として扱う。
+ * @sa        HalMotorST_Move()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 完了, EN_FALSE : 未完了
+ *************************************************************************** */
+EHalBool_t
+HalMotorST_IsDone(
+    unsigned int    id      ///< [in] 移動のハンドル
+){
+    EHalBool_t      ret = EN_FALSE;
+
+    pthread_mutex_lock( &g_param.lock );
+    if( (int)( g_param.doneId - id ) >= 0 )
+    {
+        ret = EN_TRUE;
+    }
+    pthread_mutex_unlock( &g_param.lock );
+
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     移動が完了するまで待つ。
+ * @attention なし。
+ * @note      なし。
+ * @sa        HalMotorST_Move()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalMotorST_Wait(
+    unsigned int    id      ///< [in] 移動のハンドル
+){
+    if( id == 0 )
+    {
+        return;
+    }
+
+    pthread_mutex_lock( &g_param.lock );
+    while( (int)( g_param.doneId - id ) < 0 )
+    {
+        pthread_cond_wait( &g_param.cond, &g_param.lock );
+    }
+    pthread_mutex_unlock( &g_param.lock );
+
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     実行中 / キュー内の移動をすべて中止する。
+ * @attention なし。
+ * @note      中止した移動は完了として扱う。この関数の後に要求した移動は中止しない。
+ *            ステップ生成スレッドがモータを止めて指令位置を停止位置に合わせ直すまで待つ ( 最大 1 step 間隔 )。
+ *            そのため、この関数の後の相対移動 ( HalMotorST_Move() ) は停止位置を基準にする。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalMotorST_Stop(
+    void  ///< [in] ナシ
+){
+    DBG_PRINT_TRACE( "\n\r" );
+
+    pthread_mutex_lock( &g_param.lock );
+    g_param.abortId = g_param.nextId - 1;
+    __atomic_store_n( &g_param.abort, 1, __ATOMIC_RELEASE );
+    pthread_cond_broadcast( &g_param.cond );
+    while( g_param.running && g_param.abort )
+    {
+        pthread_cond_wait( &g_param.cond, &g_param.lock );
+    }
+    pthread_mutex_unlock( &g_param.lock );
+
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     ステッピング・モータの状態と回転する角度をセットする。
+ * @note      移動が完了するまで戻らない。
+ * @sa        HalMotorST_Move()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalMotorST_SetPosition(
+    EHalMotorState_t  status, ///< [in] モータの状態
+    int               deg     ///< [in] 回転角度
+){
+    DBG_PRINT_TRACE( "dir = %d \n\r", status );
+    DBG_PRINT_TRACE( "deg = %d \n\r", deg );
+
+    HalMotorST_Wait( HalMotorST_Move( status, deg ) );
     return;
 }
 
@@ -285,4 +971,3 @@ HalMotorST_SetPosition(
 #ifdef __cplusplus
     }
 #endif
-
@@ -15,8 +15,6 @@
 //********************************************************
 /* include                                               */
 //********************************************************
-#include <wiringPi.h>
-
 #include "hal_cmn.h"
 #include "hal.h"
 
@@ -30,6 +28,8 @@
 /*! @def                                                 */
 //********************************************************
 #define MOTOR_OUT    (18)
+#define PWM_CLOCK    (3840)     ///< @def : PWM クロックの分周比 : カウンタ = 19.2MHz / 3840 = 5kHz
+#define PWM_RANGE    (100)      ///< @def : PWM の 1 周期のカウント数 : 周期 = 100 / 5kHz = 20 msec
 
 
 //********************************************************
@@ -41,13 +41,16 @@
 //********************************************************
 /*! @struct                                              */
 //********************************************************
-// なし
+typedef struct {
+    EHalMotorState_t    status;     // 最後に設定した状態
+    double              rate;       // 最後に設定したデューティ比 ( 単位: % )
+} SHalMotorParam_t;
 
 
 //********************************************************
 /* モジュールグローバル変数                              */
 //********************************************************
-// なし
+static SHalMotorParam_t g_param;
 
 
 //********************************************************
@@ -55,6 +58,8 @@
 //********************************************************
 static void         InitParam( void );
 static EHalBool_t   InitReg( void );
+static EHalBool_t   IsPwmFree( void );
+static void         Output( unsigned int value );
 
 
 
@@ -72,6 +77,9 @@ InitParam(
     void  ///< [in] ナシ
 ){
     DBG_PRINT_TRACE( "\n\r" );
+
+    g_param.status = EN_MOTOR_STANDBY;
+    g_param.rate   = 0.0;
     return;
 }
 
@@ -93,6 +101,63 @@ InitReg(
 }
 
 
+/**************************************************************************//*!
+ * @brief     PWM を DC モータと競合せずに出力できるか調べる。
+ * @attention なし。
+ * @note      PWM クロックの分周比と range は全 ch に共通。
+ *            DC モータが別の周波数で回っている間にサーボの設定に変えると、DC モータのデューティ比が変わってしまう。
+ * @sa        HalMotorDC_IsPwmFree
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 出力できる, EN_FALSE : DC モータと競合する
+ *************************************************************************** */
+static EHalBool_t
+IsPwmFree(
+    void  ///< [in] ナシ
+){
+    SHalPwmInfo_t       info;
+    SHalMotorState_t    dc;
+    SHalMotorState_t    dc2;
+
+    HalMotorDC_GetPwmInfo( &info );
+    if( info.clock == PWM_CLOCK && info.range == PWM_RANGE )
+    {
+        return EN_TRUE;
+    }
+
+    HalMotorDC_GetState( &dc );
+    HalMotorDC2_GetState( &dc2 );
+    if( dc.status  == EN_MOTOR_CW || dc.status  == EN_MOTOR_CCW
+     || dc2.status == EN_MOTOR_CW || dc2.status == EN_MOTOR_CCW )
+    {
+        return EN_FALSE;
+    }
+
+    return EN_TRUE;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PWM を出力する。
+ * @attention なし。
+ * @note      端子の機能 / PWM モード / クロック / レンジは HalCmnGpio / HalCmnPwm 側で設定済みの値と比べ、
+ *            変わったものだけを書き込む。定常状態ではデューティの書き込み 1 回だけになる。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Output(
+    unsigned int    value   ///< [in] デューティ ( カウント数 )
+){
+    HalCmnGpio_PinMode( MOTOR_OUT, EN_GPIO_PWM_OUTPUT );
+    HalCmnPwm_SetMode( EN_PWM_MODE_MS );
+    HalCmnPwm_SetClock( PWM_CLOCK );
+    HalCmnPwm_SetRange( PWM_RANGE );
+    HalCmnPwm_Write( MOTOR_OUT, value );
+    return;
+}
+
+
 /**************************************************************************//*!
  * @brief     サーボモータを初期化する。
  * @attention なし。
@@ -145,18 +210,18 @@ HalMotorSV_Fini(
  *              => 19.2MHz / clock(=3840) = 5kHz
  *            100 カウントアップで PWM 1 周期に設定
  *              => 0.2ms * cnt(=100) = 20ms (= 50Hz )
- * @sa        なし。
+ *            DC モータが別の周波数で回っている間は出力しない ( スタンバイは常に設定できる )。
+ * @sa        HalMotorDC_SetPwmFreq
  * @author    Ryoji Morita
- * @return    なし。
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗 ( DC モータと PWM が競合する )
  *************************************************************************** */
-void
+EHalBool_t
 HalMotorSV_SetPwmDuty(
     EHalMotorState_t    status, ///< [in] モータの状態
     int                 rate    ///< [in] デューティ比 : 0% ～ 100% まで
 ){
+    EHalBool_t          ret = EN_FALSE;
     unsigned int        value = 0;
-    unsigned int        clock = 3840;
-    unsigned int        cnt = 100;
 
     DBG_PRINT_TRACE( "status = %d \n\r", status );
     DBG_PRINT_TRACE( "rate   = %d%% \n\r", rate );
@@ -164,36 +229,52 @@ HalMotorSV_SetPwmDuty(
     // デューティ比 = value / range
     value = rate;
 
+    if( status != EN_MOTOR_STANDBY && EN_FALSE == IsPwmFree() )
+    {
+        DBG_PRINT_ERROR( "PWM is used by the DC motor. \n\r" );
+        return ret;
+    }
+
     if( status == EN_MOTOR_STANDBY )
     {
-        pinMode( MOTOR_OUT, OUTPUT );
-        digitalWrite( MOTOR_OUT, EN_LOW );
+        HalCmnGpio_PinMode( MOTOR_OUT, EN_GPIO_OUTPUT );
+        HalCmnGpio_Write( MOTOR_OUT, EN_LOW );
     } else if( status == EN_MOTOR_BRAKE )
     {
-        pinMode( MOTOR_OUT, PWM_OUTPUT );
-        pwmSetMode( PWM_MODE_MS );
-        pwmSetClock( clock );
-        pwmSetRange( cnt );
-        pwmWrite( MOTOR_OUT, 0 );
+        Output( 0 );
     } else if( status == EN_MOTOR_CCW || status == EN_MOTOR_CW )
     {
-        pinMode( MOTOR_OUT, PWM_OUTPUT );
-        pwmSetMode( PWM_MODE_MS );
-        pwmSetClock( clock );
-        pwmSetRange( cnt );
-        pwmWrite( MOTOR_OUT, value );
+        Output( value );
     } else if( status == EN_MOTOR_STOP )
     {
-        pinMode( MOTOR_OUT, PWM_OUTPUT );
-        pwmSetMode( PWM_MODE_MS );
-        pwmSetClock( clock );
-        pwmSetRange( cnt );
-        pwmWrite( MOTOR_OUT, 0 );
+        Output( 0 );
     } else
     {
-        ;
+        return ret;
     }
 
+    g_param.status = status;
+    g_param.rate   = (double)rate;
+
+    ret = EN_TRUE;
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     サーボモータの状態を取得する。
+ * @attention なし。
+ * @note      最後に設定した状態とデューティ比を返す。H/W にはアクセスしない。
+ * @sa        HalMotorSV_SetPwmDuty
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+HalMotorSV_GetState(
+    SHalMotorState_t*   state   ///< [out] モータの状態
+){
+    state->status = g_param.status;
+    state->rate   = g_param.rate;
     return;
 }
 
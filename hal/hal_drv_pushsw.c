@@ -17,7 +17,15 @@
 //********************************************************
 /* include                                               */
 //********************************************************
-#include <wiringPi.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
 
 #include "hal_cmn.h"
 #include "hal.h"
@@ -35,6 +43,19 @@
 #define PUSH_SW1_IN     (20)
 #define PUSH_SW2_IN     (21)
 
+#define PUSH_SW_NUM     (3)                 ///< @def : SW の数
+#define DEBOUNCE_NS     (30 * 1000000ULL)   ///< @def : 入力が安定したとみなすまでの時間 ( 単位: nsec )
+#define POLL_NS         (5 * 1000000ULL)    ///< @def : エッジ検出を使えない場合のポーリング周期 ( 単位: nsec )
+#define EVENT_QUEUE_NUM (32)                ///< @def : イベント・キューの段数
+#define NSEC_PER_SEC    (1000000000ULL)
+
+#define SYSFS_GPIO      "/sys/class/gpio"
+#define SYSFS_RETRY     (10)                ///< @def : export 後に属性ファイルの権限が設定されるまで待つ回数 ( 10 msec 単位 )
+
+// epoll に登録した fd の区別 ( 0 ～ PUSH_SW_NUM - 1 は SW の value ファイル )
+#define TAG_DEBOUNCE    (100)
+#define TAG_POLL        (101)
+
 
 //********************************************************
 /*! @enum                                                */
@@ -45,20 +66,52 @@
 //********************************************************
 /*! @struct                                              */
 //********************************************************
-// なし
+// SW 1 個分のチャタリング除去の状態
+typedef struct {
+    int                 fd;         // sysfs の value ファイル ( エッジ検出を使わない場合は -1 )
+    int                 exported;   // 1 = このモジュールが sysfs に export した ( 終了時に unexport する )
+    int                 stable;     // 確定した入力レベル
+    int                 pending;    // 確定待ちの入力レベル ( 確定待ちでない場合は -1 )
+    unsigned long long  since;      // 確定待ちの入力レベルに変化した時刻 ( 単位: nsec )
+} SHalPushSwState_t;
+
+typedef struct {
+    pthread_mutex_t     lock;
+    int                 epfd;       // epoll の fd
+    int                 tfdDebounce;// 確定待ちの期限を通知する timerfd
+    int                 tfdPoll;    // ポーリング周期を通知する timerfd ( エッジ検出を使う場合は -1 )
+    SHalPushSwState_t   sw[PUSH_SW_NUM];
+    SHalPushSwEvent_t   queue[EVENT_QUEUE_NUM];
+    unsigned int        head;       // 次に取り出す位置
+    unsigned int        tail;       // 次に追加する位置
+    unsigned int        lost;       // キューあふれで捨てたイベント数
+} SHalPushSw_t;
 
 
 //********************************************************
 /* モジュールグローバル変数                              */
 //********************************************************
-// なし
+static SHalPushSw_t     g_param = { PTHREAD_MUTEX_INITIALIZER, -1, -1, -1 };
+
+static const int        g_pin[PUSH_SW_NUM] = { PUSH_SW0_IN, PUSH_SW1_IN, PUSH_SW2_IN };
 
 
 //********************************************************
 /* 関数プロトタイプ宣言                                  */
 //********************************************************
-static void         InitParam( void );
-static EHalBool_t   InitReg( void );
+static void                 InitParam( void );
+static EHalBool_t           InitReg( void );
+static int                  WriteSysfs( const char* path, const char* value );
+static int                  OpenEdge( int which );
+static void                 CloseEdge( int which );
+static EHalBool_t           InitEdge( void );
+static EHalBool_t           InitPoll( void );
+static void                 ArmTimer( int fd, unsigned long long ns, unsigned long long interval );
+static int                  ReadLevel( int which );
+static void                 Feed( int which, int level, unsigned long long now );
+static void                 Commit( unsigned long long now );
+static void                 Process( int timeout );
+static void                 Push( const SHalPushSwEvent_t* ev );
 
 
 
@@ -75,7 +128,24 @@ static void
 InitParam(
     void  ///< [in] ナシ
 ){
+    int     i = 0;
+
     DBG_PRINT_TRACE( "\n\r" );
+
+    g_param.epfd        = -1;
+    g_param.tfdDebounce = -1;
+    g_param.tfdPoll     = -1;
+    for( i = 0; i < PUSH_SW_NUM; i++ )
+    {
+        g_param.sw[i].fd       = -1;
+        g_param.sw[i].exported = 0;
+        g_param.sw[i].stable   = 1;     // Active-Low なので 1 = 押されていない
+        g_param.sw[i].pending  = -1;
+        g_param.sw[i].since    = 0;
+    }
+    g_param.head = 0;
+    g_param.tail = 0;
+    g_param.lost = 0;
     return;
 }
 
@@ -94,27 +164,441 @@ InitReg(
 ){
     DBG_PRINT_TRACE( "\n\r" );
 
-    pinMode( PUSH_SW0_IN, INPUT );
-    pinMode( PUSH_SW1_IN, INPUT );
-    pinMode( PUSH_SW2_IN, INPUT );
+    HalCmnGpio_PinMode( PUSH_SW0_IN, EN_GPIO_INPUT );
+    HalCmnGpio_PinMode( PUSH_SW1_IN, EN_GPIO_INPUT );
+    HalCmnGpio_PinMode( PUSH_SW2_IN, EN_GPIO_INPUT );
 
     return EN_TRUE;
 }
 
 
 /**************************************************************************//*!
- * @brief     SW を初期化する。
+ * @brief     sysfs の属性ファイルに書き込む。
  * @attention なし。
  * @note      なし。
  * @sa        なし。
  * @author    Ryoji Morita
+ * @return    0 : 成功, -1 : 失敗 ( errno を保持 )
+ *************************************************************************** */
+static int
+WriteSysfs(
+    const char*     path,   ///< [in] 属性ファイルのパス
+    const char*     value   ///< [in] 書き込む文字列
+){
+    int     fd = -1;
+    int     num = 0;
+    int     err = 0;
+
+    fd = open( path, O_WRONLY );
+    if( fd < 0 )
+    {
+        return -1;
+    }
+
+    num = write( fd, value, strlen( value ) );
+    err = errno;
+    close( fd );
+    errno = err;
+
+    return ( num == (int)strlen( value ) ) ? 0 : -1;
+}
+
+
+/**************************************************************************//*!
+ * @brief     端子を sysfs に export して両エッジ検出を設定し、value ファイルを開く。
+ * @attention なし。
+ * @note      export 直後は udev が属性ファイルの権限を設定し終えていないことがあるので、
+ *            EACCES の場合に限り最大 SYSFS_RETRY 回 ( 100 msec ) 待って再試行する。
+ *            それ以外の失敗 ( エッジ検出に対応しない端子など ) はすぐに諦める。
+ *            失敗した場合、このモジュールが export した端子は unexport する。
+ * @sa        CloseEdge()
+ * @author    Ryoji Morita
+ * @return    value ファイルの fd ( 失敗時 -1 )
+ *************************************************************************** */
+static int
+OpenEdge(
+    int     which   ///< [in] SW の番号
+){
+    char    path[64];
+    char    value[16];
+    int     pin = g_pin[which];
+    int     fd = -1;
+    int     i = 0;
+
+    DBG_PRINT_TRACE( "pin = %d \n\r", pin );
+
+    snprintf( value, sizeof(value), "%d", pin );
+    if( WriteSysfs( SYSFS_GPIO "/export", value ) == 0 )
+    {
+        g_param.sw[which].exported = 1;
+    } else if( errno != EBUSY )     // EBUSY = export 済み
+    {
+        DBG_PRINT_ERROR( "Unable to export GPIO%d. : %s \n\r", pin, strerror( errno ) );
+        return -1;
+    }
+
+    snprintf( path, sizeof(path), SYSFS_GPIO "/gpio%d/edge", pin );
+    for( i = 0; WriteSysfs( path, "both" ) != 0; i++ )
+    {
+        if( !g_param.sw[which].exported || errno != EACCES || i >= SYSFS_RETRY )
+        {
+            DBG_PRINT_ERROR( "Unable to set edge of GPIO%d. : %s \n\r", pin, strerror( errno ) );
+            CloseEdge( which );
+            return -1;
+        }
+        usleep( 10 * 1000 );
+    }
+
+    snprintf( path, sizeof(path), SYSFS_GPIO "/gpio%d/value", pin );
+    fd = open( path, O_RDONLY | O_NONBLOCK | O_CLOEXEC );
+    if( fd < 0 )
+    {
+        DBG_PRINT_ERROR( "Unable to open GPIO%d value. : %s \n\r", pin, strerror( errno ) );
+        CloseEdge( which );
+    }
+
+    return fd;
+}
+
+
+/**************************************************************************//*!
+ * @brief     value ファイルを閉じ、このモジュールが export した端子を unexport する。
+ * @attention なし。
+ * @note      close() すると epoll の監視対象からも外れる。
+ * @sa        OpenEdge()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+CloseEdge(
+    int     which   ///< [in] SW の番号
+){
+    char    value[16];
+
+    if( g_param.sw[which].fd >= 0 )
+    {
+        close( g_param.sw[which].fd );
+        g_param.sw[which].fd = -1;
+    }
+
+    if( g_param.sw[which].exported )
+    {
+        snprintf( value, sizeof(value), "%d", g_pin[which] );
+        if( WriteSysfs( SYSFS_GPIO "/unexport", value ) != 0 )
+        {
+            DBG_PRINT_ERROR( "Unable to unexport GPIO%d. : %s \n\r", g_pin[which], strerror( errno ) );
+        }
+        g_param.sw[which].exported = 0;
+    }
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     全 SW の value ファイルを epoll に登録し、エッジ検出で入力を受け取る。
+ * @attention なし。
+ * @note      1 つでも失敗した場合は開いた fd を閉じ、export した端子を unexport して EN_FALSE を返す ( ポーリングで代用する )。
+ * @sa        InitPoll
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+InitEdge(
+    void  ///< [in] ナシ
+){
+    struct epoll_event  ev;
+    int                 i = 0;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    for( i = 0; i < PUSH_SW_NUM; i++ )
+    {
+        g_param.sw[i].fd = OpenEdge( i );
+        if( g_param.sw[i].fd < 0 )
+        {
+            break;
+        }
+
+        // sysfs の value ファイルはエッジで POLLPRI を通知する
+        memset( &ev, 0, sizeof(ev) );
+        ev.events   = EPOLLPRI | EPOLLERR;
+        ev.data.u32 = i;
+        if( epoll_ctl( g_param.epfd, EPOLL_CTL_ADD, g_param.sw[i].fd, &ev ) < 0 )
+        {
+            DBG_PRINT_ERROR( "epoll_ctl() error. : %s \n\r", strerror( errno ) );
+            CloseEdge( i );
+            break;
+        }
+    }
+
+    if( i < PUSH_SW_NUM )
+    {
+        for( i = 0; i < PUSH_SW_NUM; i++ )
+        {
+            CloseEdge( i );
+        }
+        return EN_FALSE;
+    }
+
+    return EN_TRUE;
+}
+
+
+/**************************************************************************//*!
+ * @brief     周期タイマを epoll に登録し、ポーリングで入力を受け取る。
+ * @attention なし。
+ * @note      シミュレータ・バックエンドや sysfs を使えない環境で使う。
+ *            呼び出し側を待たせないよう、ポーリングも epoll 経由で行う。
+ * @sa        InitEdge
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+InitPoll(
+    void  ///< [in] ナシ
+){
+    struct epoll_event  ev;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    g_param.tfdPoll = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC );
+    if( g_param.tfdPoll < 0 )
+    {
+        DBG_PRINT_ERROR( "timerfd_create() error. : %s \n\r", strerror( errno ) );
+        return EN_FALSE;
+    }
+
+    memset( &ev, 0, sizeof(ev) );
+    ev.events   = EPOLLIN;
+    ev.data.u32 = TAG_POLL;
+    if( epoll_ctl( g_param.epfd, EPOLL_CTL_ADD, g_param.tfdPoll, &ev ) < 0 )
+    {
+        DBG_PRINT_ERROR( "epoll_ctl() error. : %s \n\r", strerror( errno ) );
+        return EN_FALSE;
+    }
+
+    ArmTimer( g_param.tfdPoll, POLL_NS, POLL_NS );
+    return EN_TRUE;
+}
+
+
+/**************************************************************************//*!
+ * @brief     timerfd を設定する。
+ * @attention なし。
+ * @note      ns = 0 の場合はタイマを止める。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+ArmTimer(
+    int                 fd,         ///< [in] timerfd
+    unsigned long long  ns,         ///< [in] 最初の満了までの時間 ( 単位: nsec )
+    unsigned long long  interval    ///< [in] 以降の満了の周期 ( 単位: nsec ) : 0 = 1 回のみ
+){
+    struct itimerspec   its;
+
+    its.it_value.tv_sec     = ns / NSEC_PER_SEC;
+    its.it_value.tv_nsec    = ns % NSEC_PER_SEC;
+    its.it_interval.tv_sec  = interval / NSEC_PER_SEC;
+    its.it_interval.tv_nsec = interval % NSEC_PER_SEC;
+    timerfd_settime( fd, 0, &its, NULL );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     SW の入力レベルを読む。
+ * @attention なし。
+ * @note      エッジ検出を使う場合は value ファイルを先頭から読み直す ( 読むことでエッジの通知が解除される )。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    入力レベル ( 0 / 1 )
+ *************************************************************************** */
+static int
+ReadLevel(
+    int     which   ///< [in] SW の番号
+){
+    char    buf[4];
+
+    if( g_param.sw[which].fd >= 0 )
+    {
+        lseek( g_param.sw[which].fd, 0, SEEK_SET );
+        if( read( g_param.sw[which].fd, buf, sizeof(buf) ) > 0 )
+        {
+            return ( buf[0] == '0' ) ? 0 : 1;
+        }
+    }
+
+    return HalCmnGpio_Read( g_pin[which] ) ? 1 : 0;
+}
+
+
+/**************************************************************************//*!
+ * @brief     入力レベルの変化をチャタリング除去の状態に反映する。
+ * @attention g_param.lock を取得した状態で呼ぶこと。
+ * @note      確定レベルと異なるレベルが DEBOUNCE_NS 続いたときに確定する ( 確定は Commit() で行う )。
+ *            途中で確定レベルに戻った場合はチャタリングとみなして捨てる。
+ * @sa        Commit
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Feed(
+    int                 which,  ///< [in] SW の番号
+    int                 level,  ///< [in] 入力レベル
+    unsigned long long  now     ///< [in] 入力を読んだ時刻 ( 単位: nsec )
+){
+    SHalPushSwState_t*  sw = &g_param.sw[which];
+
+    if( level == sw->stable )
+    {
+        sw->pending = -1;
+    } else if( level != sw->pending )
+    {
+        sw->pending = level;
+        sw->since   = now;
+    }
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     確定待ちの期限を過ぎた入力を確定してイベントを発行し、次の期限のタイマを設定する。
+ * @attention g_param.lock を取得した状態で呼ぶこと。
+ * @note      イベントの時刻は、確定した時刻ではなく入力が変化した時刻とする。
+ * @sa        Feed
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Commit(
+    unsigned long long  now     ///< [in] 現在時刻 ( 単位: nsec )
+){
+    SHalPushSwState_t*  sw = NULL;
+    SHalPushSwEvent_t   ev;
+    unsigned long long  next = 0;
+    unsigned long long  deadline = 0;
+    int                 i = 0;
+
+    for( i = 0; i < PUSH_SW_NUM; i++ )
+    {
+        sw = &g_param.sw[i];
+        if( sw->pending < 0 )
+        {
+            continue;
+        }
+
+        deadline = sw->since + DEBOUNCE_NS;
+        if( now >= deadline )
+        {
+            sw->stable  = sw->pending;
+            sw->pending = -1;
+
+            // SW は Active-Low 回路なのでレベル 0 が押された状態
+            ev.which = (EHalPushSw_t)i;
+            ev.press = ( sw->stable == 0 ) ? EN_TRUE : EN_FALSE;
+            ev.time  = sw->since;
+            Push( &ev );
+        } else if( next == 0 || deadline < next )
+        {
+            next = deadline;
+        }
+    }
+
+    ArmTimer( g_param.tfdDebounce, ( next == 0 ) ? 0 : next - now, 0 );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     epoll で入力の変化とタイマを待ち、チャタリング除去の状態を更新する。
+ * @attention なし。
+ * @note      epoll_wait() の間はロックを取得しない。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Process(
+    int     timeout     ///< [in] 待ち時間 ( 単位: msec ) : 0 = 待たない, -1 = 無期限
+){
+    struct epoll_event  ev[PUSH_SW_NUM + 2];
+    unsigned long long  now = 0;
+    unsigned long long  expire = 0;
+    int                 num = 0;
+    int                 i = 0;
+    int                 j = 0;
+
+    num = epoll_wait( g_param.epfd, ev, PUSH_SW_NUM + 2, timeout );
+
+    pthread_mutex_lock( &g_param.lock );
+    now = HalTime_GetMonotonicNs();
+    for( i = 0; i < num; i++ )
+    {
+        if( ev[i].data.u32 < PUSH_SW_NUM )
+        {
+            Feed( ev[i].data.u32, ReadLevel( ev[i].data.u32 ), now );
+        } else if( ev[i].data.u32 == TAG_POLL )
+        {
+            if( read( g_param.tfdPoll, &expire, sizeof(expire) ) > 0 )
+            {
+                for( j = 0; j < PUSH_SW_NUM; j++ )
+                {
+                    Feed( j, ReadLevel( j ), now );
+                }
+            }
+        } else
+        {
+            read( g_param.tfdDebounce, &expire, sizeof(expire) );
+        }
+    }
+    Commit( now );
+    pthread_mutex_unlock( &g_param.lock );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     イベントをキューに追加する。
+ * @attention g_param.lock を取得した状態で呼ぶこと。
+ * @note      キューがあふれた場合は最も古いイベントを捨てる。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Push(
+    const SHalPushSwEvent_t*    ev  ///< [in] イベント
+){
+    if( g_param.tail - g_param.head >= EVENT_QUEUE_NUM )
+    {
+        g_param.head++;
+        g_param.lost++;
+        DBG_PRINT_WARN( "event queue overflow. (lost = %u) \n\r", g_param.lost );
+    }
+
+    g_param.queue[g_param.tail % EVENT_QUEUE_NUM] = *ev;
+    g_param.tail++;
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     SW を初期化する。
+ * @attention なし。
+ * @note      実機バックエンドでは sysfs のエッジ検出を使い、使えない場合はポーリングで代用する。
+ * @sa        なし。
+ * @author    Ryoji Morita
  * @return    EN_TRUE : 成功, EN_FALSE : 失敗
  *************************************************************************** */
 EHalBool_t
 HalPushSw_Init(
     void  ///< [in] ナシ
 ){
-    EHalBool_t      ret = EN_FALSE;
+    struct epoll_event  ev;
+    EHalBool_t          ret = EN_FALSE;
+    int                 i = 0;
 
     DBG_PRINT_TRACE( "\n\r" );
 
@@ -126,6 +610,41 @@ HalPushSw_Init(
         return ret;
     }
 
+    g_param.epfd        = epoll_create1( EPOLL_CLOEXEC );
+    g_param.tfdDebounce = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC );
+    if( g_param.epfd < 0 || g_param.tfdDebounce < 0 )
+    {
+        DBG_PRINT_ERROR( "Unable to create epoll / timerfd. : %s \n\r", strerror( errno ) );
+        HalPushSw_Fini();
+        return EN_FALSE;
+    }
+
+    memset( &ev, 0, sizeof(ev) );
+    ev.events   = EPOLLIN;
+    ev.data.u32 = TAG_DEBOUNCE;
+    if( epoll_ctl( g_param.epfd, EPOLL_CTL_ADD, g_param.tfdDebounce, &ev ) < 0 )
+    {
+        DBG_PRINT_ERROR( "epoll_ctl() error. : %s \n\r", strerror( errno ) );
+        HalPushSw_Fini();
+        return EN_FALSE;
+    }
+
+    if( HalCmn_GetBackendType() != EN_BACKEND_HW || InitEdge() == EN_FALSE )
+    {
+        ret = InitPoll();
+        if( ret == EN_FALSE )
+        {
+            HalPushSw_Fini();
+            return ret;
+        }
+    }
+
+    // 初期状態を確定レベルとする ( value ファイルを読んで初回の通知も解除する )
+    for( i = 0; i < PUSH_SW_NUM; i++ )
+    {
+        g_param.sw[i].stable = ReadLevel( i );
+    }
+
     ret = EN_TRUE;
     return ret;
 }
@@ -134,7 +653,7 @@ HalPushSw_Init(
 /**************************************************************************//*!
  * @brief     SW を終了する。
  * @attention なし。
- * @note      なし。
+ * @note      エッジ検出のために export した端子は unexport する。
  * @sa        なし。
  * @author    Ryoji Morita
  * @return    なし。
@@ -143,7 +662,29 @@ void
 HalPushSw_Fini(
     void  ///< [in] ナシ
 ){
+    int     i = 0;
+
     DBG_PRINT_TRACE( "\n\r" );
+
+    for( i = 0; i < PUSH_SW_NUM; i++ )
+    {
+        CloseEdge( i );
+    }
+    if( g_param.tfdPoll >= 0 )
+    {
+        close( g_param.tfdPoll );
+        g_param.tfdPoll = -1;
+    }
+    if( g_param.tfdDebounce >= 0 )
+    {
+        close( g_param.tfdDebounce );
+        g_param.tfdDebounce = -1;
+    }
+    if( g_param.epfd >= 0 )
+    {
+        close( g_param.epfd );
+        g_param.epfd = -1;
+    }
     return;
 }
 
@@ -151,8 +692,8 @@ HalPushSw_Fini(
 /**************************************************************************//*!
  * @brief     SW の入力を取得する。
  * @attention なし。
- * @note      なし。
- * @sa        なし。
+ * @note      待たずに、チャタリング除去で確定した状態を返す。
+ * @sa        HalPushSw_PollEvent
  * @author    Ryoji Morita
  * @return    EN_TRUE : SW が押されている, EN_FALSE : SW が押されていない
  *************************************************************************** */
@@ -160,34 +701,99 @@ EHalBool_t
 HalPushSw_Get(
     EHalPushSw_t    which   ///< [in] ターゲット SW
 ){
-    int             state = 0;
-    EHalBool_t      ret = 0;
+    EHalBool_t      ret = EN_FALSE;
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    switch( which )
+    if( which < EN_PUSH_SW_0 || which > EN_PUSH_SW_2 || g_param.epfd < 0 )
     {
-    case EN_PUSH_SW_0 : state = digitalRead( PUSH_SW0_IN ); break;
-    case EN_PUSH_SW_1 : state = digitalRead( PUSH_SW1_IN ); break;
-    case EN_PUSH_SW_2 : state = digitalRead( PUSH_SW2_IN ); break;
-    default           : break;
+        return ret;
     }
 
+    Process( 0 );
+
     // SW は Active-Low 回路なので state が 0 の時が
     // SW が押されているということになる
-    if( state == 0 )
+    pthread_mutex_lock( &g_param.lock );
+    ret = ( g_param.sw[which].stable == 0 ) ? EN_TRUE : EN_FALSE;
+    pthread_mutex_unlock( &g_param.lock );
+
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     SW の押下 / 解放イベントを 1 つ取り出す。
+ * @attention なし。
+ * @note      キューが空の場合は timeout まで待つ。timeout = 0 の場合は待たずに戻る。
+ * @sa        HalPushSw_GetFd
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : イベントを取り出した, EN_FALSE : イベントなし
+ *************************************************************************** */
+EHalBool_t
+HalPushSw_PollEvent(
+    SHalPushSwEvent_t*  event,      ///< [out] イベント
+    int                 timeout     ///< [in]  待ち時間 ( 単位: msec ) : 0 = 待たない, -1 = 無期限
+){
+    unsigned long long  end = HalTime_GetMonotonicNs() + (unsigned long long)( timeout > 0 ? timeout : 0 ) * 1000000ULL;
+    unsigned long long  now = 0;
+    EHalBool_t          ret = EN_FALSE;
+    int                 wait = timeout;
+
+    if( event == NULL || g_param.epfd < 0 )
     {
-        usleep( 150 * 1000 );   // チャタリング防止
-        ret = EN_TRUE;
-    } else
+        return ret;
+    }
+
+    while( 1 )
     {
-        ret = EN_FALSE;
+        Process( wait );
+
+        pthread_mutex_lock( &g_param.lock );
+        if( g_param.head != g_param.tail )
+        {
+            *event = g_param.queue[g_param.head % EVENT_QUEUE_NUM];
+            g_param.head++;
+            ret = EN_TRUE;
+        }
+        pthread_mutex_unlock( &g_param.lock );
+
+        if( ret == EN_TRUE || timeout == 0 )
+        {
+            break;
+        }
+        if( timeout > 0 )
+        {
+            now = HalTime_GetMonotonicNs();
+            if( now >= end )
+            {
+                break;
+            }
+            wait = (int)( ( end - now + 999999ULL ) / 1000000ULL );
+        }
     }
 
     return ret;
 }
 
 
+/**************************************************************************//*!
+ * @brief     SW のイベント待ちに使う fd を返す。
+ * @attention なし。
+ * @note      呼び出し側の poll / epoll に登録できる。読み込み可能になったら
+ *            HalPushSw_PollEvent( event, 0 ) でイベントを取り出すこと。
+ * @sa        HalPushSw_PollEvent
+ * @author    Ryoji Morita
+ * @return    epoll の fd ( 未初期化の場合は -1 )
+ *************************************************************************** */
+int
+HalPushSw_GetFd(
+    void  ///< [in] ナシ
+){
+    return g_param.epfd;
+}
+
+
 #ifdef __cplusplus
     }
 #endif
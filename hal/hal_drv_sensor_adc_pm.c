@@ -176,7 +176,7 @@ HalSensorPm_Fini(
 /**************************************************************************//*!
  * @brief     センサ変数のアドレスを返す。
  * @attention なし。
- * @note      なし。
+ * @note      HalCmnSpiMcp3208_StreamStart() で ch 7 をサンプリング中の場合は、その最新値を使う。
  * @sa        なし。
  * @author    Ryoji Morita
  * @return    センサ変数のアドレス
@@ -189,7 +189,11 @@ HalSensorPm_Get(
 
     DBG_PRINT_TRACE( "\n\r" );
 
-    data = HalCmnSpiMcp3208_Get( EN_MCP3208_CH_7 );
+    // サンプラが動作中なら SPI バスにアクセスせず最新のサンプルを使う
+    if( EN_FALSE == HalCmnSpiMcp3208_StreamLatest( EN_MCP3208_CH_7, &data ) )
+    {
+        data = HalCmnSpiMcp3208_Get( EN_MCP3208_CH_7 );
+    }
 
     HalCmn_UpdateSenData( &g_data, (double)data );
 
@@ -31,7 +31,7 @@
 //********************************************************
 /*! @def                                                 */
 //********************************************************
-// なし
+#define NSEC_PER_SEC    (1000000000ULL)
 
 
 //********************************************************
@@ -43,7 +43,11 @@
 //********************************************************
 /*! @struct                                              */
 //********************************************************
-// なし
+// 秒単位の変換結果のキャッシュ
+typedef struct {
+    time_t          sec;    // 変換した時刻 ( 単位: sec ) : -1 = 未変換
+    struct tm       tm;     // 変換結果
+} SHalTimeCache_t;
 
 
 //********************************************************
@@ -51,12 +55,17 @@
 //********************************************************
 static SHalTime_t   g_data;
 
+// スレッドごとに持つので、ロックなしで参照 / 更新できる
+static __thread SHalTimeCache_t g_local = { -1 };
+static __thread SHalTimeCache_t g_utc   = { -1 };
+
 
 //********************************************************
 /* 関数プロトタイプ宣言                                  */
 //********************************************************
 static void         InitParam( void );
 static EHalBool_t   InitReg( void );
+static EHalBool_t   Convert( SHalTime_t* date, EHalBool_t local );
 
 
 
@@ -135,59 +144,74 @@ HalTime_Init(
 
 
 /**************************************************************************//*!
- * @brief     時間変数のアドレスを返す。( 地方時 ( Local time ) )
+ * @brief     現在時刻を時間変数に変換する。
  * @attention なし。
- * @note      なし。
+ * @note      CLOCK_REALTIME を読み、秒未満は msec / usec に入れる。
+ *            localtime_r() / gmtime_r() は秒が変わったときだけ呼び、同じ秒の間はキャッシュを使う。
  * @sa        なし。
  * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Convert(
+    SHalTime_t*     date,   ///< [out] 時間変数
+    EHalBool_t      local   ///< [in]  EN_TRUE : 地方時, EN_FALSE : UTC
+){
+    SHalTimeCache_t*    cache = ( local == EN_TRUE ) ? &g_local : &g_utc;
+    struct timespec     ts;
+    struct tm*          res = NULL;
+
+    clock_gettime( CLOCK_REALTIME, &ts );
+
+    if( cache->sec != ts.tv_sec )
+    {
+        res = ( local == EN_TRUE ) ? localtime_r( &ts.tv_sec, &cache->tm )
+                                   : gmtime_r( &ts.tv_sec, &cache->tm );
+        if( res == NULL )
+        {
+            cache->sec = -1;
+            return EN_FALSE;
+        }
+        cache->sec = ts.tv_sec;
+    }
+
+    date->wait  = 0;
+    date->usec  = ( ts.tv_nsec / 1000 ) % 1000;
+    date->msec  = ts.tv_nsec / 1000000;
+    date->sec   = cache->tm.tm_sec;
+    date->min   = cache->tm.tm_min;
+    date->hour  = cache->tm.tm_hour;
+    date->day   = cache->tm.tm_mday;
+    date->month = cache->tm.tm_mon + 1;
+    date->year  = cache->tm.tm_year + 1900;
+    return EN_TRUE;
+}
+
+
+/**************************************************************************//*!
+ * @brief     時間変数のアドレスを返す。( 地方時 ( Local time ) )
+ * @attention 全スレッドで共有する変数を返すので、複数スレッドからは HalTime_GetLocaltimeR() を使うこと。
+ * @note      なし。
+ * @sa        HalTime_GetLocaltimeR
+ * @author    Ryoji Morita
  * @return    時間変数のアドレス
  *************************************************************************** */
 SHalTime_t*
 HalTime_GetLocaltime(
     void  ///< [in] ナシ
 ){
-    time_t      timer;
-    struct tm*  local;
-
     DBG_PRINT_TRACE( "\n\r" );
 
-    // 現在時刻を取得
-    timer = time( NULL );
-
-     // 地方時に変換
-    local = localtime( &timer );
-
-    g_data.wait  = 0;
-    g_data.usec  = 0;
-    g_data.msec  = 0;
-    g_data.sec   = local->tm_sec;
-    g_data.min   = local->tm_min;
-    g_data.hour  = local->tm_hour;
-    g_data.day   = local->tm_mday;
-    g_data.month = local->tm_mon + 1;
-    g_data.year  = local->tm_year + 1900;
-
-#if 0
-    // 表示
-    AppIfPc_Printf( "local time : " );
-    AppIfPc_Printf( "%04d/", g_data.year  );
-    AppIfPc_Printf( "%02d/", g_data.month );
-    AppIfPc_Printf( "%02d ", g_data.day   );
-    AppIfPc_Printf( "%02d:", g_data.hour  );
-    AppIfPc_Printf( "%02d:", g_data.min   );
-    AppIfPc_Printf( "%02d" , g_data.sec   );
-    AppIfPc_Printf( "\n" );
-#endif
-
+    Convert( &g_data, EN_TRUE );
     return &g_data;
 }
 
 
 /**************************************************************************//*!
  * @brief     時間変数のアドレスを返す。( 協定世界時 ( UTC ) )
- * @attention なし。
+ * @attention 全スレッドで共有する変数を返すので、複数スレッドからは HalTime_GetUTCR() を使うこと。
  * @note      なし。
- * @sa        なし。
+ * @sa        HalTime_GetUTCR
  * @author    Ryoji Morita
  * @return    時間変数のアドレス
  *************************************************************************** */
@@ -195,40 +219,62 @@ SHalTime_t*
 HalTime_GetUTC(
     void  ///< [in] ナシ
 ){
-    time_t      timer;
-    struct tm*  utc;
-
     DBG_PRINT_TRACE( "\n\r" );
 
-    // 現在時刻を取得
-    timer = time( NULL );
+    Convert( &g_data, EN_FALSE );
+    return &g_data;
+}
 
-     // UTC に変換
-    utc = gmtime( &timer );
 
-    g_data.wait  = 0;
-    g_data.usec  = 0;
-    g_data.msec  = 0;
-    g_data.sec   = utc->tm_sec;
-    g_data.min   = utc->tm_min;
-    g_data.hour  = utc->tm_hour;
-    g_data.day   = utc->tm_mday;
-    g_data.month = utc->tm_mon + 1;
-    g_data.year  = utc->tm_year + 1900;
-
-#if 0
-    // 表示
-    AppIfPc_Printf( "UTC : " );
-    AppIfPc_Printf( "%04d/", g_data.year  );
-    AppIfPc_Printf( "%02d/", g_data.month );
-    AppIfPc_Printf( "%02d ", g_data.day   );
-    AppIfPc_Printf( "%02d:", g_data.hour  );
-    AppIfPc_Printf( "%02d:", g_data.min   );
-    AppIfPc_Printf( "%02d" , g_data.sec   );
-    AppIfPc_Printf( "\n" );
-#endif
+/**************************************************************************//*!
+ * @brief     地方時 ( Local time ) を呼び出し側の時間変数に格納する。
+ * @attention なし。
+ * @note      リエントラント。msec / usec まで格納する。
+ * @sa        HalTime_GetLocaltime
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+HalTime_GetLocaltimeR(
+    SHalTime_t*     date    ///< [out] 時間変数
+){
+    return Convert( date, EN_TRUE );
+}
 
-    return &g_data;
+
+/**************************************************************************//*!
+ * @brief     協定世界時 ( UTC ) を呼び出し側の時間変数に格納する。
+ * @attention なし。
+ * @note      リエントラント。msec / usec まで格納する。
+ * @sa        HalTime_GetUTC
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+HalTime_GetUTCR(
+    SHalTime_t*     date    ///< [out] 時間変数
+){
+    return Convert( date, EN_FALSE );
+}
+
+
+/**************************************************************************//*!
+ * @brief     CLOCK_MONOTONIC の現在時刻を返す。
+ * @attention なし。
+ * @note      時刻合わせの影響を受けないので、サンプリングや出力のタイムスタンプ、周期の計測に使う。
+ *            HalTime_Init() を呼ぶ前でも使える。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    現在時刻 ( 単位: nsec )
+ *************************************************************************** */
+unsigned long long
+HalTime_GetMonotonicNs(
+    void  ///< [in] ナシ
+){
+    struct timespec     ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (unsigned long long)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
 }
 
 
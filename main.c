@@ -22,8 +22,14 @@
 #include <string.h>
 #include <stdio.h>
 #include <getopt.h>
+#include <time.h>
+#include <unistd.h>
 
+#include "./app/cmd/cmd.h"
+#include "./app/ctrl/ctrl_pid.h"
 #include "./app/if_lcd/if_lcd.h"
+#include "./app/if_sock/if_sock.h"
+#include "./app/tlm/tlm.h"
 #include "./hal/hal.h"
 #include "./sys/sys.h"
 
@@ -36,7 +42,8 @@
 //********************************************************
 /*! @def                                                 */
 //********************************************************
-// なし
+#define PM_PERIOD       (10 * 1000000ULL)   // "pm" ループの周期 ( 単位: nsec )
+#define NSEC_PER_SEC    (1000000000ULL)
 
 
 //********************************************************
@@ -58,19 +65,39 @@
 extern char *optarg;
 extern int  optind, opterr, optopt;
 
+// --rt で指定したリアルタイム実行の設定 ( lock = EN_TRUE で有効 )
+static SSysRtParam_t    g_rt = { 0, -1, EN_FALSE };
+
+// LCD の 1 行目に表示するコマンド名
+static const char*      g_cmd = "";
+
+// main() の終了コード ( スクリプト / デーモンが失敗した場合は EXIT_FAILURE )
+static int              g_exit = EXIT_SUCCESS;
+
 
 //********************************************************
 /* 関数プロトタイプ宣言                                  */
 //********************************************************
 static void         Run_Help( void );
 static void         Run_Version( void );
+static EHalBool_t   Use_Lcd( void );
 
 static void         Run_I2cLcd( int argc, char *argv[] );
 static void         Run_Led( char* str );
 static void         Run_MotorDC( char* str );
+static void         Run_MotorDC_Pid( const char* str );
+static void         Out_MotorDC( double output, void* arg );
 static void         Run_MotorST( int argc, char *argv[] );
+static EHalBool_t   Parse_Profile( char* str, SHalMotorSTProfile_t* profile );
 
 static void         Run_Sa_Pm( char* str );
+static void         Run_Telemetry( char* str );
+static void         Run_Rt( char* str );
+static void         Run_Daemon( char* str );
+static void         Run_Script( char* str );
+static void         Stop_Motors( void );
+static void         Run_Init( char* str );
+
 
 
 
@@ -104,6 +131,13 @@ Run_Help(
     printf("\x1b[39m");
     printf( "                                                               \n\r" );
     printf( "  -d number, --motordc=number control the DC motor.            \n\r" );
+    printf( "                              number    : duty rate [%%] ( decimal allowed ). \n\r" );
+    printf( "                              freq=<Hz> : set the PWM frequency. \n\r" );
+    printf( "                              pid=<sp>[,kp,ki,kd] : 1 kHz PID control of Ch7 to <sp> [%%] until SW0. \n\r" );
+    printf("\x1b[32m");
+    printf( "                              Ex) -d freq=20000 -d 37.5        \n\r" );
+    printf( "                                  -d pid=50,0.8,20,0.002       \n\r" );
+    printf("\x1b[39m");
     printf( "  -e, --motorst               control the STEPPING motor.      \n\r" );
     printf( "    -d number, --deg=number                                    \n\r" );
     printf( "                              degree of rotation.              \n\r" );
@@ -111,15 +145,64 @@ Run_Help(
     printf( "                              direction of rotation.           \n\r" );
     printf( "                              ccw : left direction.            \n\r" );
     printf( "                              cw  : right direction.           \n\r" );
+    printf( "    -s {wave|full|half}, --step={wave|full|half}               \n\r" );
+    printf( "                              excitation mode. ( default: wave ) \n\r" );
+    printf( "                              wave : 1 phase, full : 2 phase, half : 1-2 phase ( half step ). \n\r" );
+    printf( "    -p type,..., --profile=type,...                            \n\r" );
+    printf( "                              acceleration profile [step/s, step/s^2, step/s^3]. \n\r" );
+    printf( "                              const,vmax | trap,vmin,vmax,accel | scurve,vmin,vmax,accel,jerk \n\r" );
     printf("\x1b[32m");
-    printf( "                              Ex) -e        -d    90  -r    cw \n\r" );
-    printf( "                                  --motorst --deg=90  --rol=cw \n\r" );
+    printf( "                              Ex) -e        -d    90  -r    cw  -s     half \n\r" );
+    printf( "                                  --motorst --deg=90  --rol=cw  --step=half \n\r" );
     printf("\x1b[39m");
     printf( "                                                               \n\r" );
     printf( "  -l number, --led=number     control the LED.                 \n\r" );
     printf( "  -p [json], --sa_pm=[json]                                                  \n\r" );
     printf( "                              get the value of a sensor(A/D), Potentiometer. \n\r" );
     printf( "                              json : get the all values of json format.      \n\r" );
+    printf( "  --telemetry[=hz[,ch,...]]   stream one JSON line per sample ( NDJSON ) until SIGINT/SIGTERM. \n\r" );
+    printf( "                              ( default: 10 Hz, all ADC channels ) each line has seq, ts and adc. \n\r" );
+    printf( "                              send \"tlm [hz[,ch,...]]\" to --daemon to add dc / dc2 / sv [state, duty] and st [mdeg]. \n\r" );
+    printf("\x1b[32m");
+    printf( "                              Ex) --telemetry=100,0,7          \n\r" );
+    printf("\x1b[39m");
+    printf( "  --rt=priority[,cpu]         run the control loop ( -d pm / -d pid ) on SCHED_FIFO \n\r" );
+    printf( "                              with locked memory, optionally pinned to a CPU. \n\r" );
+    printf( "                              put it before -d.                \n\r" );
+    printf("\x1b[32m");
+    printf( "                              Ex) --rt=80,3 -d pm              \n\r" );
+    printf("\x1b[39m");
+    printf( "  --script[=file]             run the commands of --daemon from a file ( default: stdin ) in one process. \n\r" );
+    printf( "                              wait <ms>                : wait for ms.                 \n\r" );
+    printf( "                              at <ms>                  : wait until ms from the start of the script / repeat. \n\r" );
+    printf( "                              repeat <n> <period_ms> ... end : repeat n times ( 0 = forever ) every period_ms. \n\r" );
+    printf("\x1b[32m");
+    printf( "                              Ex) printf 'lcd 0 0 hi\\nst cw 90\\ndc 30\\npm\\n' | board.out --script \n\r" );
+    printf("\x1b[39m");
+    printf( "  --init[=dev,...]            initialize the devices in parallel and show the time of each. \n\r" );
+    printf( "                              ( default: all ) put it first to start everything up front. \n\r" );
+    printf( "                              dev : gpio i2c spi time lcd led motorDC motorDC2 motorST motorSV pushsw sensorPm \n\r" );
+    printf("\x1b[32m");
+    printf( "                              Ex) --init --daemon              \n\r" );
+    printf( "                                  --init=lcd,sensorPm -p       \n\r" );
+    printf("\x1b[39m");
+    printf( "  --daemon[=path]             serve commands on a Unix domain socket until \"shutdown\". \n\r" );
+    printf( "                              ( default path: " APP_SOCK_PATH " ) \n\r" );
+    printf( "                              one command per line, one \"OK ...\" / \"ERR ...\" line per command. \n\r" );
+    printf( "                              ping | led <hex> | dc <rate>|standby|stop|brake|freq <Hz> | sv <rate> \n\r" );
+    printf( "                              st cw|ccw <deg> | st to <deg> | st wait [id] | st pos|origin|stop \n\r" );
+    printf( "                              st mode wave|full|half \n\r" );
+    printf( "                              st profile const <vmax> | trap <vmin> <vmax> <accel> | scurve <vmin> <vmax> <accel> <jerk> \n\r" );
+    printf( "                              lcd clear | lcd <x> <y> <text> | pm | adc <ch> | sw <n> | shutdown \n\r" );
+    printf( "                              tlm [hz[,ch,...]] : switch the connection to the telemetry stream. \n\r" );
+    printf("\x1b[32m");
+    printf( "                              Ex) --daemon & echo \"led F\" | nc -U " APP_SOCK_PATH " \n\r" );
+    printf("\x1b[39m");
+    printf( "\n\r" );
+    printf( "  Environment:                                                 \n\r" );
+    printf( "    HAL_BACKEND={hw|sim}      select the bus backend. ( default: hw ) \n\r" );
+    printf( "                              sim : run without hardware, devices are simulated in memory. \n\r" );
+    printf( "    HAL_GPIOMEM=file          mmap the file instead of /dev/gpiomem as fake GPIO registers. \n\r" );
     printf( "\n\r" );
 
     return;
@@ -145,6 +228,42 @@ Run_Version(
 }
 
 
+/**************************************************************************//*!
+ * @brief     LCD を使える状態にする
+ * @attention なし。
+ * @note      初めて使うときに LCD を初期化し、1 行目にコマンド名を表示する。
+ *            LCD の初期化には時間がかかるため、LCD を使うコマンドだけが呼ぶ。
+ * @sa        Sys_Require()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Use_Lcd(
+    void
+){
+    EHalBool_t          ret = EN_FALSE;
+    static EHalBool_t   shown = EN_FALSE;   // コマンド名を表示済みか否か
+
+    if( EN_FALSE == Sys_Require( EN_SYS_LCD ) )
+    {
+        return ret;
+    }
+
+    ret = EN_TRUE;
+    if( shown == EN_TRUE )
+    {
+        return ret;
+    }
+    shown = EN_TRUE;
+
+    AppIfLcd_Clear();
+    AppIfLcd_Ctrl( 1, 0, 0 );
+    AppIfLcd_CursorSet( 0, 0 );
+    AppIfLcd_Printf( "cmd:%s", g_cmd );
+    return ret;
+}
+
+
 /**************************************************************************//*!
  * @brief     I2C LCD を実行する
  * @attention なし。
@@ -210,6 +329,12 @@ Run_I2cLcd(
 
     DBG_PRINT_TRACE( "(x, y) = (%d, %d) \n\r", x, y );
     DBG_PRINT_TRACE( "str    = %s \n\r", str );
+
+    if( EN_FALSE == Use_Lcd() )
+    {
+        return;
+    }
+
     AppIfLcd_CursorSet( 0, 0 );
     AppIfLcd_Printf( "                " );
     AppIfLcd_CursorSet( 0, 1 );
@@ -237,6 +362,11 @@ Run_Led(
     unsigned int    num;
     DBG_PRINT_TRACE( "str = %s \n\r", str );
 
+    if( EN_FALSE == Sys_Require( EN_SYS_LED ) )
+    {
+        return;
+    }
+
     sscanf( str, "%X", &num );
     HalLed_Set( num );
 
@@ -256,28 +386,62 @@ static void
 Run_MotorDC(
     char*           str     ///< [in] 文字列
 ){
-    int             data = 0;
+    double          data = 0.0;
+    SHalPwmInfo_t   info;
     SHalSensor_t*   value;
     int             p_rate = 0;
+    SHalPushSwEvent_t   ev;
+    const EHalSensorMcp3208_t   ch[] = { EN_MCP3208_CH_7 };
+    static SSysRtPeriod_t       period;
+    SSysRtStats_t       stats;
+    unsigned long long  next = 0;
+    struct timespec     ts;
 
     DBG_PRINT_TRACE( "str = %s \n\r", str );
 
+    // DC モータ 2 は DC モータに依存するため、両方が初期化される
+    if( EN_FALSE == Sys_Require( EN_SYS_MOTOR_DC2 ) )
+    {
+        goto err;
+    }
+
     if( 0 == strncmp( str, "standby", strlen("standby") ) )
     {
         HalMotorDC_SetPwmDuty( EN_MOTOR_STANDBY, 0 );
         HalMotorDC2_SetPwmDuty( EN_MOTOR_STANDBY, 0 );
     } else if( 0 == strncmp( str, "pm", strlen("pm") ) )
     {
+        if( EN_FALSE == Sys_Require( EN_SYS_SENSOR_PM ) || EN_FALSE == Sys_Require( EN_SYS_PUSH_SW ) )
+        {
+            goto err;
+        }
+        Use_Lcd();
+
+        // ポテンショメータは 1 msec 周期でバックグラウンド・サンプリングする
+        HalCmnSpiMcp3208_StreamStart( ch, 1, 1000 );
+
+        if( g_rt.lock == EN_TRUE )
+        {
+            SysRt_Setup( &g_rt );
+        }
+
         value = HalSensorPm_Get();
         p_rate = value->cur_rate;
 
-        while( EN_FALSE == HalPushSw_Get( EN_PUSH_SW_0 ) )
+        SysRt_PeriodInit( &period, PM_PERIOD );
+        next = HalTime_GetMonotonicNs();
+        while( 1 )
         {
+            SysRt_PeriodAdd( &period, HalTime_GetMonotonicNs() );
+
             value = HalSensorPm_Get();
             DBG_PRINT_TRACE( "value->cur_rate = %3d %% \n", value->cur_rate );
 
-            AppIfLcd_CursorSet( 0, 1 );
-            AppIfLcd_Printf( "%3d%%", value->cur_rate );
+            if( EN_TRUE == Sys_IsUp( EN_SYS_LCD ) )
+            {
+                AppIfLcd_CursorSet( 0, 1 );
+                AppIfLcd_Printf( "%3d%%", value->cur_rate );
+            }
 
             if( value->cur_rate != p_rate )
             {
@@ -285,17 +449,51 @@ Run_MotorDC(
                 HalMotorDC2_SetPwmDuty( EN_MOTOR_CW, value->cur_rate );
                 p_rate = value->cur_rate;
             }
-            usleep( 10 * 1000 );
+
+            // SW0 が押されたら終了する
+            if( EN_TRUE == HalPushSw_PollEvent( &ev, 0 )
+             && ev.which == EN_PUSH_SW_0 && ev.press == EN_TRUE )
+            {
+                break;
+            }
+
+            // 絶対時刻で待つので、処理時間で周期がずれない
+            next += PM_PERIOD;
+            ts.tv_sec  = next / NSEC_PER_SEC;
+            ts.tv_nsec = next % NSEC_PER_SEC;
+            while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL ) != 0 )
+            {
+                ;   // シグナルで中断された場合は再度待つ
+            }
         }
 
+        SysRt_PeriodGet( &period, &stats );
+        printf( "period [usec] : min = %.1f, max = %.1f, p99 = %.1f, missed = %lu / %lu \n\r",
+                stats.min, stats.max, stats.p99, stats.missed, stats.count );
+
+        HalCmnSpiMcp3208_StreamStop();
+
         HalMotorDC_SetPwmDuty( EN_MOTOR_STOP, 0 );
         HalMotorDC2_SetPwmDuty( EN_MOTOR_STOP, 0 );
+    } else if( 0 == strncmp( str, "pid=", strlen("pid=") ) )
+    {
+        Run_MotorDC_Pid( &str[strlen("pid=")] );
+    } else if( 0 == strncmp( str, "freq=", strlen("freq=") ) )
+    {
+        if( EN_FALSE == HalMotorDC_SetPwmFreq( atof( (const char*)&str[strlen("freq=")] ) ) )
+        {
+            DBG_PRINT_ERROR( "invalid argument error. : %s \n\r", str );
+            goto err;
+        }
+        HalMotorDC_GetPwmInfo( &info );
+        printf( "PWM : %.1f Hz ( clock = %u, range = %u, resolution = %.4f %% ) \n\r",
+                info.freq, info.clock, info.range, info.resolution );
     } else if( 0 != isdigit( str[0] ) )
     {
-        data = atoi( (const char*)str );
-        DBG_PRINT_TRACE( "data = %d \n", data );
-        HalMotorDC_SetPwmDuty( EN_MOTOR_CW, data );
-        HalMotorDC2_SetPwmDuty( EN_MOTOR_CW, data );
+        data = atof( (const char*)str );
+        DBG_PRINT_TRACE( "data = %f \n", data );
+        HalMotorDC_SetPwmDutyF( EN_MOTOR_CW, data );
+        HalMotorDC2_SetPwmDutyF( EN_MOTOR_CW, data );
     } else
     {
         DBG_PRINT_ERROR( "invalid argument error. : %s \n\r", str );
@@ -309,6 +507,157 @@ err :
 }
 
 
+/**************************************************************************//*!
+ * @brief     DC MOTOR を PID 制御する
+ * @attention なし。
+ * @note      Ch7 の AD 値を制御量として 1 kHz で PID 制御し、SW0 が押されたら止める。
+ *            str = "目標値[,kp,ki,kd]" ( 目標値の単位: % )
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Run_MotorDC_Pid(
+    const char*     str     ///< [in] 文字列
+){
+    SAppCtrlPidParam_t  param;
+    SAppCtrlPidStats_t  stats;
+    SHalPushSwEvent_t   ev;
+    SSysRtParam_t       rt;
+
+    DBG_PRINT_TRACE( "str = %s \n\r", str );
+
+    memset( &param, 0, sizeof(param) );
+    param.ch       = EN_MCP3208_CH_7;
+    param.period   = 1000;
+    param.priority = g_rt.priority;
+    param.cpu      = g_rt.cpu;
+    param.kp       = 1.0;
+    param.ki       = 10.0;
+    param.kd       = 0.0;
+    param.tf       = 0.005;
+    param.outMin   = 0.0;
+    param.outMax   = 100.0;
+    param.output   = Out_MotorDC;
+    param.arg      = NULL;
+
+    if( 1 > sscanf( str, "%lf,%lf,%lf,%lf", &param.setpoint, &param.kp, &param.ki, &param.kd ) )
+    {
+        DBG_PRINT_ERROR( "invalid argument error. : %s \n\r", str );
+        return;
+    }
+
+    if( EN_FALSE == Sys_Require( EN_SYS_SPI ) || EN_FALSE == Sys_Require( EN_SYS_PUSH_SW ) )
+    {
+        return;
+    }
+    Use_Lcd();
+
+    // 優先度と CPU は制御スレッドに設定し、メモリのロックだけをここで行う
+    if( g_rt.lock == EN_TRUE )
+    {
+        rt.priority = 0;
+        rt.cpu      = -1;
+        rt.lock     = EN_TRUE;
+        SysRt_Setup( &rt );
+    }
+
+    if( EN_FALSE == AppCtrlPid_Start( &param ) )
+    {
+        return;
+    }
+
+    while( 1 )
+    {
+        AppCtrlPid_GetStats( &stats );
+        if( EN_TRUE == Sys_IsUp( EN_SYS_LCD ) )
+        {
+            AppIfLcd_CursorSet( 0, 1 );
+            AppIfLcd_Printf( "%5.1f%% %5.1f%%", stats.input, stats.output );
+        }
+
+        // SW0 が押されたら終了する ( イベント待ちを表示の周期の待ちに兼ねる )
+        if( EN_TRUE == HalPushSw_PollEvent( &ev, 100 )
+         && ev.which == EN_PUSH_SW_0 && ev.press == EN_TRUE )
+        {
+            break;
+        }
+    }
+
+    AppCtrlPid_Stop();
+    HalMotorDC_SetPwmDuty( EN_MOTOR_STOP, 0 );
+    HalMotorDC2_SetPwmDuty( EN_MOTOR_STOP, 0 );
+
+    AppCtrlPid_GetStats( &stats );
+    printf( "cycles = %lu, overrun = %lu, missed = %lu, exec max = %llu nsec \n\r",
+            stats.cycles, stats.overrun, stats.missed, stats.execMax );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     PID 制御の操作量を DC MOTOR に出力する
+ * @attention 制御スレッドから呼ばれる。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Out_MotorDC(
+    double          output, ///< [in] 操作量 ( デューティ比, 単位: % )
+    void*           arg     ///< [in] ナシ
+){
+    HalMotorDC_SetPwmDutyF( EN_MOTOR_CW, output );
+    HalMotorDC2_SetPwmDutyF( EN_MOTOR_CW, output );
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     "type,vmin,vmax,accel[,jerk]" を加減速プロファイルに変換する。
+ * @attention str は書き換える。値の範囲は HalMotorST_SetProfile() で検査する。
+ * @note      const,vmax | trap,vmin,vmax,accel | scurve,vmin,vmax,accel,jerk
+ * @sa        Run_MotorST()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Parse_Profile(
+    char*                   str,        ///< [in]  文字列
+    SHalMotorSTProfile_t*   profile     ///< [out] 加減速プロファイル
+){
+    EHalBool_t      ret = EN_FALSE;
+    char*           value = strchr( str, ',' );
+    char            c;
+
+    memset( profile, 0, sizeof(*profile) );
+
+    if( value == NULL )
+    {
+        goto err;
+    }
+    *value++ = '\0';
+
+    if( 0 == strcmp( str, "const" ) )
+    {
+        profile->type = EN_ST_PROFILE_CONST;
+        ret = ( 1 == sscanf( value, "%lf%c", &profile->vmax, &c ) ) ? EN_TRUE : EN_FALSE;
+    } else if( 0 == strcmp( str, "trap" ) )
+    {
+        profile->type = EN_ST_PROFILE_TRAPEZOID;
+        ret = ( 3 == sscanf( value, "%lf,%lf,%lf%c", &profile->vmin, &profile->vmax, &profile->accel, &c ) ) ? EN_TRUE : EN_FALSE;
+    } else if( 0 == strcmp( str, "scurve" ) )
+    {
+        profile->type = EN_ST_PROFILE_SCURVE;
+        ret = ( 4 == sscanf( value, "%lf,%lf,%lf,%lf%c", &profile->vmin, &profile->vmax, &profile->accel, &profile->jerk, &c ) ) ? EN_TRUE : EN_FALSE;
+    }
+
+err :
+    return ret;
+}
+
+
 /**************************************************************************//*!
  * @brief     STEPPING MOTOR を実行する
  * @attention なし。
@@ -322,17 +671,23 @@ Run_MotorST(
     int             argc,
     char            *argv[]
 ){
-    int             opt = 0;
-    const char      optstring[] = "d:r:";
-    const struct    option longopts[] = {
-      //{ *name,  has_arg,           *flag, val }, // 説明
-        { "rol",  required_argument, NULL,  'r' },
-        { "deg",  required_argument, NULL,  'd' },
-        { 0,      0,                 NULL,   0  }, // termination
+    int                     opt = 0;
+    const char              optstring[] = "d:r:s:p:";
+    const struct            option longopts[] = {
+      //{ *name,     has_arg,           *flag, val }, // 説明
+        { "rol",     required_argument, NULL,  'r' },
+        { "deg",     required_argument, NULL,  'd' },
+        { "step",    required_argument, NULL,  's' },
+        { "profile", required_argument, NULL,  'p' },
+        { 0,         0,                 NULL,   0  }, // termination
     };
-    int             longindex = 0;
-    int             deg = 0;
-    char            rol[16];
+    int                     longindex = 0;
+    int                     deg = 0;
+    char                    rol[16];
+    char                    step[16] = "wave";
+    EHalMotorSTStep_t       mode = EN_ST_STEP_WAVE;
+    char                    str[64] = "";
+    SHalMotorSTProfile_t    profile;
 
     while( 1 )
     {
@@ -353,6 +708,8 @@ Run_MotorST(
         {
         case 'd': DBG_PRINT_TRACE( "optarg = %s \n\r", optarg ); deg = strtol( (const char*)optarg, NULL, 10 ); break;
         case 'r': DBG_PRINT_TRACE( "optarg = %s \n\r", optarg ); strncpy( rol, (const char*)optarg, 16 ); break;
+        case 's': DBG_PRINT_TRACE( "optarg = %s \n\r", optarg ); snprintf( step, sizeof(step), "%s", optarg ); break;
+        case 'p': DBG_PRINT_TRACE( "optarg = %s \n\r", optarg ); snprintf( str, sizeof(str), "%s", optarg ); break;
         default:
             DBG_PRINT_ERROR( "invalid command/option. : \"%s\" \n\r", argv[1] );
             Run_Help();
@@ -362,6 +719,32 @@ Run_MotorST(
 
     DBG_PRINT_TRACE( "deg = %d \n\r", deg );
     DBG_PRINT_TRACE( "rol = %s \n\r", rol );
+    DBG_PRINT_TRACE( "step = %s \n\r", step );
+
+    if(      0 == strcmp( step, "wave" ) ){ mode = EN_ST_STEP_WAVE;      }
+    else if( 0 == strcmp( step, "full" ) ){ mode = EN_ST_STEP_TWO_PHASE; }
+    else if( 0 == strcmp( step, "half" ) ){ mode = EN_ST_STEP_HALF;      }
+    else
+    {
+        DBG_PRINT_ERROR( "invalid argument error. : %s \n\r", step );
+        goto err;
+    }
+
+    if( str[0] != '\0' && EN_FALSE == Parse_Profile( str, &profile ) )
+    {
+        DBG_PRINT_ERROR( "invalid argument error. : profile \n\r" );
+        goto err;
+    }
+
+    if( EN_FALSE == Sys_Require( EN_SYS_MOTOR_ST ) || EN_FALSE == HalMotorST_SetStepMode( mode ) )
+    {
+        goto err;
+    }
+
+    if( str[0] != '\0' && EN_FALSE == HalMotorST_SetProfile( &profile ) )
+    {
+        goto err;
+    }
 
     if( 0 == strncmp( rol, "ccw", strlen("ccw") ) )
     {
@@ -393,26 +776,38 @@ Run_Sa_Pm(
     char*           str     ///< [in] 文字列
 ){
     SHalSensor_t*   data;
+    EHalBool_t      lcd = EN_FALSE;
 
     DBG_PRINT_TRACE( "str = %s \n\r", str );
 
+    if( EN_FALSE == Sys_Require( EN_SYS_SENSOR_PM ) )
+    {
+        goto err;
+    }
+
+    // LCD の初期化は待たない。既に使える場合だけ表示する
+    lcd = Sys_IsUp( EN_SYS_LCD );
+
     if( str == NULL )
     {
         data = HalSensorPm_Get();
-        AppIfLcd_CursorSet( 0, 1 );
-        AppIfLcd_Printf( "%3d %%", data->cur_rate );
+        if( lcd == EN_TRUE )
+        {
+            AppIfLcd_CursorSet( 0, 1 );
+            AppIfLcd_Printf( "%3d %%", data->cur_rate );
+        }
         printf( "%3d", data->cur_rate );
     } else if( 0 == strncmp( str, "json", strlen("json") ) )
     {
         data = HalSensorPm_Get();
 
-        AppIfLcd_CursorSet( 0, 1 );
-        AppIfLcd_Printf( "%3d %%", data->cur_rate );
+        if( lcd == EN_TRUE )
+        {
+            AppIfLcd_CursorSet( 0, 1 );
+            AppIfLcd_Printf( "%3d %%", data->cur_rate );
+        }
 
-        printf( "{ " );
-        printf( "  \"sensor\": \"sa_pm\"," );
-        printf( "  \"value\": %3d,", data->cur_rate );
-        printf( "}" );
+        printf( "{\"sensor\":\"sa_pm\",\"value\":%d}\n", data->cur_rate );
     } else
     {
         DBG_PRINT_ERROR( "invalid argument error. : %s \n\r", str );
@@ -424,6 +819,200 @@ err :
 }
 
 
+/**************************************************************************//*!
+ * @brief     テレメトリを出力する
+ * @attention このプロセスはモータを動かさないので、モータの状態は出力しない。
+ *            モータの状態はデーモン ( --daemon ) に "tlm" を送って受け取る。
+ * @note      str = "周期[Hz][,ch,ch...]" ( NULL = 10Hz, 全 ch )。周期を省略した場合 ( "" / ",ch..." ) も 10Hz。
+ *            SIGINT / SIGTERM を受けるか、標準出力が閉じられるまで出力を続ける。
+ * @sa        AppTlm_Run()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Run_Telemetry(
+    char*           str     ///< [in] 文字列
+){
+    SAppTlmParam_t  param;
+
+    DBG_PRINT_TRACE( "str = %s \n\r", str );
+
+    if( EN_FALSE == AppTlm_Parse( str, &param ) )
+    {
+        return;
+    }
+
+    fflush( stdout );   // printf() の出力と write() の出力が混ざらないようにする
+    if( EN_FALSE == AppTlm_Run( &param ) )
+    {
+        DBG_PRINT_ERROR( "telemetry stopped. \n\r" );
+    }
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     リアルタイム実行の設定を保存する
+ * @attention 後に続く -d の制御ループに適用する。
+ * @note      str = "優先度[,CPU 番号]"
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Run_Rt(
+    char*           str     ///< [in] 文字列
+){
+    int             priority = 0;
+    int             cpu = -1;
+
+    DBG_PRINT_TRACE( "str = %s \n\r", str );
+
+    if( 1 > sscanf( str, "%d,%d", &priority, &cpu ) || priority < 1 || priority > 99 )
+    {
+        DBG_PRINT_ERROR( "invalid argument error. : %s \n\r", str );
+        return;
+    }
+
+    g_rt.priority = priority;
+    g_rt.cpu      = cpu;
+    g_rt.lock     = EN_TRUE;
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     デーモンとしてコマンドを受け付ける
+ * @attention なし。
+ * @note      str = ソケットのパス ( NULL = APP_SOCK_PATH )
+ *            起動に失敗した場合は、終了コードを EXIT_FAILURE にする。
+ * @sa        AppIfSock_Serve()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Run_Daemon(
+    char*           str     ///< [in] 文字列
+){
+    DBG_PRINT_TRACE( "str = %s \n\r", str );
+
+    if( EN_FALSE == AppIfSock_Serve( str ) )
+    {
+        DBG_PRINT_ERROR( "fail to start the daemon. \n\r" );
+        g_exit = EXIT_FAILURE;
+    }
+
+    Stop_Motors();
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     スクリプトを実行する
+ * @attention なし。
+ * @note      str = スクリプトのパス ( NULL / "-" = 標準入力 )
+ *            途中で止まった場合は、終了コードを EXIT_FAILURE にする。
+ * @sa        AppCmd_Script()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Run_Script(
+    char*           str     ///< [in] 文字列
+){
+    DBG_PRINT_TRACE( "str = %s \n\r", str );
+
+    if( EN_FALSE == AppCmd_Script( str ) )
+    {
+        DBG_PRINT_ERROR( "script aborted. \n\r" );
+        g_exit = EXIT_FAILURE;
+    }
+
+    Stop_Motors();
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     使ったモータを止める
+ * @attention なし。
+ * @note      初期化していないモータには触らない。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Stop_Motors(
+    void
+){
+    if( EN_TRUE == Sys_IsUp( EN_SYS_MOTOR_ST ) )
+    {
+        HalMotorST_Stop();
+    }
+    if( EN_TRUE == Sys_IsUp( EN_SYS_MOTOR_DC2 ) )
+    {
+        HalMotorDC_SetPwmDuty( EN_MOTOR_STANDBY, 0 );
+        HalMotorDC2_SetPwmDuty( EN_MOTOR_STANDBY, 0 );
+    }
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     デバイスを並行して初期化する
+ * @attention なし。
+ * @note      str = "デバイス名[,デバイス名...]" ( NULL = 全て )
+ *            後に続くコマンドは、初期化済みのデバイスをそのまま使う。
+ * @sa        Sys_Start()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+Run_Init(
+    char*           str     ///< [in] 文字列
+){
+    unsigned int    mask = SYS_DEV_ALL;
+    char*           name = NULL;
+    char*           save = NULL;
+    unsigned int    i = 0;
+
+    DBG_PRINT_TRACE( "str = %s \n\r", str );
+
+    if( str != NULL )
+    {
+        mask = 0;
+        for( name = strtok_r( str, ",", &save ); name != NULL; name = strtok_r( NULL, ",", &save ) )
+        {
+            for( i = 0; i < EN_SYS_NUM; i++ )
+            {
+                if( 0 == strcmp( name, Sys_GetName( (ESysDev_t)i ) ) )
+                {
+                    mask |= SYS_DEV_BIT(i);
+                    break;
+                }
+            }
+            if( i == EN_SYS_NUM )
+            {
+                DBG_PRINT_ERROR( "invalid argument error. : %s \n\r", name );
+                return;
+            }
+        }
+    }
+
+    if( EN_FALSE == Sys_Start( mask ) )
+    {
+        DBG_PRINT_ERROR( "some devices failed to initialize. \n\r" );
+    }
+    Sys_ShowInitTime();
+
+    if( EN_TRUE == Sys_IsUp( EN_SYS_LCD ) )
+    {
+        Use_Lcd();
+    }
+    return;
+}
+
+
 /**************************************************************************//*!
  * @brief     メイン
  * @attention なし。
@@ -445,9 +1034,20 @@ int main(int argc, char *argv[ ])
         { "motorst",       required_argument, NULL,  'e' },
         { "led",           required_argument, NULL,  'l' },
         { "sa_pm",         optional_argument, NULL,  'p' },
+        { "rt",            required_argument, NULL,  'R' },
+        { "daemon",        optional_argument, NULL,  'D' },
+        { "init",          optional_argument, NULL,  'I' },
+        { "script",        optional_argument, NULL,  'S' },
+        { "telemetry",     optional_argument, NULL,  'T' },
         { 0,               0,                 NULL,   0  }, // termination
     };
     int longindex = 0;
+    char*           backend = getenv( "HAL_BACKEND" );
+
+    if( backend != NULL && 0 == strncmp( backend, "sim", strlen("sim") ) )
+    {
+        HalCmn_SetBackend( EN_BACKEND_SIM );
+    }
 
     Sys_Init();
 
@@ -458,10 +1058,11 @@ int main(int argc, char *argv[ ])
     DBG_PRINT_TRACE( "argv[3] = %s \n\r", argv[3] );
 
 
-    AppIfLcd_Clear();
-    AppIfLcd_Ctrl( 1, 0, 0 );
-    AppIfLcd_CursorSet( 0, 0 );
-    AppIfLcd_Printf( "cmd:%s", argv[1] );
+    // デバイスは各コマンドが使う前に初期化する ( LCD は Use_Lcd() )
+    if( argc > 1 )
+    {
+        g_cmd = argv[1];
+    }
 
     while( 1 )
     {
@@ -500,6 +1101,11 @@ int main(int argc, char *argv[ ])
         case 'd': Run_MotorDC( optarg ); break;
         case 'l': Run_Led( optarg ); break;
         case 'p': Run_Sa_Pm( optarg ); break;
+        case 'R': Run_Rt( optarg ); break;
+        case 'D': Run_Daemon( optarg ); break;
+        case 'I': Run_Init( optarg ); break;
+        case 'S': Run_Script( optarg ); break;
+        case 'T': Run_Telemetry( optarg ); break;
         default:
             DBG_PRINT_ERROR( "invalid command/option. : \"%s\" \n\r", argv[1] );
             Run_Help();
@@ -508,7 +1114,7 @@ int main(int argc, char *argv[ ])
     }
 
     Sys_Fini();
-    return 0;
+    return g_exit;
 }
 
 
@@ -17,6 +17,9 @@
 //********************************************************
 /* include                                               */
 //********************************************************
+#include <pthread.h>
+#include <string.h>
+
 #include "../hal/hal.h"
 #include "../app/if_lcd/if_lcd.h"
 #include "../app/if_pc/if_pc.h"
@@ -32,40 +35,171 @@
 //********************************************************
 /*! @def                                                 */
 //********************************************************
-// なし
+#define DEP(dev)        SYS_DEV_BIT(dev)    // 依存するデバイスのビットマスク
 
 
 //********************************************************
 /*! @enum                                                */
 //********************************************************
-// なし
+// デバイスの状態
+typedef enum {
+    EN_SYS_DOWN = 0,    // 未初期化
+    EN_SYS_STARTING,    // 初期化中 ( 他のスレッドは完了を待つ )
+    EN_SYS_UP,          // 初期化済み
+    EN_SYS_FAILED       // 初期化に失敗した ( 再試行しない )
+} ESysState_t;
 
 
 //********************************************************
 /*! @struct                                              */
 //********************************************************
-// なし
+// デバイスの初期化テーブルの要素
+typedef struct {
+    const char*     name;
+    EHalBool_t      (*init)( void );
+    void            (*fini)( void );    // NULL = 終了処理なし
+    unsigned int    deps;               // 先に初期化するデバイス ( DEP() の論理和 )
+} SSysDev_t;
+
+typedef struct {
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;               // デバイスの初期化の完了を通知する
+    ESysState_t         state[EN_SYS_NUM];
+    ESysDev_t           order[EN_SYS_NUM];  // 初期化した順番 ( 終了処理は逆順に行う )
+    unsigned int        num;                // 初期化したデバイスの数
+    unsigned long long  base;               // Sys_Init() の時刻 ( 単位: nsec )
+    unsigned long long  start[EN_SYS_NUM];  // 初期化を開始した時刻 ( base からの経過時間, 単位: nsec )
+    unsigned long long  time[EN_SYS_NUM];   // 初期化にかかった時間 ( 依存するデバイスの待ちを除く, 単位: nsec )
+} SSysParam_t;
 
 
 //********************************************************
 /* モジュールグローバル変数                              */
 //********************************************************
-// なし
+// デバイスの初期化テーブル ( ESysDev_t の順 )
+static const SSysDev_t  g_dev[EN_SYS_NUM] = {
+    { "gpio",      HalCmnGpio_Init,   HalCmnGpio_Fini,   0                     },
+    { "i2c",       HalCmnI2c_Init,    HalCmnI2c_Fini,    0                     },
+    { "spi",       HalCmnSpi_Init,    HalCmnSpi_Fini,    0                     },
+    { "time",      HalTime_Init,      NULL,              0                     },
+    { "lcd",       HalI2cLcd_Init,    HalI2cLcd_Fini,    DEP(EN_SYS_I2C)       },
+    { "led",       HalLed_Init,       HalLed_Fini,       DEP(EN_SYS_GPIO)      },
+    { "motorDC",   HalMotorDC_Init,   HalMotorDC_Fini,   DEP(EN_SYS_GPIO)      },
+    { "motorDC2",  HalMotorDC2_Init,  HalMotorDC2_Fini,  DEP(EN_SYS_MOTOR_DC)  },
+    { "motorST",   HalMotorST_Init,   HalMotorST_Fini,   DEP(EN_SYS_GPIO)      },
+    { "motorSV",   HalMotorSV_Init,   HalMotorSV_Fini,   DEP(EN_SYS_GPIO)      },
+    { "pushsw",    HalPushSw_Init,    HalPushSw_Fini,    DEP(EN_SYS_GPIO)      },
+    { "sensorPm",  HalSensorPm_Init,  HalSensorPm_Fini,  DEP(EN_SYS_SPI)       },
+};
+
+static SSysParam_t      g_param = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
 
 
 //********************************************************
 /* 関数プロトタイプ宣言                                  */
 //********************************************************
-// なし
+static EHalBool_t   Require( ESysDev_t dev );
+static void*        Worker( void* arg );
 
 
 
 
+/**************************************************************************//*!
+ * @brief     デバイスを、依存するデバイスから順に初期化する。
+ * @attention g_param.lock を取得せずに呼ぶこと。
+ * @note      依存関係は g_dev[] の deps で宣言する。
+ *            初期化済み / 初期化に失敗したデバイスは何もしない。
+ *            他のスレッドが初期化中のデバイスは、その完了を待つ。
+ *            初期化関数はロックの外で呼ぶため、依存関係の無いデバイスは並行して初期化できる。
+ * @sa        Sys_Require()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+static EHalBool_t
+Require(
+    ESysDev_t       dev     ///< [in] デバイス
+){
+    EHalBool_t          ret = EN_FALSE;
+    unsigned int        i = 0;
+    unsigned long long  start = 0;
+    unsigned long long  end = 0;
+
+    pthread_mutex_lock( &g_param.lock );
+    while( g_param.state[dev] == EN_SYS_STARTING )
+    {
+        pthread_cond_wait( &g_param.cond, &g_param.lock );
+    }
+    if( g_param.state[dev] != EN_SYS_DOWN )
+    {
+        ret = ( g_param.state[dev] == EN_SYS_UP ) ? EN_TRUE : EN_FALSE;
+        pthread_mutex_unlock( &g_param.lock );
+        return ret;
+    }
+    g_param.state[dev] = EN_SYS_STARTING;
+    pthread_mutex_unlock( &g_param.lock );
+
+    ret = EN_TRUE;
+    for( i = 0; i < EN_SYS_NUM; i++ )
+    {
+        if( ( g_dev[dev].deps & DEP(i) ) && EN_FALSE == Require( (ESysDev_t)i ) )
+        {
+            DBG_PRINT_ERROR( "%s : dependency %s is not available. \n\r", g_dev[dev].name, g_dev[i].name );
+            ret = EN_FALSE;
+            break;
+        }
+    }
+
+    start = HalTime_GetMonotonicNs();
+    if( ret == EN_TRUE )
+    {
+        DBG_PRINT_TRACE( "init %s \n\r", g_dev[dev].name );
+        ret = g_dev[dev].init();
+        if( ret == EN_FALSE )
+        {
+            DBG_PRINT_ERROR( "fail to initialize %s. \n\r", g_dev[dev].name );
+        }
+    }
+    end = HalTime_GetMonotonicNs();
+
+    pthread_mutex_lock( &g_param.lock );
+    g_param.start[dev] = start - g_param.base;
+    g_param.time[dev]  = end - start;
+    if( ret == EN_TRUE )
+    {
+        __atomic_store_n( &g_param.state[dev], EN_SYS_UP, __ATOMIC_RELEASE );
+        g_param.order[g_param.num++] = dev;
+    } else
+    {
+        g_param.state[dev] = EN_SYS_FAILED;
+    }
+    pthread_cond_broadcast( &g_param.cond );
+    pthread_mutex_unlock( &g_param.lock );
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     Sys_Start() のワーカ・スレッド。
+ * @attention なし。
+ * @note      1 つのデバイスを ( 依存するデバイスを含めて ) 初期化する。
+ * @sa        Sys_Start()
+ * @author    Ryoji Morita
+ * @return    NULL
+ *************************************************************************** */
+static void*
+Worker(
+    void*           arg     ///< [in] デバイス ( ESysDev_t )
+){
+    Require( (ESysDev_t)(long)arg );
+    return NULL;
+}
+
+
 /**************************************************************************//*!
  * @brief     システムを初期化する。
  * @attention なし。
- * @note      なし。
- * @sa        なし。
+ * @note      デバイスは初期化しない。各デバイスは使う前に Sys_Require() で初期化する。
+ * @sa        Sys_Require()
  * @author    Ryoji Morita
  * @return    なし。
  *************************************************************************** */
@@ -75,22 +209,13 @@ Sys_Init(
 ){
     DBG_PRINT_TRACE( "\n\r" );
 
-    HalCmnGpio_Init();
-    HalCmnI2c_Init();
-    HalCmnSpi_Init();
-
-    HalI2cLcd_Init();
-    HalLed_Init();
-    HalMotorDC_Init();
-    HalMotorDC2_Init();
-    HalMotorST_Init();
-    HalMotorSV_Init();
-    HalPushSw_Init();
-
-    // SENSOR (ADC)
-    HalSensorPm_Init();
-
-    HalTime_Init();
+    pthread_mutex_lock( &g_param.lock );
+    memset( g_param.state, 0, sizeof(g_param.state) );
+    memset( g_param.start, 0, sizeof(g_param.start) );
+    memset( g_param.time,  0, sizeof(g_param.time) );
+    g_param.num  = 0;
+    g_param.base = HalTime_GetMonotonicNs();
+    pthread_mutex_unlock( &g_param.lock );
 
     return;
 }
@@ -99,7 +224,7 @@ Sys_Init(
 /**************************************************************************//*!
  * @brief     システムを終了処理する。
  * @attention なし。
- * @note      なし。
+ * @note      初期化したデバイスだけを、初期化した順番の逆順に終了処理する。
  * @sa        なし。
  * @author    Ryoji Morita
  * @return    なし。
@@ -108,24 +233,186 @@ void
 Sys_Fini(
     void    ///< [in] ナシ
 ){
+    ESysDev_t       dev = EN_SYS_GPIO;
+
     DBG_PRINT_TRACE( "\n\r" );
 
-    HalI2cLcd_Fini();
-    HalLed_Fini();
-    HalMotorDC_Fini();
-    HalMotorDC2_Fini();
-    HalMotorST_Fini();
-    HalMotorSV_Fini();
-    HalPushSw_Fini();
+    pthread_mutex_lock( &g_param.lock );
+    while( g_param.num > 0 )
+    {
+        dev = g_param.order[--g_param.num];
+        DBG_PRINT_TRACE( "fini %s \n\r", g_dev[dev].name );
+        if( g_dev[dev].fini != NULL )
+        {
+            g_dev[dev].fini();
+        }
+        g_param.state[dev] = EN_SYS_DOWN;
+    }
+    pthread_mutex_unlock( &g_param.lock );
+
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     デバイスを使える状態にする。
+ * @attention なし。
+ * @note      初回の呼び出しで、依存するデバイスを含めて初期化する。2 回目以降は何もしない。
+ *            複数スレッドから呼んでよい。
+ * @sa        Sys_IsUp()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 成功, EN_FALSE : 失敗
+ *************************************************************************** */
+EHalBool_t
+Sys_Require(
+    ESysDev_t       dev     ///< [in] デバイス
+){
+    EHalBool_t      ret = EN_FALSE;
+
+    if( dev >= EN_SYS_NUM )
+    {
+        DBG_PRINT_ERROR( "invalid argument error. \n\r" );
+        return ret;
+    }
+
+    ret = Require( dev );
+    return ret;
+}
+
 
-    // SENSOR (ADC)
-    HalSensorPm_Fini();
+/**************************************************************************//*!
+ * @brief     複数のデバイスを並行して初期化する。
+ * @attention なし。
+ * @note      デバイスごとにワーカ・スレッドを作り、依存関係の無いデバイスは同時に初期化する。
+ *            ( 例: LCD の電源投入待ちの間に SPI / GPIO 側の初期化を進める )
+ *            全てのデバイスの初期化が終わるまで戻らない。
+ * @sa        Sys_Require(), Sys_ShowInitTime()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 全て成功, EN_FALSE : 1 つ以上失敗
+ *************************************************************************** */
+EHalBool_t
+Sys_Start(
+    unsigned int    mask    ///< [in] デバイスのビットマスク ( SYS_DEV_BIT() の論理和 )
+){
+    EHalBool_t      ret = EN_TRUE;
+    pthread_t       thread[EN_SYS_NUM];
+    EHalBool_t      created[EN_SYS_NUM];
+    unsigned int    i = 0;
+
+    DBG_PRINT_TRACE( "mask = 0x%X \n\r", mask );
+
+    for( i = 0; i < EN_SYS_NUM; i++ )
+    {
+        created[i] = EN_FALSE;
+        if( ( mask & SYS_DEV_BIT(i) ) && EN_FALSE == Sys_IsUp( (ESysDev_t)i ) )
+        {
+            if( 0 == pthread_create( &thread[i], NULL, Worker, (void*)(long)i ) )
+            {
+                created[i] = EN_TRUE;
+            } else
+            {
+                Require( (ESysDev_t)i );    // スレッドを作れない場合は、このスレッドで初期化する
+            }
+        }
+    }
 
-//  HalTime モジュールに Fini() 処理はない
+    for( i = 0; i < EN_SYS_NUM; i++ )
+    {
+        if( created[i] == EN_TRUE )
+        {
+            pthread_join( thread[i], NULL );
+        }
+        if( ( mask & SYS_DEV_BIT(i) ) && EN_FALSE == Sys_IsUp( (ESysDev_t)i ) )
+        {
+            ret = EN_FALSE;
+        }
+    }
+
+    return ret;
+}
 
-    HalCmnGpio_Fini();
-    HalCmnI2c_Fini();
-    HalCmnSpi_Fini();
+
+/**************************************************************************//*!
+ * @brief     デバイスが初期化済みか否かを返す。
+ * @attention なし。
+ * @note      初期化はしない。
+ * @sa        Sys_Require()
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 初期化済み, EN_FALSE : 未初期化
+ *************************************************************************** */
+EHalBool_t
+Sys_IsUp(
+    ESysDev_t       dev     ///< [in] デバイス
+){
+    EHalBool_t      ret = EN_FALSE;
+
+    if( dev < EN_SYS_NUM && __atomic_load_n( &g_param.state[dev], __ATOMIC_ACQUIRE ) == EN_SYS_UP )
+    {
+        ret = EN_TRUE;
+    }
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     デバイスの名前を返す。
+ * @attention なし。
+ * @note      なし。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    名前 ( 範囲外の場合は NULL )
+ *************************************************************************** */
+const char*
+Sys_GetName(
+    ESysDev_t       dev     ///< [in] デバイス
+){
+    if( dev >= EN_SYS_NUM )
+    {
+        return NULL;
+    }
+    return g_dev[dev].name;
+}
+
+
+/**************************************************************************//*!
+ * @brief     デバイスごとの初期化時間を表示する。
+ * @attention なし。
+ * @note      開始時刻は Sys_Init() からの経過時間。
+ *            初期化時間は依存するデバイスの待ちを含まない。
+ * @sa        Sys_Start()
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+Sys_ShowInitTime(
+    void    ///< [in] ナシ
+){
+    unsigned long long  end = 0;
+    unsigned int        i = 0;
+
+    DBG_PRINT_TRACE( "\n\r" );
+
+    pthread_mutex_lock( &g_param.lock );
+    AppIfPc_Printf( "[Init Time]===================== \n\r" );
+    AppIfPc_Printf( "device      start[ms]  time[ms] \n\r" );
+    for( i = 0; i < EN_SYS_NUM; i++ )
+    {
+        if( g_param.state[i] == EN_SYS_UP || g_param.state[i] == EN_SYS_FAILED )
+        {
+            AppIfPc_Printf( "%-10s %9.3f %9.3f %s \n\r",
+                    g_dev[i].name,
+                    g_param.start[i] / 1000000.0,
+                    g_param.time[i]  / 1000000.0,
+                    ( g_param.state[i] == EN_SYS_UP ) ? "" : "failed" );
+            if( end < g_param.start[i] + g_param.time[i] )
+            {
+                end = g_param.start[i] + g_param.time[i];
+            }
+        }
+    }
+    AppIfPc_Printf( "total      %9.3f \n\r", end / 1000000.0 );
+    AppIfPc_Printf( "================================ \n\r" );
+    pthread_mutex_unlock( &g_param.lock );
 
     return;
 }
@@ -147,6 +434,9 @@ Sys_ShowInfo(
 
     DBG_PRINT_TRACE( "\n\r" );
 
+    Sys_Require( EN_SYS_LCD );
+    Sys_Require( EN_SYS_TIME );
+
     AppIfLcd_Clear();
     AppIfLcd_Ctrl( 1, 0, 0 );
 
@@ -20,25 +20,74 @@
 //********************************************************
 /* include                                               */
 //********************************************************
-// なし
+#include "../hal/hal.h"
 
 
 //********************************************************
 /*! @def                                                 */
 //********************************************************
-// なし
+#define SYS_DEV_BIT(dev)    ( 1U << (dev) ) ///< @def : Sys_Start() に渡すデバイスのビット
+#define SYS_DEV_ALL         ( SYS_DEV_BIT(EN_SYS_NUM) - 1 ) ///< @def : 全てのデバイス
+
+#define SYS_RT_HIST_WIDTH   (5000)  ///< @def : 周期のヒストグラムの 1 区間の幅 ( 単位: nsec )
+#define SYS_RT_HIST_NUM     (4000)  ///< @def : 周期のヒストグラムの区間数 ( 5 usec * 4000 = 20 msec まで )
 
 
 //********************************************************
 /*! @enum                                                */
 //********************************************************
-// なし
+// Sys_Require() で初期化するデバイス
+typedef enum {
+    EN_SYS_GPIO = 0,            ///< @var : GPIO / PWM
+    EN_SYS_I2C,                 ///< @var : I2C バス
+    EN_SYS_SPI,                 ///< @var : SPI バス ( MCP3208 )
+    EN_SYS_TIME,                ///< @var : 時刻
+    EN_SYS_LCD,                 ///< @var : I2C LCD          ( I2C に依存 )
+    EN_SYS_LED,                 ///< @var : LED              ( GPIO に依存 )
+    EN_SYS_MOTOR_DC,            ///< @var : DC モータ        ( GPIO に依存 )
+    EN_SYS_MOTOR_DC2,           ///< @var : DC モータ 2      ( DC モータに依存 )
+    EN_SYS_MOTOR_ST,            ///< @var : ステッピング・モータ ( GPIO に依存 )
+    EN_SYS_MOTOR_SV,            ///< @var : サーボモータ     ( GPIO に依存 )
+    EN_SYS_PUSH_SW,             ///< @var : プッシュ・スイッチ ( GPIO に依存 )
+    EN_SYS_SENSOR_PM,           ///< @var : ポテンショメータ ( SPI に依存 )
+    EN_SYS_NUM                  ///< @var : デバイスの数
+} ESysDev_t;
 
 
 //********************************************************
 /*! @struct                                              */
 //********************************************************
-// なし
+// リアルタイム実行の設定に使用する型
+typedef struct tagSSysRtParam
+{
+    int                 priority;   ///< @var : SCHED_FIFO の優先度 ( 1 ～ 99 ) : 0 = 変更しない
+    int                 cpu;        ///< @var : 固定する CPU 番号 : -1 = 固定しない
+    EHalBool_t          lock;       ///< @var : EN_TRUE = mlockall() でメモリをロックする
+} SSysRtParam_t;
+
+
+// 周期の計測に使用する型
+typedef struct tagSSysRtPeriod
+{
+    unsigned long long  period;     ///< @var : 目標の周期 ( 単位: nsec )
+    unsigned long long  prev;       ///< @var : 前回の計測時刻 ( 単位: nsec ) : 0 = 未計測
+    unsigned long long  min;        ///< @var : 周期の最小値 ( 単位: nsec )
+    unsigned long long  max;        ///< @var : 周期の最大値 ( 単位: nsec )
+    unsigned long       count;      ///< @var : 計測した周期の数
+    unsigned long       missed;     ///< @var : 目標の 1.5 倍を超えた周期の数 ( デッドライン・ミス )
+    unsigned long       hist[SYS_RT_HIST_NUM];  ///< @var : 周期のヒストグラム ( 範囲外は最後の区間 )
+} SSysRtPeriod_t;
+
+
+// 周期の統計の取得に使用する型
+typedef struct tagSSysRtStats
+{
+    unsigned long       count;      ///< @var : 計測した周期の数
+    unsigned long       missed;     ///< @var : デッドライン・ミスの数
+    double              min;        ///< @var : 周期の最小値 ( 単位: usec )
+    double              max;        ///< @var : 周期の最大値 ( 単位: usec )
+    double              p99;        ///< @var : 周期の 99 パーセンタイル ( 単位: usec, ヒストグラムの区間幅の精度 )
+} SSysRtStats_t;
 
 
 //********************************************************
@@ -46,9 +95,19 @@
 //********************************************************
 void Sys_Init( void );
 void Sys_Fini( void );
+EHalBool_t  Sys_Require( ESysDev_t dev );
+EHalBool_t  Sys_Start( unsigned int mask );
+EHalBool_t  Sys_IsUp( ESysDev_t dev );
+const char* Sys_GetName( ESysDev_t dev );
+void        Sys_ShowInitTime( void );
 
 void Sys_ShowInfo( void );
 
+EHalBool_t  SysRt_Setup( const SSysRtParam_t* param );
+void        SysRt_PeriodInit( SSysRtPeriod_t* p, unsigned long long period );
+void        SysRt_PeriodAdd( SSysRtPeriod_t* p, unsigned long long now );
+void        SysRt_PeriodGet( const SSysRtPeriod_t* p, SSysRtStats_t* stats );
+
 
 #endif /* _SYS_H_ */
 
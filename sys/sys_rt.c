@@ -0,0 +1,255 @@
+/**************************************************************************//*!
+ *  @file           sys_rt.c
+ *  @brief          [SYS] リアルタイム実行 ( スケジューリング / メモリロック / CPU 固定 / 周期計測 ) の API を定義する。
+ *  @author         Ryoji Morita
+ *  @attention      none.
+ *  @sa             none.
+ *  @bug            none.
+ *  @warning        none.
+ *  @version        1.00
+ *  @last updated   2019.01.17
+ *************************************************************************** */
+#ifdef __cplusplus
+    extern "C"{
+#endif
+
+
+//********************************************************
+/* include                                               */
+//********************************************************
+#define _GNU_SOURCE     // CPU_SET(), pthread_setaffinity_np()
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "sys.h"
+
+
+//#define DBG_PRINT
+#define MY_NAME "SYS"
+#include "../app/log/log.h"
+
+
+//********************************************************
+/*! @def                                                 */
+//********************************************************
+#define RT_STACK_PREFAULT   (256 * 1024)    ///< @def : 事前に触っておくスタックのサイズ ( 単位: Byte )
+
+
+//********************************************************
+/*! @enum                                                */
+//********************************************************
+// なし
+
+
+//********************************************************
+/*! @struct                                              */
+//********************************************************
+// なし
+
+
+//********************************************************
+/* モジュールグローバル変数                              */
+//********************************************************
+// なし
+
+
+//********************************************************
+/* 関数プロトタイプ宣言                                  */
+//********************************************************
+static void         PrefaultStack( void );
+
+
+
+
+/**************************************************************************//*!
+ * @brief     スタックを事前に触ってページを割り当てておく。
+ * @attention なし。
+ * @note      mlockall( MCL_FUTURE ) の後に呼ぶことで、制御ループ中にスタックのページフォルトが起きなくなる。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+static void
+PrefaultStack(
+    void  ///< [in] ナシ
+){
+    unsigned char   stack[RT_STACK_PREFAULT];
+
+    memset( stack, 0, sizeof(stack) );
+    __asm__ __volatile__( "" : : "r"( stack ) : "memory" );    // 最適化で memset() を消させない
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     呼び出したスレッドをリアルタイム実行用に設定する。
+ * @attention SCHED_FIFO と mlockall() には権限 ( CAP_SYS_NICE / CAP_IPC_LOCK ) が必要。
+ * @note      メモリロック → スタックの事前割り当て → CPU 固定 → SCHED_FIFO の順に行う。
+ *            失敗した項目があっても残りの項目は設定する。
+ * @sa        なし。
+ * @author    Ryoji Morita
+ * @return    EN_TRUE : 全項目成功, EN_FALSE : 失敗した項目あり
+ *************************************************************************** */
+EHalBool_t
+SysRt_Setup(
+    const SSysRtParam_t*    param   ///< [in] リアルタイム実行の設定
+){
+    EHalBool_t          ret = EN_TRUE;
+    struct sched_param  sp;
+    cpu_set_t           set;
+    int                 res = 0;
+
+    DBG_PRINT_TRACE( "priority = %d, cpu = %d, lock = %d \n\r", param->priority, param->cpu, param->lock );
+
+    if( param->lock == EN_TRUE )
+    {
+        if( 0 != mlockall( MCL_CURRENT | MCL_FUTURE ) )
+        {
+            DBG_PRINT_WARN( "mlockall() error. : %s \n\r", strerror( errno ) );
+            ret = EN_FALSE;
+        }
+        PrefaultStack();
+    }
+
+    if( param->cpu >= 0 )
+    {
+        CPU_ZERO( &set );
+        CPU_SET( param->cpu, &set );
+        res = pthread_setaffinity_np( pthread_self(), sizeof(set), &set );
+        if( res != 0 )
+        {
+            DBG_PRINT_WARN( "Unable to pin to CPU %d. : %s \n\r", param->cpu, strerror( res ) );
+            ret = EN_FALSE;
+        }
+    }
+
+    if( param->priority > 0 )
+    {
+        memset( &sp, 0, sizeof(sp) );
+        sp.sched_priority = param->priority;
+        res = pthread_setschedparam( pthread_self(), SCHED_FIFO, &sp );
+        if( res != 0 )
+        {
+            DBG_PRINT_WARN( "Unable to use SCHED_FIFO ( priority = %d ). : %s \n\r", param->priority, strerror( res ) );
+            ret = EN_FALSE;
+        }
+    }
+
+    return ret;
+}
+
+
+/**************************************************************************//*!
+ * @brief     周期の計測を初期化する。
+ * @attention なし。
+ * @note      なし。
+ * @sa        SysRt_PeriodAdd
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+SysRt_PeriodInit(
+    SSysRtPeriod_t*     p,      ///< [out] 周期の計測
+    unsigned long long  period  ///< [in]  目標の周期 ( 単位: nsec )
+){
+    memset( p, 0, sizeof(SSysRtPeriod_t) );
+    p->period = period;
+    p->min    = ~0ULL;
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     周期を 1 回分計測する。
+ * @attention なし。
+ * @note      周期の先頭 ( 起床直後 ) に毎回呼ぶ。前回の呼び出しからの経過時間を 1 周期として記録する。
+ *            目標の 1.5 倍を超えた周期をデッドライン・ミスとして数える。
+ * @sa        SysRt_PeriodGet
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+SysRt_PeriodAdd(
+    SSysRtPeriod_t*     p,      ///< [in,out] 周期の計測
+    unsigned long long  now     ///< [in]     現在時刻 ( CLOCK_MONOTONIC, 単位: nsec )
+){
+    unsigned long long  dt = 0;
+    unsigned long long  bin = 0;
+
+    if( p->prev != 0 )
+    {
+        dt = now - p->prev;
+
+        if( dt < p->min ){ p->min = dt; }
+        if( dt > p->max ){ p->max = dt; }
+        if( dt * 2 > p->period * 3 ){ p->missed++; }
+
+        bin = dt / SYS_RT_HIST_WIDTH;
+        if( bin >= SYS_RT_HIST_NUM )
+        {
+            bin = SYS_RT_HIST_NUM - 1;
+        }
+        p->hist[bin]++;
+        p->count++;
+    }
+
+    p->prev = now;
+    return;
+}
+
+
+/**************************************************************************//*!
+ * @brief     周期の統計を取得する。
+ * @attention なし。
+ * @note      p99 はヒストグラムの区間の上端で返すので、区間幅 ( SYS_RT_HIST_WIDTH ) の精度になる。
+ * @sa        SysRt_PeriodAdd
+ * @author    Ryoji Morita
+ * @return    なし。
+ *************************************************************************** */
+void
+SysRt_PeriodGet(
+    const SSysRtPeriod_t*   p,      ///< [in]  周期の計測
+    SSysRtStats_t*          stats   ///< [out] 周期の統計
+){
+    unsigned long       sum = 0;
+    unsigned long       limit = 0;
+    unsigned int        i = 0;
+
+    memset( stats, 0, sizeof(SSysRtStats_t) );
+    if( p->count == 0 )
+    {
+        return;
+    }
+
+    stats->count  = p->count;
+    stats->missed = p->missed;
+    stats->min    = p->min / 1000.0;
+    stats->max    = p->max / 1000.0;
+
+    limit = p->count - p->count / 100;
+    for( i = 0; i < SYS_RT_HIST_NUM; i++ )
+    {
+        sum += p->hist[i];
+        if( sum >= limit )
+        {
+            break;
+        }
+    }
+    stats->p99 = (double)( i + 1 ) * SYS_RT_HIST_WIDTH / 1000.0;
+    if( stats->p99 > stats->max )
+    {
+        stats->p99 = stats->max;
+    }
+
+    return;
+}
+
+
+#ifdef __cplusplus
+    }
+#endif
+